@@ -37,6 +37,8 @@
  * sink is shut down or reaches EOS. There are also timed variants of these
  * methods, gst_app_sink_try_pull_sample() and gst_app_sink_try_pull_preroll(),
  * which accept a timeout parameter to limit the amount of time to wait.
+ * Applications that consume many small samples can use
+ * gst_app_sink_try_pull_samples() to drain the queue in batches.
  *
  * Appsink will internally use a queue to collect buffers from the streaming
  * thread. If the application is not pulling samples fast enough, this queue
@@ -862,6 +864,31 @@ dequeue_buffer (GstAppSink * appsink)
   return obj;
 }
 
+/* call with priv->mutex held and at least one buffer/list queued */
+static GstSample *
+dequeue_sample (GstAppSink * appsink)
+{
+  GstAppSinkPrivate *priv = appsink->priv;
+  GstMiniObject *obj;
+  GstSample *sample;
+
+  obj = dequeue_buffer (appsink);
+  priv->sample = gst_sample_make_writable (priv->sample);
+  if (GST_IS_BUFFER (obj)) {
+    GST_DEBUG_OBJECT (appsink, "we have a buffer %p", obj);
+    gst_sample_set_buffer_list (priv->sample, NULL);
+    gst_sample_set_buffer (priv->sample, GST_BUFFER_CAST (obj));
+  } else {
+    GST_DEBUG_OBJECT (appsink, "we have a list %p", obj);
+    gst_sample_set_buffer (priv->sample, NULL);
+    gst_sample_set_buffer_list (priv->sample, GST_BUFFER_LIST_CAST (obj));
+  }
+  sample = gst_sample_ref (priv->sample);
+  gst_mini_object_unref (obj);
+
+  return sample;
+}
+
 static GstFlowReturn
 gst_app_sink_render_common (GstBaseSink * psink, GstMiniObject * data,
     gboolean is_list)
@@ -1623,7 +1650,6 @@ gst_app_sink_try_pull_sample (GstAppSink * appsink, GstClockTime timeout)
 {
   GstAppSinkPrivate *priv;
   GstSample *sample = NULL;
-  GstMiniObject *obj;
   gboolean timeout_valid;
   gint64 end_time;
 
@@ -1663,21 +1689,7 @@ gst_app_sink_try_pull_sample (GstAppSink * appsink, GstClockTime timeout)
     priv->wait_status &= ~APP_WAITING;
   }
 
-  obj = dequeue_buffer (appsink);
-  if (GST_IS_BUFFER (obj)) {
-    GST_DEBUG_OBJECT (appsink, "we have a buffer %p", obj);
-    priv->sample = gst_sample_make_writable (priv->sample);
-    gst_sample_set_buffer_list (priv->sample, NULL);
-    gst_sample_set_buffer (priv->sample, GST_BUFFER_CAST (obj));
-    sample = gst_sample_ref (priv->sample);
-  } else {
-    GST_DEBUG_OBJECT (appsink, "we have a list %p", obj);
-    priv->sample = gst_sample_make_writable (priv->sample);
-    gst_sample_set_buffer (priv->sample, NULL);
-    gst_sample_set_buffer_list (priv->sample, GST_BUFFER_LIST_CAST (obj));
-    sample = gst_sample_ref (priv->sample);
-  }
-  gst_mini_object_unref (obj);
+  sample = dequeue_sample (appsink);
 
   if ((priv->wait_status & STREAM_WAITING))
     g_cond_signal (&priv->cond);
@@ -1708,6 +1720,119 @@ not_started:
   }
 }
 
+/**
+ * gst_app_sink_try_pull_samples:
+ * @appsink: a #GstAppSink
+ * @samples: (out caller-allocates) (array length=n_samples) (transfer full):
+ *     array of at least @n_samples entries to store the pulled samples in
+ * @n_samples: the maximum number of samples to pull
+ * @timeout: the maximum amount of time to wait for the first sample
+ *
+ * Pull up to @n_samples queued samples from @appsink in one go.
+ *
+ * This function blocks until at least one sample or EOS becomes available,
+ * the appsink element is set to the READY/NULL state or the timeout expires.
+ * It then takes all samples that are queued at that moment, up to
+ * @n_samples, without waiting for more.
+ *
+ * Compared to calling gst_app_sink_try_pull_sample() repeatedly, the internal
+ * lock is only taken once and a streaming thread that is blocked because
+ * the "max-buffers" limit was reached is woken up only once for the whole
+ * batch, which considerably reduces the overhead for applications that
+ * consume many small samples at high rates.
+ *
+ * The same rules as for gst_app_sink_try_pull_sample() apply to the
+ * returned samples; each of them must be released with gst_sample_unref().
+ *
+ * Returns: the number of samples stored in @samples, or 0 when the appsink
+ * is stopped or EOS or the timeout expires.
+ *
+ * Since: 1.16
+ */
+guint
+gst_app_sink_try_pull_samples (GstAppSink * appsink, GstSample ** samples,
+    guint n_samples, GstClockTime timeout)
+{
+  GstAppSinkPrivate *priv;
+  gboolean timeout_valid;
+  gint64 end_time;
+  guint n = 0;
+
+  g_return_val_if_fail (GST_IS_APP_SINK (appsink), 0);
+  g_return_val_if_fail (samples != NULL || n_samples == 0, 0);
+
+  if (n_samples == 0)
+    return 0;
+
+  timeout_valid = GST_CLOCK_TIME_IS_VALID (timeout);
+
+  if (timeout_valid)
+    end_time =
+        g_get_monotonic_time () + timeout / (GST_SECOND / G_TIME_SPAN_SECOND);
+
+  priv = appsink->priv;
+
+  g_mutex_lock (&priv->mutex);
+  gst_buffer_replace (&priv->preroll_buffer, NULL);
+
+  while (TRUE) {
+    GST_DEBUG_OBJECT (appsink, "trying to grab up to %u buffers", n_samples);
+    if (!priv->started)
+      goto not_started;
+
+    if (priv->num_buffers > 0)
+      break;
+
+    if (priv->is_eos)
+      goto eos;
+
+    /* nothing to return, wait */
+    GST_DEBUG_OBJECT (appsink, "waiting for a buffer");
+    priv->wait_status |= APP_WAITING;
+    if (timeout_valid) {
+      if (!g_cond_wait_until (&priv->cond, &priv->mutex, end_time))
+        goto expired;
+    } else {
+      g_cond_wait (&priv->cond, &priv->mutex);
+    }
+    priv->wait_status &= ~APP_WAITING;
+  }
+
+  while (n < n_samples && priv->num_buffers > 0)
+    samples[n++] = dequeue_sample (appsink);
+
+  GST_DEBUG_OBJECT (appsink, "pulled %u samples, %u left in the queue", n,
+      priv->num_buffers);
+
+  if ((priv->wait_status & STREAM_WAITING))
+    g_cond_signal (&priv->cond);
+
+  g_mutex_unlock (&priv->mutex);
+
+  return n;
+
+  /* special conditions */
+expired:
+  {
+    GST_DEBUG_OBJECT (appsink, "timeout expired, return 0");
+    priv->wait_status &= ~APP_WAITING;
+    g_mutex_unlock (&priv->mutex);
+    return 0;
+  }
+eos:
+  {
+    GST_DEBUG_OBJECT (appsink, "we are EOS, return 0");
+    g_mutex_unlock (&priv->mutex);
+    return 0;
+  }
+not_started:
+  {
+    GST_DEBUG_OBJECT (appsink, "we are stopped, return 0");
+    g_mutex_unlock (&priv->mutex);
+    return 0;
+  }
+}
+
 /**
  * gst_app_sink_set_callbacks: (skip)
  * @appsink: a #GstAppSink
@@ -156,6 +156,12 @@ GstSample *     gst_app_sink_try_pull_preroll (GstAppSink *appsink, GstClockTime
 GST_APP_API
 GstSample *     gst_app_sink_try_pull_sample  (GstAppSink *appsink, GstClockTime timeout);
 
+GST_APP_API
+guint           gst_app_sink_try_pull_samples (GstAppSink *appsink,
+                                               GstSample **samples,
+                                               guint n_samples,
+                                               GstClockTime timeout);
+
 GST_APP_API
 void            gst_app_sink_set_callbacks    (GstAppSink * appsink,
                                                GstAppSinkCallbacks *callbacks,
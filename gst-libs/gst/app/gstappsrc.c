@@ -51,6 +51,10 @@
  * signal the "enough-data" signal, which signals the application that it should
  * stop pushing data into appsrc. The "block" property will cause appsrc to
  * block the push-buffer method until free data becomes available again.
+ * The queue can additionally be limited in buffers and time with the
+ * "max-buffers" and "max-time" properties, and the "low-watermark" and
+ * "high-watermark" properties configure the hysteresis between the
+ * "enough-data" and "need-data" signals.
  *
  * When the internal queue is running out of data, the "need-data" signal is
  * emitted, which signals the application that it should start pushing more data
@@ -84,6 +88,11 @@
  * For the stream and seekable modes, setting this property is optional but
  * recommended.
  *
+ * Applications producing many small buffers can reduce the locking overhead
+ * by queueing them in batches with gst_app_src_push_buffers(). Data owned by
+ * the application can be pushed without copying by wrapping it with
+ * gst_app_src_wrap_memory().
+ *
  * When the application has finished pushing data into appsrc, it should call
  * gst_app_src_end_of_stream() or emit the end-of-stream action signal. After
  * this call, no more buffers can be pushed into appsrc until a flushing seek
@@ -122,6 +131,10 @@ struct _GstAppSrcPrivate
   GstClockTime duration;
   GstAppStreamType stream_type;
   guint64 max_bytes;
+  guint64 max_buffers;
+  guint64 max_time;
+  gdouble low_watermark;
+  gdouble high_watermark;
   GstFormat format;
   gboolean block;
   gchar *uri;
@@ -130,6 +143,12 @@ struct _GstAppSrcPrivate
   gboolean started;
   gboolean is_eos;
   guint64 queued_bytes;
+  guint64 queued_buffers;
+  GstClockTime last_in_ts;
+  GstClockTime last_out_ts;
+  /* set when enough-data was emitted, cleared again when need-data is
+   * emitted, so that we don't oscillate around a single threshold */
+  gboolean is_full;
   guint64 offset;
   GstAppStreamType current_type;
 
@@ -141,11 +160,165 @@ struct _GstAppSrcPrivate
   GstAppSrcCallbacks callbacks;
   gpointer user_data;
   GDestroyNotify notify;
+
+  GstAllocator *wrap_allocator;
 };
 
 GST_DEBUG_CATEGORY_STATIC (app_src_debug);
 #define GST_CAT_DEFAULT app_src_debug
 
+/* Allocator for the caller-owned memory wrapped with
+ * gst_app_src_wrap_memory(). Released memory structs are kept on a small free
+ * list so that wrapping does not need an allocation for every buffer. */
+#define GST_APP_SRC_MEMORY_TYPE "AppSrcMemory"
+#define GST_APP_SRC_MEMORY_CACHE_SIZE 64
+
+typedef struct
+{
+  GstMemory mem;
+
+  guint8 *data;
+  gpointer user_data;
+  GDestroyNotify notify;
+} GstAppSrcMemory;
+
+typedef struct
+{
+  GstAllocator parent;
+
+  GstAtomicQueue *free_mems;
+} GstAppSrcAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstAppSrcAllocatorClass;
+
+static GType gst_app_src_allocator_get_type (void);
+G_DEFINE_TYPE (GstAppSrcAllocator, gst_app_src_allocator, GST_TYPE_ALLOCATOR);
+
+static GstAppSrcMemory *
+gst_app_src_allocator_get_mem (GstAppSrcAllocator * alloc)
+{
+  GstAppSrcMemory *mem;
+
+  if ((mem = gst_atomic_queue_pop (alloc->free_mems)) == NULL)
+    mem = g_slice_new (GstAppSrcMemory);
+
+  return mem;
+}
+
+static void
+gst_app_src_allocator_free (GstAllocator * allocator, GstMemory * gmem)
+{
+  GstAppSrcAllocator *alloc = (GstAppSrcAllocator *) allocator;
+  GstAppSrcMemory *mem = (GstAppSrcMemory *) gmem;
+
+  /* only the parent owns the wrapped data */
+  if (gmem->parent == NULL && mem->notify)
+    mem->notify (mem->user_data);
+
+  mem->data = NULL;
+  mem->user_data = NULL;
+  mem->notify = NULL;
+
+  if (gst_atomic_queue_length (alloc->free_mems) <
+      GST_APP_SRC_MEMORY_CACHE_SIZE)
+    gst_atomic_queue_push (alloc->free_mems, mem);
+  else
+    g_slice_free (GstAppSrcMemory, mem);
+}
+
+static gpointer
+gst_app_src_mem_map (GstMemory * gmem, gsize maxsize, GstMapFlags flags)
+{
+  return ((GstAppSrcMemory *) gmem)->data;
+}
+
+static void
+gst_app_src_mem_unmap (GstMemory * gmem)
+{
+}
+
+static GstMemory *
+gst_app_src_mem_share (GstMemory * gmem, gssize offset, gssize size)
+{
+  GstAppSrcMemory *mem = (GstAppSrcMemory *) gmem;
+  GstAppSrcMemory *sub;
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = gmem->parent) == NULL)
+    parent = gmem;
+
+  if (size == -1)
+    size = gmem->size - offset;
+
+  sub = gst_app_src_allocator_get_mem ((GstAppSrcAllocator *) gmem->allocator);
+  /* the shared memory is always readonly */
+  gst_memory_init (GST_MEMORY_CAST (sub), GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, gmem->allocator, parent,
+      gmem->maxsize, gmem->align, gmem->offset + offset, size);
+
+  sub->data = mem->data;
+  sub->user_data = NULL;
+  sub->notify = NULL;
+
+  return GST_MEMORY_CAST (sub);
+}
+
+static gboolean
+gst_app_src_mem_is_span (GstMemory * mem1, GstMemory * mem2, gsize * offset)
+{
+  if (offset)
+    *offset = mem1->offset - mem1->parent->offset;
+
+  /* and memory is contiguous */
+  return ((GstAppSrcMemory *) mem1)->data + mem1->offset + mem1->size ==
+      ((GstAppSrcMemory *) mem2)->data + mem2->offset;
+}
+
+static void
+gst_app_src_allocator_finalize (GObject * obj)
+{
+  GstAppSrcAllocator *alloc = (GstAppSrcAllocator *) obj;
+  GstAppSrcMemory *mem;
+
+  while ((mem = gst_atomic_queue_pop (alloc->free_mems)))
+    g_slice_free (GstAppSrcMemory, mem);
+  gst_atomic_queue_unref (alloc->free_mems);
+
+  G_OBJECT_CLASS (gst_app_src_allocator_parent_class)->finalize (obj);
+}
+
+static void
+gst_app_src_allocator_class_init (GstAppSrcAllocatorClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  gobject_class->finalize = gst_app_src_allocator_finalize;
+
+  allocator_class->alloc = NULL;
+  allocator_class->free = gst_app_src_allocator_free;
+}
+
+static void
+gst_app_src_allocator_init (GstAppSrcAllocator * alloc)
+{
+  GstAllocator *allocator = GST_ALLOCATOR_CAST (alloc);
+
+  allocator->mem_type = GST_APP_SRC_MEMORY_TYPE;
+  allocator->mem_map = gst_app_src_mem_map;
+  allocator->mem_unmap = gst_app_src_mem_unmap;
+  allocator->mem_share = gst_app_src_mem_share;
+  allocator->mem_is_span = gst_app_src_mem_is_span;
+
+  GST_OBJECT_FLAG_SET (alloc, GST_ALLOCATOR_FLAG_CUSTOM_ALLOC);
+
+  alloc->free_mems = gst_atomic_queue_new (GST_APP_SRC_MEMORY_CACHE_SIZE);
+}
+
 enum
 {
   /* signals */
@@ -174,6 +347,14 @@ enum
 #define DEFAULT_PROP_MIN_PERCENT   0
 #define DEFAULT_PROP_CURRENT_LEVEL_BYTES   0
 #define DEFAULT_PROP_DURATION      GST_CLOCK_TIME_NONE
+#define DEFAULT_PROP_MAX_BUFFERS   0
+#define DEFAULT_PROP_MAX_TIME      0
+#define DEFAULT_PROP_LOW_WATERMARK  0.0
+#define DEFAULT_PROP_HIGH_WATERMARK 1.0
+/* a high watermark of 0 would make the queue always full */
+#define MIN_HIGH_WATERMARK          0.01
+#define DEFAULT_PROP_CURRENT_LEVEL_BUFFERS 0
+#define DEFAULT_PROP_CURRENT_LEVEL_TIME    0
 
 enum
 {
@@ -191,6 +372,12 @@ enum
   PROP_MIN_PERCENT,
   PROP_CURRENT_LEVEL_BYTES,
   PROP_DURATION,
+  PROP_MAX_BUFFERS,
+  PROP_MAX_TIME,
+  PROP_LOW_WATERMARK,
+  PROP_HIGH_WATERMARK,
+  PROP_CURRENT_LEVEL_BUFFERS,
+  PROP_CURRENT_LEVEL_TIME,
   PROP_LAST
 };
 
@@ -411,6 +598,102 @@ gst_app_src_class_init (GstAppSrcClass * klass)
           0, G_MAXUINT64, DEFAULT_PROP_DURATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAppSrc::max-buffers:
+   *
+   * The maximum number of buffers that can be queued internally. Buffers
+   * inside buffer lists are counted individually. Like "max-bytes", reaching
+   * this limit emits the "enough-data" signal and, when "block" is set,
+   * blocks the push functions.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BUFFERS,
+      g_param_spec_uint64 ("max-buffers", "Max buffers",
+          "The maximum number of buffers to queue internally (0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_PROP_MAX_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAppSrc::max-time:
+   *
+   * The maximum amount of time that can be queued internally, measured
+   * between the timestamps of the last queued and the last pushed buffer.
+   * Like "max-bytes", reaching this limit emits the "enough-data" signal and,
+   * when "block" is set, blocks the push functions.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_TIME,
+      g_param_spec_uint64 ("max-time", "Max time",
+          "The maximum amount of time to queue internally (in ns, 0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_PROP_MAX_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAppSrc::low-watermark:
+   *
+   * Once "enough-data" was emitted, emit "need-data" as soon as all queue
+   * levels dropped to this fraction of their respective "max-bytes",
+   * "max-buffers" and "max-time" limits instead of waiting for the queue
+   * to run empty. "enough-data" is only emitted again after that, which
+   * avoids oscillating between both signals for producers running close to
+   * the limits. 0.0 disables this. Values above "high-watermark" are
+   * clamped to it.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_WATERMARK,
+      g_param_spec_double ("low-watermark", "Low watermark",
+          "Low threshold for emitting need-data after enough-data, as a "
+          "fraction of the maximum levels (0.0 = when empty)",
+          0.0, 1.0, DEFAULT_PROP_LOW_WATERMARK,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAppSrc::high-watermark:
+   *
+   * The queue is considered full, and "enough-data" is emitted, as soon as
+   * one of the queue levels reaches this fraction of its respective
+   * "max-bytes", "max-buffers" or "max-time" limit. Pushing only blocks when
+   * the queue is full according to this threshold. Lowering it below
+   * "low-watermark" lowers "low-watermark" too.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_HIGH_WATERMARK,
+      g_param_spec_double ("high-watermark", "High watermark",
+          "High threshold for emitting enough-data, as a fraction of the "
+          "maximum levels", MIN_HIGH_WATERMARK, 1.0,
+          DEFAULT_PROP_HIGH_WATERMARK,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAppSrc::current-level-buffers:
+   *
+   * The number of currently queued buffers inside appsrc.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_CURRENT_LEVEL_BUFFERS,
+      g_param_spec_uint64 ("current-level-buffers", "Current Level Buffers",
+          "The number of currently queued buffers",
+          0, G_MAXUINT64, DEFAULT_PROP_CURRENT_LEVEL_BUFFERS,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAppSrc::current-level-time:
+   *
+   * The amount of currently queued time inside appsrc.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_CURRENT_LEVEL_TIME,
+      g_param_spec_uint64 ("current-level-time", "Current Level Time",
+          "The amount of currently queued time (in ns)",
+          0, G_MAXUINT64, DEFAULT_PROP_CURRENT_LEVEL_TIME,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstAppSrc::need-data:
    * @appsrc: the appsrc element that emitted the signal
@@ -576,6 +859,8 @@ gst_app_src_init (GstAppSrc * appsrc)
   g_cond_init (&priv->cond);
   priv->queue = gst_queue_array_new (16);
   priv->wait_status = NOONE_WAITING;
+  priv->wrap_allocator = g_object_new (gst_app_src_allocator_get_type (), NULL);
+  gst_object_ref_sink (priv->wrap_allocator);
 
   priv->size = DEFAULT_PROP_SIZE;
   priv->duration = DEFAULT_PROP_DURATION;
@@ -587,6 +872,12 @@ gst_app_src_init (GstAppSrc * appsrc)
   priv->max_latency = DEFAULT_PROP_MAX_LATENCY;
   priv->emit_signals = DEFAULT_PROP_EMIT_SIGNALS;
   priv->min_percent = DEFAULT_PROP_MIN_PERCENT;
+  priv->max_buffers = DEFAULT_PROP_MAX_BUFFERS;
+  priv->max_time = DEFAULT_PROP_MAX_TIME;
+  priv->low_watermark = DEFAULT_PROP_LOW_WATERMARK;
+  priv->high_watermark = DEFAULT_PROP_HIGH_WATERMARK;
+  priv->last_in_ts = GST_CLOCK_TIME_NONE;
+  priv->last_out_ts = GST_CLOCK_TIME_NONE;
 
   gst_base_src_set_live (GST_BASE_SRC (appsrc), DEFAULT_PROP_IS_LIVE);
 }
@@ -614,6 +905,108 @@ gst_app_src_flush_queued (GstAppSrc * src, gboolean retain_last_caps)
   }
 
   priv->queued_bytes = 0;
+  priv->queued_buffers = 0;
+  priv->last_in_ts = GST_CLOCK_TIME_NONE;
+  priv->last_out_ts = GST_CLOCK_TIME_NONE;
+  priv->is_full = FALSE;
+}
+
+/* the timestamp up to which a queued buffer or buffer list has data */
+static GstClockTime
+gst_app_src_item_timestamp (GstMiniObject * obj)
+{
+  GstBuffer *buffer;
+
+  if (GST_IS_BUFFER_LIST (obj)) {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
+    guint len = gst_buffer_list_length (buffer_list);
+
+    if (len == 0)
+      return GST_CLOCK_TIME_NONE;
+    buffer = gst_buffer_list_get (buffer_list, len - 1);
+  } else {
+    buffer = GST_BUFFER_CAST (obj);
+  }
+
+  return GST_BUFFER_DTS_OR_PTS (buffer);
+}
+
+/* Must be called with priv->mutex */
+static void
+gst_app_src_queue_item (GstAppSrc * src, GstMiniObject * obj)
+{
+  GstAppSrcPrivate *priv = src->priv;
+  GstClockTime ts;
+
+  gst_queue_array_push_tail (priv->queue, obj);
+
+  if (GST_IS_BUFFER_LIST (obj)) {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
+
+    priv->queued_bytes += gst_buffer_list_calculate_size (buffer_list);
+    priv->queued_buffers += gst_buffer_list_length (buffer_list);
+  } else {
+    priv->queued_bytes += gst_buffer_get_size (GST_BUFFER_CAST (obj));
+    priv->queued_buffers++;
+  }
+
+  ts = gst_app_src_item_timestamp (obj);
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID (priv->last_out_ts))
+      priv->last_out_ts = ts;
+    priv->last_in_ts = ts;
+  }
+}
+
+/* Must be called with priv->mutex */
+static GstClockTime
+gst_app_src_get_queued_time (GstAppSrc * src)
+{
+  GstAppSrcPrivate *priv = src->priv;
+
+  if (priv->queued_buffers == 0 ||
+      !GST_CLOCK_TIME_IS_VALID (priv->last_in_ts) ||
+      !GST_CLOCK_TIME_IS_VALID (priv->last_out_ts) ||
+      priv->last_in_ts < priv->last_out_ts)
+    return 0;
+
+  return priv->last_in_ts - priv->last_out_ts;
+}
+
+/* Must be called with priv->mutex */
+static gboolean
+gst_app_src_is_above_high_watermark (GstAppSrc * src)
+{
+  GstAppSrcPrivate *priv = src->priv;
+  gdouble high = priv->high_watermark;
+
+  if (priv->max_bytes && priv->queued_bytes >= high * priv->max_bytes)
+    return TRUE;
+  if (priv->max_buffers && priv->queued_buffers >= high * priv->max_buffers)
+    return TRUE;
+  if (priv->max_time &&
+      gst_app_src_get_queued_time (src) >= high * priv->max_time)
+    return TRUE;
+
+  return FALSE;
+}
+
+/* Must be called with priv->mutex */
+static gboolean
+gst_app_src_is_below_low_watermark (GstAppSrc * src)
+{
+  GstAppSrcPrivate *priv = src->priv;
+  gdouble low = priv->low_watermark;
+
+  if (priv->max_bytes && priv->queued_bytes > low * priv->max_bytes)
+    return FALSE;
+  if (priv->max_buffers && priv->queued_buffers > low * priv->max_buffers)
+    return FALSE;
+  if (priv->max_time &&
+      gst_app_src_get_queued_time (src) > low * priv->max_time)
+    return FALSE;
+
+  return TRUE;
 }
 
 static void
@@ -655,6 +1048,7 @@ gst_app_src_finalize (GObject * obj)
   g_mutex_clear (&priv->mutex);
   g_cond_clear (&priv->cond);
   gst_queue_array_free (priv->queue);
+  gst_object_unref (priv->wrap_allocator);
 
   g_free (priv->uri);
 
@@ -734,6 +1128,26 @@ gst_app_src_set_property (GObject * object, guint prop_id,
     case PROP_DURATION:
       gst_app_src_set_duration (appsrc, g_value_get_uint64 (value));
       break;
+    case PROP_MAX_BUFFERS:
+      gst_app_src_set_max_buffers (appsrc, g_value_get_uint64 (value));
+      break;
+    case PROP_MAX_TIME:
+      gst_app_src_set_max_time (appsrc, g_value_get_uint64 (value));
+      break;
+    case PROP_LOW_WATERMARK:
+      g_mutex_lock (&priv->mutex);
+      priv->low_watermark =
+          MIN (g_value_get_double (value), priv->high_watermark);
+      g_mutex_unlock (&priv->mutex);
+      break;
+    case PROP_HIGH_WATERMARK:
+      g_mutex_lock (&priv->mutex);
+      priv->high_watermark = g_value_get_double (value);
+      priv->low_watermark = MIN (priv->low_watermark, priv->high_watermark);
+      /* signal the change */
+      g_cond_broadcast (&priv->cond);
+      g_mutex_unlock (&priv->mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -797,6 +1211,29 @@ gst_app_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DURATION:
       g_value_set_uint64 (value, gst_app_src_get_duration (appsrc));
       break;
+    case PROP_MAX_BUFFERS:
+      g_value_set_uint64 (value, gst_app_src_get_max_buffers (appsrc));
+      break;
+    case PROP_MAX_TIME:
+      g_value_set_uint64 (value, gst_app_src_get_max_time (appsrc));
+      break;
+    case PROP_LOW_WATERMARK:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_double (value, priv->low_watermark);
+      g_mutex_unlock (&priv->mutex);
+      break;
+    case PROP_HIGH_WATERMARK:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_double (value, priv->high_watermark);
+      g_mutex_unlock (&priv->mutex);
+      break;
+    case PROP_CURRENT_LEVEL_BUFFERS:
+      g_value_set_uint64 (value,
+          gst_app_src_get_current_level_buffers (appsrc));
+      break;
+    case PROP_CURRENT_LEVEL_TIME:
+      g_value_set_uint64 (value, gst_app_src_get_current_level_time (appsrc));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1069,6 +1506,8 @@ gst_app_src_emit_need_data (GstAppSrc * appsrc, guint size)
   GstAppSrcPrivate *priv = appsrc->priv;
 
   emit = priv->emit_signals;
+  /* allow the next enough-data to be emitted again */
+  priv->is_full = FALSE;
   g_mutex_unlock (&priv->mutex);
 
   /* we have no data, we need some. We fire the signal with the size hint. */
@@ -1182,6 +1621,7 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
     /* return data as long as we have some */
     if (!gst_queue_array_is_empty (priv->queue)) {
       guint buf_size;
+      GstClockTime ts;
       GstMiniObject *obj = gst_queue_array_pop_head (priv->queue);
 
       if (GST_IS_CAPS (obj)) {
@@ -1213,9 +1653,14 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
         continue;
       }
 
+      ts = gst_app_src_item_timestamp (obj);
+      if (GST_CLOCK_TIME_IS_VALID (ts))
+        priv->last_out_ts = ts;
+
       if (GST_IS_BUFFER (obj)) {
         *buf = GST_BUFFER (obj);
         buf_size = gst_buffer_get_size (*buf);
+        priv->queued_buffers--;
         GST_LOG_OBJECT (appsrc, "have buffer %p of size %u", *buf, buf_size);
       } else {
         GstBufferList *buffer_list;
@@ -1229,6 +1674,8 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
         GST_LOG_OBJECT (appsrc, "have buffer list %p of size %u, %u buffers",
             buffer_list, buf_size, gst_buffer_list_length (buffer_list));
 
+        priv->queued_buffers -= gst_buffer_list_length (buffer_list);
+
         gst_base_src_submit_buffer_list (bsrc, buffer_list);
         *buf = NULL;
       }
@@ -1243,8 +1690,14 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
       if ((priv->wait_status & APP_WAITING))
         g_cond_broadcast (&priv->cond);
 
-      /* see if we go lower than the empty-percent */
-      if (priv->min_percent && priv->max_bytes) {
+      /* see if we go lower than the low watermark after having been full */
+      if (priv->is_full && priv->low_watermark > 0.0) {
+        if (gst_app_src_is_below_low_watermark (appsrc))
+          /* ignore flushing state, we got a buffer and we will return it now.
+           * Errors will be handled in the next round */
+          gst_app_src_emit_need_data (appsrc, size);
+      } else if (priv->min_percent && priv->max_bytes) {
+        /* see if we go lower than the empty-percent */
         if (priv->queued_bytes * 100 / priv->max_bytes <= priv->min_percent)
           /* ignore flushing state, we got a buffer and we will return it now.
            * Errors will be handled in the next round */
@@ -1619,6 +2072,185 @@ gst_app_src_get_current_level_bytes (GstAppSrc * appsrc)
   return queued;
 }
 
+/**
+ * gst_app_src_set_max_buffers:
+ * @appsrc: a #GstAppSrc
+ * @max: the maximum number of buffers to queue
+ *
+ * Set the maximum number of buffers that can be queued in @appsrc.
+ * After the maximum number of buffers are queued, @appsrc will emit the
+ * "enough-data" signal.
+ *
+ * Since: 1.16
+ */
+void
+gst_app_src_set_max_buffers (GstAppSrc * appsrc, guint64 max)
+{
+  GstAppSrcPrivate *priv;
+
+  g_return_if_fail (GST_IS_APP_SRC (appsrc));
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  if (max != priv->max_buffers) {
+    GST_DEBUG_OBJECT (appsrc, "setting max-buffers to %" G_GUINT64_FORMAT,
+        max);
+    priv->max_buffers = max;
+    /* signal the change */
+    g_cond_broadcast (&priv->cond);
+  }
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gst_app_src_get_max_buffers:
+ * @appsrc: a #GstAppSrc
+ *
+ * Get the maximum number of buffers that can be queued in @appsrc.
+ *
+ * Returns: The maximum number of buffers that can be queued.
+ *
+ * Since: 1.16
+ */
+guint64
+gst_app_src_get_max_buffers (GstAppSrc * appsrc)
+{
+  guint64 result;
+  GstAppSrcPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), 0);
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  result = priv->max_buffers;
+  GST_DEBUG_OBJECT (appsrc, "getting max-buffers of %" G_GUINT64_FORMAT,
+      result);
+  g_mutex_unlock (&priv->mutex);
+
+  return result;
+}
+
+/**
+ * gst_app_src_set_max_time:
+ * @appsrc: a #GstAppSrc
+ * @max: the maximum amount of time to queue
+ *
+ * Set the maximum amount of time that can be queued in @appsrc.
+ * After the maximum amount of time is queued, @appsrc will emit the
+ * "enough-data" signal.
+ *
+ * Since: 1.16
+ */
+void
+gst_app_src_set_max_time (GstAppSrc * appsrc, GstClockTime max)
+{
+  GstAppSrcPrivate *priv;
+
+  g_return_if_fail (GST_IS_APP_SRC (appsrc));
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  if (max != priv->max_time) {
+    GST_DEBUG_OBJECT (appsrc, "setting max-time to %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (max));
+    priv->max_time = max;
+    /* signal the change */
+    g_cond_broadcast (&priv->cond);
+  }
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gst_app_src_get_max_time:
+ * @appsrc: a #GstAppSrc
+ *
+ * Get the maximum amount of time that can be queued in @appsrc.
+ *
+ * Returns: The maximum amount of time that can be queued.
+ *
+ * Since: 1.16
+ */
+GstClockTime
+gst_app_src_get_max_time (GstAppSrc * appsrc)
+{
+  GstClockTime result;
+  GstAppSrcPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), 0);
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  result = priv->max_time;
+  GST_DEBUG_OBJECT (appsrc, "getting max-time of %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (result));
+  g_mutex_unlock (&priv->mutex);
+
+  return result;
+}
+
+/**
+ * gst_app_src_get_current_level_buffers:
+ * @appsrc: a #GstAppSrc
+ *
+ * Get the number of currently queued buffers inside @appsrc.
+ *
+ * Returns: The number of currently queued buffers.
+ *
+ * Since: 1.16
+ */
+guint64
+gst_app_src_get_current_level_buffers (GstAppSrc * appsrc)
+{
+  guint64 queued;
+  GstAppSrcPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), 0);
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  queued = priv->queued_buffers;
+  GST_DEBUG_OBJECT (appsrc, "current level buffers is %" G_GUINT64_FORMAT,
+      queued);
+  g_mutex_unlock (&priv->mutex);
+
+  return queued;
+}
+
+/**
+ * gst_app_src_get_current_level_time:
+ * @appsrc: a #GstAppSrc
+ *
+ * Get the amount of currently queued time inside @appsrc, measured between
+ * the timestamps of the last queued and the last pushed buffer.
+ *
+ * Returns: The amount of currently queued time.
+ *
+ * Since: 1.16
+ */
+GstClockTime
+gst_app_src_get_current_level_time (GstAppSrc * appsrc)
+{
+  GstClockTime queued;
+  GstAppSrcPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), 0);
+
+  priv = appsrc->priv;
+
+  g_mutex_lock (&priv->mutex);
+  queued = gst_app_src_get_queued_time (appsrc);
+  GST_DEBUG_OBJECT (appsrc, "current level time is %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (queued));
+  g_mutex_unlock (&priv->mutex);
+
+  return queued;
+}
+
 static void
 gst_app_src_set_latencies (GstAppSrc * appsrc, gboolean do_min, guint64 min,
     gboolean do_max, guint64 max)
@@ -1733,12 +2365,97 @@ gst_app_src_get_emit_signals (GstAppSrc * appsrc)
   return result;
 }
 
+/* Get the current running time of @appsrc for do-timestamp. Returns %FALSE
+ * when there is no clock yet. */
+static gboolean
+gst_app_src_get_running_time_now (GstAppSrc * appsrc, GstClockTime * now)
+{
+  GstClock *clock;
+  GstClockTime base_time;
+
+  clock = gst_element_get_clock (GST_ELEMENT_CAST (appsrc));
+  if (clock == NULL)
+    return FALSE;
+
+  base_time = gst_element_get_base_time (GST_ELEMENT_CAST (appsrc));
+
+  *now = gst_clock_get_time (clock);
+  if (*now > base_time)
+    *now -= base_time;
+  else
+    *now = 0;
+  gst_object_unref (clock);
+
+  return TRUE;
+}
+
+/* must be called with the appsrc mutex. Emits enough-data when the queue is
+ * full and, when the block property is set, waits until there is space again.
+ * Returns GST_FLOW_OK when data can be queued. */
+static GstFlowReturn
+gst_app_src_wait_queue_space (GstAppSrc * appsrc)
+{
+  GstAppSrcPrivate *priv = appsrc->priv;
+
+  while (TRUE) {
+    /* can't accept buffers when we are flushing or EOS */
+    if (priv->flushing)
+      return GST_FLOW_FLUSHING;
+
+    if (priv->is_eos)
+      return GST_FLOW_EOS;
+
+    if (gst_app_src_is_above_high_watermark (appsrc)) {
+      GST_DEBUG_OBJECT (appsrc,
+          "queue filled (%" G_GUINT64_FORMAT " bytes, %" G_GUINT64_FORMAT
+          " buffers, %" GST_TIME_FORMAT ")", priv->queued_bytes,
+          priv->queued_buffers,
+          GST_TIME_ARGS (gst_app_src_get_queued_time (appsrc)));
+
+      if (!priv->is_full) {
+        gboolean emit;
+
+        emit = priv->emit_signals;
+        /* only signal once until need-data was emitted again */
+        priv->is_full = TRUE;
+        g_mutex_unlock (&priv->mutex);
+
+        if (priv->callbacks.enough_data)
+          priv->callbacks.enough_data (appsrc, priv->user_data);
+        else if (emit)
+          g_signal_emit (appsrc, gst_app_src_signals[SIGNAL_ENOUGH_DATA], 0,
+              NULL);
+
+        g_mutex_lock (&priv->mutex);
+        /* continue to check for flushing/eos after releasing the lock */
+        continue;
+      }
+      if (priv->block) {
+        GST_DEBUG_OBJECT (appsrc, "waiting for free space");
+        /* we are filled, wait until a buffer gets popped or when we
+         * flush. */
+        priv->wait_status |= APP_WAITING;
+        g_cond_wait (&priv->cond, &priv->mutex);
+        priv->wait_status &= ~APP_WAITING;
+      } else {
+        /* no need to wait for free space, we just pump more data into the
+         * queue hoping that the caller reacts to the enough-data signal and
+         * stops pushing buffers. */
+        break;
+      }
+    } else
+      break;
+  }
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_app_src_push_internal (GstAppSrc * appsrc, GstBuffer * buffer,
     GstBufferList * buflist, gboolean steal_ref)
 {
-  gboolean first = TRUE;
   GstAppSrcPrivate *priv;
+  GstFlowReturn ret;
 
   g_return_val_if_fail (GST_IS_APP_SRC (appsrc), GST_FLOW_ERROR);
 
@@ -1759,21 +2476,9 @@ gst_app_src_push_internal (GstAppSrc * appsrc, GstBuffer * buffer,
   if (GST_BUFFER_DTS (buffer) == GST_CLOCK_TIME_NONE &&
       GST_BUFFER_PTS (buffer) == GST_CLOCK_TIME_NONE &&
       gst_base_src_get_do_timestamp (GST_BASE_SRC_CAST (appsrc))) {
-    GstClock *clock;
-
-    clock = gst_element_get_clock (GST_ELEMENT_CAST (appsrc));
-    if (clock) {
-      GstClockTime now;
-      GstClockTime base_time =
-          gst_element_get_base_time (GST_ELEMENT_CAST (appsrc));
-
-      now = gst_clock_get_time (clock);
-      if (now > base_time)
-        now -= base_time;
-      else
-        now = 0;
-      gst_object_unref (clock);
+    GstClockTime now;
 
+    if (gst_app_src_get_running_time_now (appsrc, &now)) {
       if (buflist == NULL) {
         if (!steal_ref) {
           buffer = gst_buffer_copy (buffer);
@@ -1803,66 +2508,20 @@ gst_app_src_push_internal (GstAppSrc * appsrc, GstBuffer * buffer,
 
   g_mutex_lock (&priv->mutex);
 
-  while (TRUE) {
-    /* can't accept buffers when we are flushing or EOS */
-    if (priv->flushing)
-      goto flushing;
-
-    if (priv->is_eos)
-      goto eos;
-
-    if (priv->max_bytes && priv->queued_bytes >= priv->max_bytes) {
-      GST_DEBUG_OBJECT (appsrc,
-          "queue filled (%" G_GUINT64_FORMAT " >= %" G_GUINT64_FORMAT ")",
-          priv->queued_bytes, priv->max_bytes);
-
-      if (first) {
-        gboolean emit;
-
-        emit = priv->emit_signals;
-        /* only signal on the first push */
-        g_mutex_unlock (&priv->mutex);
-
-        if (priv->callbacks.enough_data)
-          priv->callbacks.enough_data (appsrc, priv->user_data);
-        else if (emit)
-          g_signal_emit (appsrc, gst_app_src_signals[SIGNAL_ENOUGH_DATA], 0,
-              NULL);
-
-        g_mutex_lock (&priv->mutex);
-        /* continue to check for flushing/eos after releasing the lock */
-        first = FALSE;
-        continue;
-      }
-      if (priv->block) {
-        GST_DEBUG_OBJECT (appsrc, "waiting for free space");
-        /* we are filled, wait until a buffer gets popped or when we
-         * flush. */
-        priv->wait_status |= APP_WAITING;
-        g_cond_wait (&priv->cond, &priv->mutex);
-        priv->wait_status &= ~APP_WAITING;
-      } else {
-        /* no need to wait for free space, we just pump more data into the
-         * queue hoping that the caller reacts to the enough-data signal and
-         * stops pushing buffers. */
-        break;
-      }
-    } else
-      break;
-  }
+  ret = gst_app_src_wait_queue_space (appsrc);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto refused;
 
   if (buflist != NULL) {
     GST_DEBUG_OBJECT (appsrc, "queueing buffer list %p", buflist);
     if (!steal_ref)
       gst_buffer_list_ref (buflist);
-    gst_queue_array_push_tail (priv->queue, buflist);
-    priv->queued_bytes += gst_buffer_list_calculate_size (buflist);
+    gst_app_src_queue_item (appsrc, GST_MINI_OBJECT_CAST (buflist));
   } else {
     GST_DEBUG_OBJECT (appsrc, "queueing buffer %p", buffer);
     if (!steal_ref)
       gst_buffer_ref (buffer);
-    gst_queue_array_push_tail (priv->queue, buffer);
-    priv->queued_bytes += gst_buffer_get_size (buffer);
+    gst_app_src_queue_item (appsrc, GST_MINI_OBJECT_CAST (buffer));
   }
 
   if ((priv->wait_status & STREAM_WAITING))
@@ -1873,21 +2532,18 @@ gst_app_src_push_internal (GstAppSrc * appsrc, GstBuffer * buffer,
   return GST_FLOW_OK;
 
   /* ERRORS */
-flushing:
-  {
-    GST_DEBUG_OBJECT (appsrc, "refuse buffer %p, we are flushing", buffer);
-    if (steal_ref)
-      gst_buffer_unref (buffer);
-    g_mutex_unlock (&priv->mutex);
-    return GST_FLOW_FLUSHING;
-  }
-eos:
+refused:
   {
-    GST_DEBUG_OBJECT (appsrc, "refuse buffer %p, we are EOS", buffer);
-    if (steal_ref)
-      gst_buffer_unref (buffer);
+    GST_DEBUG_OBJECT (appsrc, "refuse buffer %p, we are %s", buffer,
+        ret == GST_FLOW_EOS ? "EOS" : "flushing");
+    if (steal_ref) {
+      if (buflist != NULL)
+        gst_buffer_list_unref (buflist);
+      else
+        gst_buffer_unref (buffer);
+    }
     g_mutex_unlock (&priv->mutex);
-    return GST_FLOW_EOS;
+    return ret;
   }
 }
 
@@ -1971,6 +2627,151 @@ gst_app_src_push_buffer_list (GstAppSrc * appsrc, GstBufferList * buffer_list)
   return gst_app_src_push_internal (appsrc, NULL, buffer_list, TRUE);
 }
 
+/**
+ * gst_app_src_push_buffers:
+ * @appsrc: a #GstAppSrc
+ * @buffers: (array length=n_buffers) (transfer full): the #GstBuffers to push
+ * @n_buffers: the number of buffers in @buffers
+ *
+ * Adds @n_buffers buffers to the queue of buffers that the appsrc element
+ * will push to its source pad, in order. This function takes ownership of
+ * all the buffers, also when they could not be queued.
+ *
+ * Unlike gst_app_src_push_buffer_list(), the buffers are pushed downstream
+ * one by one, but they are queued with a single lock acquisition and the
+ * streaming thread is woken up only once, which makes this considerably
+ * cheaper than calling gst_app_src_push_buffer() for each of them at high
+ * packet rates.
+ *
+ * The whole batch is accepted as soon as the queue has room, so the
+ * "max-bytes" limit can be exceeded by up to the size of one batch. When
+ * the block property is TRUE, this function can block until free space
+ * becomes available in the queue.
+ *
+ * Returns: #GST_FLOW_OK when the buffers were successfuly queued.
+ * #GST_FLOW_FLUSHING when @appsrc is not PAUSED or PLAYING.
+ * #GST_FLOW_EOS when EOS occured.
+ *
+ * Since: 1.16
+ */
+GstFlowReturn
+gst_app_src_push_buffers (GstAppSrc * appsrc, GstBuffer ** buffers,
+    guint n_buffers)
+{
+  GstAppSrcPrivate *priv;
+  GstFlowReturn ret;
+  guint i;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), GST_FLOW_ERROR);
+  g_return_val_if_fail (buffers != NULL || n_buffers == 0, GST_FLOW_ERROR);
+
+  priv = appsrc->priv;
+
+  if (n_buffers == 0)
+    return GST_FLOW_OK;
+
+  if (gst_base_src_get_do_timestamp (GST_BASE_SRC_CAST (appsrc))) {
+    GstClockTime now = GST_CLOCK_TIME_NONE;
+
+    for (i = 0; i < n_buffers; i++) {
+      if (GST_BUFFER_DTS (buffers[i]) != GST_CLOCK_TIME_NONE ||
+          GST_BUFFER_PTS (buffers[i]) != GST_CLOCK_TIME_NONE)
+        continue;
+
+      /* sample the clock only once for the whole batch */
+      if (now == GST_CLOCK_TIME_NONE &&
+          !gst_app_src_get_running_time_now (appsrc, &now)) {
+        GST_WARNING_OBJECT (appsrc,
+            "do-timestamp=TRUE but buffers are provided before "
+            "reaching the PLAYING state and having a clock. Timestamps will "
+            "not be accurate!");
+        break;
+      }
+
+      buffers[i] = gst_buffer_make_writable (buffers[i]);
+      GST_BUFFER_PTS (buffers[i]) = now;
+      GST_BUFFER_DTS (buffers[i]) = now;
+    }
+  }
+
+  g_mutex_lock (&priv->mutex);
+
+  ret = gst_app_src_wait_queue_space (appsrc);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto refused;
+
+  GST_DEBUG_OBJECT (appsrc, "queueing %u buffers", n_buffers);
+  for (i = 0; i < n_buffers; i++)
+    gst_app_src_queue_item (appsrc, GST_MINI_OBJECT_CAST (buffers[i]));
+
+  if ((priv->wait_status & STREAM_WAITING))
+    g_cond_broadcast (&priv->cond);
+
+  g_mutex_unlock (&priv->mutex);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+refused:
+  {
+    GST_DEBUG_OBJECT (appsrc, "refuse %u buffers, we are %s", n_buffers,
+        ret == GST_FLOW_EOS ? "EOS" : "flushing");
+    g_mutex_unlock (&priv->mutex);
+    for (i = 0; i < n_buffers; i++)
+      gst_buffer_unref (buffers[i]);
+    return ret;
+  }
+}
+
+/**
+ * gst_app_src_wrap_memory:
+ * @appsrc: a #GstAppSrc
+ * @data: (array length=size) (element-type guint8) (transfer none): the data
+ *     to wrap
+ * @size: the size of @data
+ * @user_data: (allow-none): user data passed to @notify
+ * @notify: (allow-none) (scope async) (closure user_data): called with
+ *     @user_data when the memory is released
+ *
+ * Wrap the caller-owned memory region @data of @size bytes in a read-only
+ * #GstMemory without copying it. The memory can then be added to a buffer
+ * with gst_buffer_append_memory() and pushed into @appsrc, for example with
+ * gst_app_src_push_buffers().
+ *
+ * @data must stay valid until @notify is called, which happens once all
+ * references to the returned memory and memories shared from it are dropped,
+ * possibly from a streaming thread.
+ *
+ * Compared to gst_memory_new_wrapped(), the memory structures are recycled
+ * by @appsrc so that wrapping does not need a new allocation per buffer.
+ *
+ * Returns: (transfer full): a new #GstMemory wrapping @data.
+ *
+ * Since: 1.16
+ */
+GstMemory *
+gst_app_src_wrap_memory (GstAppSrc * appsrc, gpointer data, gsize size,
+    gpointer user_data, GDestroyNotify notify)
+{
+  GstAppSrcAllocator *alloc;
+  GstAppSrcMemory *mem;
+
+  g_return_val_if_fail (GST_IS_APP_SRC (appsrc), NULL);
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  alloc = (GstAppSrcAllocator *) appsrc->priv->wrap_allocator;
+
+  mem = gst_app_src_allocator_get_mem (alloc);
+  gst_memory_init (GST_MEMORY_CAST (mem), GST_MEMORY_FLAG_READONLY,
+      GST_ALLOCATOR_CAST (alloc), NULL, size, 0, 0, size);
+
+  mem->data = data;
+  mem->user_data = user_data;
+  mem->notify = notify;
+
+  return GST_MEMORY_CAST (mem);
+}
+
 /**
  * gst_app_src_push_sample:
  * @appsrc: a #GstAppSrc
@@ -154,6 +154,24 @@ guint64          gst_app_src_get_max_bytes           (GstAppSrc *appsrc);
 GST_APP_API
 guint64          gst_app_src_get_current_level_bytes (GstAppSrc *appsrc);
 
+GST_APP_API
+void             gst_app_src_set_max_buffers         (GstAppSrc *appsrc, guint64 max);
+
+GST_APP_API
+guint64          gst_app_src_get_max_buffers         (GstAppSrc *appsrc);
+
+GST_APP_API
+void             gst_app_src_set_max_time            (GstAppSrc *appsrc, GstClockTime max);
+
+GST_APP_API
+GstClockTime     gst_app_src_get_max_time            (GstAppSrc *appsrc);
+
+GST_APP_API
+guint64          gst_app_src_get_current_level_buffers (GstAppSrc *appsrc);
+
+GST_APP_API
+GstClockTime     gst_app_src_get_current_level_time  (GstAppSrc *appsrc);
+
 GST_APP_API
 void             gst_app_src_set_latency             (GstAppSrc *appsrc, guint64 min, guint64 max);
 
@@ -172,6 +190,18 @@ GstFlowReturn    gst_app_src_push_buffer             (GstAppSrc *appsrc, GstBuff
 GST_APP_API
 GstFlowReturn    gst_app_src_push_buffer_list        (GstAppSrc * appsrc, GstBufferList * buffer_list);
 
+GST_APP_API
+GstFlowReturn    gst_app_src_push_buffers            (GstAppSrc *appsrc,
+                                                      GstBuffer **buffers,
+                                                      guint n_buffers);
+
+GST_APP_API
+GstMemory *      gst_app_src_wrap_memory             (GstAppSrc *appsrc,
+                                                      gpointer data,
+                                                      gsize size,
+                                                      gpointer user_data,
+                                                      GDestroyNotify notify);
+
 GST_APP_API
 GstFlowReturn    gst_app_src_end_of_stream           (GstAppSrc *appsrc);
 
@@ -0,0 +1,371 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* On-disk cache of discovery results, used by GstDiscoverer when the
+ * cache-file property is set.
+ *
+ * The cache file is a single serialized GVariant of type CACHE_FORMAT:
+ * a format version followed by one (uri, parse-only, mtime, size, inode,
+ * info) entry per local file, where info is the result of
+ * gst_discoverer_info_to_variant() and mtime is in nanoseconds. A result is
+ * only used for discoveries in the same parse-only mode it was made in,
+ * because parse-only results describe the encoded streams. The file is
+ * memory-mapped and only an
+ * index from URI to entry is built when loading it, entries are deserialized
+ * when they are looked up. New results are kept in memory and the file is
+ * rewritten when the last reference to the cache is dropped.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib/gstdio.h>
+
+#include "pbutils.h"
+#include "pbutils-private.h"
+
+GST_DEBUG_CATEGORY_STATIC (discoverer_cache_debug);
+#define GST_CAT_DEFAULT discoverer_cache_debug
+
+#define CACHE_VERSION 2
+#define CACHE_FORMAT "(ua(sbtttv))"
+#define ENTRY_FORMAT "(sbtttv)"
+
+struct _GstDiscovererCache
+{
+  gint refcount;
+
+  GMutex lock;
+  gchar *filename;
+
+  /* the memory-mapped cache file and its entries */
+  GMappedFile *mapped;
+  GVariant *entries;
+  /* uri (pointing into the mapped file) -> index + 1 in entries */
+  GHashTable *index;
+
+  /* uri -> entry, for results discovered since the file was loaded */
+  GHashTable *new_entries;
+
+  guint hits;
+  guint misses;
+};
+
+static void
+gst_discoverer_cache_load (GstDiscovererCache * cache)
+{
+  GError *err = NULL;
+  GVariant *root;
+  GBytes *bytes;
+  guint32 version;
+  gsize i, n;
+
+  cache->mapped = g_mapped_file_new (cache->filename, FALSE, &err);
+  if (cache->mapped == NULL) {
+    GST_DEBUG ("Can't map cache file %s: %s", cache->filename, err->message);
+    g_clear_error (&err);
+    return;
+  }
+
+  /* Not trusted, the serializer copes with corrupted data */
+  bytes = g_mapped_file_get_bytes (cache->mapped);
+  root = g_variant_new_from_bytes (G_VARIANT_TYPE (CACHE_FORMAT), bytes,
+      FALSE);
+  g_bytes_unref (bytes);
+  g_variant_ref_sink (root);
+
+  g_variant_get (root, "(u@a(sbtttv))", &version, &cache->entries);
+  g_variant_unref (root);
+
+  if (version != CACHE_VERSION) {
+    GST_INFO ("Ignoring cache file %s with version %u", cache->filename,
+        version);
+    g_variant_unref (cache->entries);
+    cache->entries = NULL;
+    g_mapped_file_unref (cache->mapped);
+    cache->mapped = NULL;
+    return;
+  }
+
+  n = g_variant_n_children (cache->entries);
+  for (i = 0; i < n; i++) {
+    const gchar *uri;
+
+    g_variant_get_child (cache->entries, i, "(&sbtttv)", &uri, NULL, NULL,
+        NULL, NULL, NULL);
+    g_hash_table_insert (cache->index, (gpointer) uri,
+        GSIZE_TO_POINTER (i + 1));
+  }
+
+  GST_INFO ("Loaded %" G_GSIZE_FORMAT " entries from %s", n, cache->filename);
+}
+
+static void
+gst_discoverer_cache_unload (GstDiscovererCache * cache)
+{
+  g_hash_table_remove_all (cache->index);
+  if (cache->entries) {
+    g_variant_unref (cache->entries);
+    cache->entries = NULL;
+  }
+  if (cache->mapped) {
+    g_mapped_file_unref (cache->mapped);
+    cache->mapped = NULL;
+  }
+}
+
+static gboolean
+gst_discoverer_cache_save (GstDiscovererCache * cache)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  GVariant *entry, *root;
+  GError *err = NULL;
+  gboolean ret;
+  gsize i, n = 0;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sbtttv)"));
+
+  g_hash_table_iter_init (&iter, cache->new_entries);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & entry))
+    g_variant_builder_add_value (&builder, entry);
+
+  /* keep the entries of the file that were not discovered again */
+  if (cache->entries)
+    n = g_variant_n_children (cache->entries);
+  for (i = 0; i < n; i++) {
+    const gchar *uri;
+
+    entry = g_variant_get_child_value (cache->entries, i);
+    g_variant_get_child (entry, 0, "&s", &uri);
+    if (!g_hash_table_contains (cache->new_entries, uri))
+      g_variant_builder_add_value (&builder, entry);
+    g_variant_unref (entry);
+  }
+
+  root = g_variant_new ("(u@a(sbtttv))", CACHE_VERSION,
+      g_variant_builder_end (&builder));
+  g_variant_ref_sink (root);
+
+  /* serializes the new file into its own memory, after which the mapping
+   * can go away before the file is replaced */
+  g_variant_get_data (root);
+  gst_discoverer_cache_unload (cache);
+
+  ret = g_file_set_contents (cache->filename, g_variant_get_data (root),
+      g_variant_get_size (root), &err);
+  if (!ret) {
+    GST_WARNING ("Failed to write cache file %s: %s", cache->filename,
+        err->message);
+    g_clear_error (&err);
+  }
+  g_variant_unref (root);
+
+  return ret;
+}
+
+/* Gets the identity of the local file behind @uri, other URIs are not
+ * cached. @mtime is in nanoseconds, with the precision the platform gives */
+static gboolean
+get_file_identity (const gchar * uri, guint64 * mtime, guint64 * size,
+    guint64 * inode)
+{
+  GStatBuf st;
+  gchar *filename;
+  gboolean ret;
+
+  if (!gst_uri_has_protocol (uri, "file"))
+    return FALSE;
+
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  if (filename == NULL)
+    return FALSE;
+
+  ret = (g_stat (filename, &st) == 0);
+  g_free (filename);
+
+  if (ret) {
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    *mtime = (guint64) st.st_mtim.tv_sec * GST_SECOND + st.st_mtim.tv_nsec;
+#else
+    *mtime = (guint64) st.st_mtime * GST_SECOND;
+#endif
+    *size = st.st_size;
+    *inode = st.st_ino;
+  }
+
+  return ret;
+}
+
+GstDiscovererCache *
+gst_discoverer_cache_new (const gchar * filename)
+{
+  GstDiscovererCache *cache;
+
+  GST_DEBUG_CATEGORY_INIT (discoverer_cache_debug, "discoverer-cache", 0,
+      "Discoverer cache");
+
+  cache = g_slice_new0 (GstDiscovererCache);
+  cache->refcount = 1;
+  g_mutex_init (&cache->lock);
+  cache->filename = g_strdup (filename);
+  cache->index = g_hash_table_new (g_str_hash, g_str_equal);
+  cache->new_entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) g_variant_unref);
+
+  gst_discoverer_cache_load (cache);
+
+  return cache;
+}
+
+GstDiscovererCache *
+gst_discoverer_cache_ref (GstDiscovererCache * cache)
+{
+  g_atomic_int_inc (&cache->refcount);
+
+  return cache;
+}
+
+/* Writes the cache file if there are new results when the last reference
+ * is dropped */
+void
+gst_discoverer_cache_unref (GstDiscovererCache * cache)
+{
+  if (!g_atomic_int_dec_and_test (&cache->refcount))
+    return;
+
+  GST_DEBUG ("%s: %u hits, %u misses, %u new entries", cache->filename,
+      cache->hits, cache->misses, g_hash_table_size (cache->new_entries));
+
+  if (g_hash_table_size (cache->new_entries) > 0)
+    gst_discoverer_cache_save (cache);
+
+  gst_discoverer_cache_unload (cache);
+  g_hash_table_unref (cache->index);
+  g_hash_table_unref (cache->new_entries);
+  g_free (cache->filename);
+  g_mutex_clear (&cache->lock);
+  g_slice_free (GstDiscovererCache, cache);
+}
+
+const gchar *
+gst_discoverer_cache_get_filename (GstDiscovererCache * cache)
+{
+  return cache->filename;
+}
+
+/* Returns a new #GstDiscovererInfo for @uri if there is an entry for it made
+ * in the same @parse_only mode and the file didn't change since, else %NULL */
+GstDiscovererInfo *
+gst_discoverer_cache_lookup (GstDiscovererCache * cache, const gchar * uri,
+    gboolean parse_only)
+{
+  GstDiscovererInfo *info = NULL;
+  GVariant *entry = NULL, *wrapper;
+  gboolean entry_parse_only;
+  guint64 mtime, size, inode;
+  guint64 entry_mtime, entry_size, entry_inode;
+  gsize idx;
+
+  if (!get_file_identity (uri, &mtime, &size, &inode))
+    return NULL;
+
+  g_mutex_lock (&cache->lock);
+
+  entry = g_hash_table_lookup (cache->new_entries, uri);
+  if (entry) {
+    g_variant_ref (entry);
+  } else if ((idx = GPOINTER_TO_SIZE (g_hash_table_lookup (cache->index,
+                  uri)))) {
+    entry = g_variant_get_child_value (cache->entries, idx - 1);
+  }
+
+  if (entry) {
+    g_variant_get (entry, "(&sbttt@v)", NULL, &entry_parse_only, &entry_mtime,
+        &entry_size, &entry_inode, &wrapper);
+
+    if (!entry_parse_only != !parse_only) {
+      GST_DEBUG ("%s was cached in the other parse-only mode", uri);
+    } else if (entry_mtime == mtime && entry_size == size
+        && entry_inode == inode) {
+      GVariant *serialized = g_variant_get_variant (wrapper);
+
+      /* gst_discoverer_info_to_variant() returns a variant itself */
+      if (g_variant_is_of_type (serialized, G_VARIANT_TYPE_VARIANT))
+        info = gst_discoverer_info_from_variant (serialized);
+      else
+        GST_WARNING ("Invalid cache entry for %s", uri);
+      g_variant_unref (serialized);
+    } else {
+      GST_DEBUG ("%s changed since it was cached", uri);
+    }
+
+    g_variant_unref (wrapper);
+    g_variant_unref (entry);
+  }
+
+  if (info)
+    cache->hits++;
+  else
+    cache->misses++;
+
+  g_mutex_unlock (&cache->lock);
+
+  GST_LOG ("%s for %s", info ? "hit" : "miss", uri);
+
+  return info;
+}
+
+/* Adds a successful result, discovered in @parse_only mode, to the cache.
+ * It replaces the entry of the other mode for the same file */
+void
+gst_discoverer_cache_store (GstDiscovererCache * cache,
+    GstDiscovererInfo * info, gboolean parse_only)
+{
+  guint64 mtime, size, inode;
+  GVariant *serialized, *entry;
+
+  if (info->result != GST_DISCOVERER_OK || info->uri == NULL)
+    return;
+
+  if (!get_file_identity (info->uri, &mtime, &size, &inode))
+    return;
+
+  serialized = gst_discoverer_info_to_variant (info,
+      GST_DISCOVERER_SERIALIZE_ALL);
+  entry = g_variant_new (ENTRY_FORMAT, info->uri, ! !parse_only, mtime, size,
+      inode, serialized);
+  g_variant_ref_sink (entry);
+
+  g_mutex_lock (&cache->lock);
+  g_hash_table_replace (cache->new_entries, g_strdup (info->uri), entry);
+  g_mutex_unlock (&cache->lock);
+}
+
+void
+gst_discoverer_cache_get_stats (GstDiscovererCache * cache, guint * hits,
+    guint * misses)
+{
+  g_mutex_lock (&cache->lock);
+  if (hits)
+    *hits = cache->hits;
+  if (misses)
+    *misses = cache->misses;
+  g_mutex_unlock (&cache->lock);
+}
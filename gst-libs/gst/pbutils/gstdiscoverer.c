@@ -137,6 +137,24 @@ struct _GstDiscovererPrivate
   gulong source_chg_id;
   gulong element_added_id;
   gulong bus_cb_id;
+  gulong autoplug_select_id;
+
+  /* TRUE if no decoders should be plugged */
+  gboolean parse_only;
+
+  /* cache of previous results, shared with the workers */
+  GstDiscovererCache *cache;
+  /* TRUE if the current info was taken from the cache */
+  gboolean current_cached;
+
+  /* maximum number of URIs discovered concurrently in async mode, the
+   * discoverer itself counts as one of them */
+  guint max_workers;
+
+  /* helper discoverers running the additional concurrent discoveries */
+  GPtrArray *workers;
+  GQueue idle_workers;
+  guint busy_workers;
 };
 
 #define DISCO_LOCK(dc) g_mutex_lock (&dc->priv->lock);
@@ -170,11 +188,29 @@ enum
 };
 
 #define DEFAULT_PROP_TIMEOUT 15 * GST_SECOND
+#define DEFAULT_PROP_MAX_WORKERS 1
+#define DEFAULT_PROP_REUSE_SOURCE FALSE
+#define DEFAULT_PROP_PARSE_ONLY FALSE
+#define DEFAULT_PROP_CACHE_FILE NULL
 
 enum
 {
   PROP_0,
-  PROP_TIMEOUT
+  PROP_TIMEOUT,
+  PROP_MAX_WORKERS,
+  PROP_REUSE_SOURCE,
+  PROP_PARSE_ONLY,
+  PROP_CACHE_FILE,
+  PROP_CACHE_HITS,
+  PROP_CACHE_MISSES
+};
+
+/* Mirrors GstAutoplugSelectResult from the playback plugin */
+enum
+{
+  AUTOPLUG_SELECT_TRY,
+  AUTOPLUG_SELECT_EXPOSE,
+  AUTOPLUG_SELECT_SKIP
 };
 
 static guint gst_discoverer_signals[LAST_SIGNAL] = { 0 };
@@ -182,6 +218,12 @@ static guint gst_discoverer_signals[LAST_SIGNAL] = { 0 };
 static void gst_discoverer_set_timeout (GstDiscoverer * dc,
     GstClockTime timeout);
 static gboolean async_timeout_cb (GstDiscoverer * dc);
+static void discoverer_start_with_context (GstDiscoverer * dc,
+    GMainContext * ctx);
+static void discoverer_dispatch_workers (GstDiscoverer * dc);
+static gboolean discoverer_is_finished_locked (GstDiscoverer * dc);
+static void discoverer_set_cache (GstDiscoverer * dc,
+    GstDiscovererCache * cache);
 
 static void discoverer_bus_cb (GstBus * bus, GstMessage * msg,
     GstDiscoverer * dc);
@@ -227,6 +269,117 @@ gst_discoverer_class_init (GstDiscovererClass * klass)
           GST_SECOND, 3600 * GST_SECOND, DEFAULT_PROP_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDiscoverer:max-workers:
+   *
+   * The maximum number of URIs discovered concurrently in asynchronous mode.
+   *
+   * Each concurrent discovery runs in its own pipeline with its own streaming
+   * threads, so this also bounds the memory and the number of threads used by
+   * the discoverer. Results are still delivered through the
+   * #GstDiscoverer::discovered signal in the main context used by
+   * gst_discoverer_start(), but not necessarily in the order the URIs were
+   * added.
+   *
+   * Synchronous discovery with gst_discoverer_discover_uri() is not affected.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_WORKERS,
+      g_param_spec_uint ("max-workers", "Maximum workers",
+          "Maximum number of URIs discovered concurrently in asynchronous mode",
+          1, G_MAXUINT, DEFAULT_PROP_MAX_WORKERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:reuse-source:
+   *
+   * Keep the source element between discoveries and reuse it for the next
+   * URI if it can handle it, instead of creating a new one for every URI.
+   * The decoding elements are already kept around by the discoverer.
+   *
+   * This mostly helps when discovering many small files. Properties set on
+   * the source from the #GstDiscoverer::source-setup signal for a previous
+   * URI are kept.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_REUSE_SOURCE,
+      g_param_spec_boolean ("reuse-source", "Reuse source",
+          "Reuse the source element for the next URI when possible",
+          DEFAULT_PROP_REUSE_SOURCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:parse-only:
+   *
+   * Stop autoplugging before decoders, so that only demuxers and parsers are
+   * used to discover the streams. This avoids loading codec plugins and
+   * creating decoders, which makes discovery considerably faster when only
+   * the container, the stream caps, duration, tags and TOC are needed.
+   *
+   * The reported stream caps are then the ones of the encoded streams as
+   * provided by the demuxers and parsers, so some fields (e.g. the
+   * dimensions of a video stream without a parser) might be missing. Streams
+   * for which decoders are available but not installed are not reported as
+   * %GST_DISCOVERER_MISSING_PLUGINS either.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_PARSE_ONLY,
+      g_param_spec_boolean ("parse-only", "Parse only",
+          "Only demux and parse the streams, without plugging decoders",
+          DEFAULT_PROP_PARSE_ONLY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:cache-file:
+   *
+   * Path of a file in which the results of the discovery of local files are
+   * cached, or %NULL to disable the cache.
+   *
+   * Results are identified by the URI together with the modification time,
+   * size and inode of the file, so files that did not change since they were
+   * cached are not discovered again and their cached result is returned
+   * right away. Only successful results are cached, and like with
+   * gst_discoverer_info_to_variant() TOCs are not preserved.
+   *
+   * The file is memory-mapped when the property is set, and the new results
+   * are written to it when the discoverer is disposed or the property
+   * changes.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_FILE,
+      g_param_spec_string ("cache-file", "Cache file",
+          "File in which discovery results are cached (NULL = no cache)",
+          DEFAULT_PROP_CACHE_FILE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:cache-hits:
+   *
+   * The number of URIs whose result was taken from the
+   * #GstDiscoverer:cache-file.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_HITS,
+      g_param_spec_uint ("cache-hits", "Cache hits",
+          "Number of results taken from the cache", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:cache-misses:
+   *
+   * The number of local files that had to be discovered because they were
+   * not in the #GstDiscoverer:cache-file or changed since they were cached.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_MISSES,
+      g_param_spec_uint ("cache-misses", "Cache misses",
+          "Number of local files not found in the cache", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /* signals */
   /**
    * GstDiscoverer::finished:
@@ -304,6 +457,21 @@ uridecodebin_element_added_cb (GstElement * uridecodebin,
   }
 }
 
+static gint
+uridecodebin_autoplug_select_cb (GstElement * uridecodebin, GstPad * pad,
+    GstCaps * caps, GstElementFactory * factory, GstDiscoverer * dc)
+{
+  if (dc->priv->parse_only &&
+      gst_element_factory_list_is_type (factory,
+          GST_ELEMENT_FACTORY_TYPE_DECODER)) {
+    GST_DEBUG_OBJECT (dc, "Not plugging decoder %s, exposing %" GST_PTR_FORMAT,
+        GST_OBJECT_NAME (factory), caps);
+    return AUTOPLUG_SELECT_EXPOSE;
+  }
+
+  return AUTOPLUG_SELECT_TRY;
+}
+
 static void
 gst_discoverer_init (GstDiscoverer * dc)
 {
@@ -314,6 +482,10 @@ gst_discoverer_init (GstDiscoverer * dc)
 
   dc->priv->timeout = DEFAULT_PROP_TIMEOUT;
   dc->priv->async = FALSE;
+  dc->priv->max_workers = DEFAULT_PROP_MAX_WORKERS;
+  dc->priv->parse_only = DEFAULT_PROP_PARSE_ONLY;
+  dc->priv->workers = g_ptr_array_new ();
+  g_queue_init (&dc->priv->idle_workers);
 
   g_mutex_init (&dc->priv->lock);
 
@@ -347,6 +519,9 @@ gst_discoverer_init (GstDiscoverer * dc)
   dc->priv->source_chg_id =
       g_signal_connect_object (dc->priv->uridecodebin, "notify::source",
       G_CALLBACK (uridecodebin_source_changed_cb), dc, 0);
+  dc->priv->autoplug_select_id =
+      g_signal_connect_object (dc->priv->uridecodebin, "autoplug-select",
+      G_CALLBACK (uridecodebin_autoplug_select_cb), dc, 0);
 
   GST_LOG_OBJECT (dc, "Getting pipeline bus");
   dc->priv->bus = gst_pipeline_get_bus ((GstPipeline *) dc->priv->pipeline);
@@ -408,6 +583,7 @@ gst_discoverer_dispose (GObject * obj)
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->no_more_pads_id);
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->source_chg_id);
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->element_added_id);
+    DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->autoplug_select_id);
     DISCONNECT_SIGNAL (dc->priv->bus, dc->priv->bus_cb_id);
 
     /* pipeline was set to NULL in _reset */
@@ -422,6 +598,26 @@ gst_discoverer_dispose (GObject * obj)
 
   gst_discoverer_stop (dc);
 
+  if (dc->priv->workers) {
+    guint i;
+
+    for (i = 0; i < dc->priv->workers->len; i++) {
+      GstDiscoverer *worker = g_ptr_array_index (dc->priv->workers, i);
+
+      g_signal_handlers_disconnect_by_data (worker, dc);
+      g_object_unref (worker);
+    }
+    g_ptr_array_free (dc->priv->workers, TRUE);
+    dc->priv->workers = NULL;
+    g_queue_clear (&dc->priv->idle_workers);
+  }
+
+  /* Writes the new results to the cache file */
+  if (dc->priv->cache) {
+    gst_discoverer_cache_unref (dc->priv->cache);
+    dc->priv->cache = NULL;
+  }
+
   if (dc->priv->seeking_query) {
     gst_query_unref (dc->priv->seeking_query);
     dc->priv->seeking_query = NULL;
@@ -450,6 +646,51 @@ gst_discoverer_set_property (GObject * object, guint prop_id,
     case PROP_TIMEOUT:
       gst_discoverer_set_timeout (dc, g_value_get_uint64 (value));
       break;
+    case PROP_MAX_WORKERS:
+      DISCO_LOCK (dc);
+      dc->priv->max_workers = g_value_get_uint (value);
+      DISCO_UNLOCK (dc);
+      /* More URIs may be processed right away now */
+      discoverer_dispatch_workers (dc);
+      break;
+    case PROP_REUSE_SOURCE:{
+      gboolean reuse = g_value_get_boolean (value);
+      guint i;
+
+      if (dc->priv->uridecodebin)
+        g_object_set (dc->priv->uridecodebin, "reuse-source", reuse, NULL);
+
+      DISCO_LOCK (dc);
+      for (i = 0; i < dc->priv->workers->len; i++)
+        g_object_set (g_ptr_array_index (dc->priv->workers, i),
+            "reuse-source", reuse, NULL);
+      DISCO_UNLOCK (dc);
+      break;
+    }
+    case PROP_PARSE_ONLY:{
+      guint i;
+
+      DISCO_LOCK (dc);
+      dc->priv->parse_only = g_value_get_boolean (value);
+      for (i = 0; i < dc->priv->workers->len; i++)
+        g_object_set (g_ptr_array_index (dc->priv->workers, i),
+            "parse-only", dc->priv->parse_only, NULL);
+      DISCO_UNLOCK (dc);
+      break;
+    }
+    case PROP_CACHE_FILE:{
+      const gchar *filename = g_value_get_string (value);
+      GstDiscovererCache *cache;
+
+      /* Write out the previous cache first, it might be the same file */
+      discoverer_set_cache (dc, NULL);
+      if (filename) {
+        cache = gst_discoverer_cache_new (filename);
+        discoverer_set_cache (dc, cache);
+        gst_discoverer_cache_unref (cache);
+      }
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -468,12 +709,63 @@ gst_discoverer_get_property (GObject * object, guint prop_id,
       g_value_set_uint64 (value, dc->priv->timeout);
       DISCO_UNLOCK (dc);
       break;
+    case PROP_MAX_WORKERS:
+      DISCO_LOCK (dc);
+      g_value_set_uint (value, dc->priv->max_workers);
+      DISCO_UNLOCK (dc);
+      break;
+    case PROP_REUSE_SOURCE:
+      if (dc->priv->uridecodebin)
+        g_object_get_property (G_OBJECT (dc->priv->uridecodebin),
+            "reuse-source", value);
+      break;
+    case PROP_PARSE_ONLY:
+      DISCO_LOCK (dc);
+      g_value_set_boolean (value, dc->priv->parse_only);
+      DISCO_UNLOCK (dc);
+      break;
+    case PROP_CACHE_FILE:
+      DISCO_LOCK (dc);
+      g_value_set_string (value, dc->priv->cache ?
+          gst_discoverer_cache_get_filename (dc->priv->cache) : NULL);
+      DISCO_UNLOCK (dc);
+      break;
+    case PROP_CACHE_HITS:
+    case PROP_CACHE_MISSES:{
+      guint hits = 0, misses = 0;
+
+      DISCO_LOCK (dc);
+      if (dc->priv->cache)
+        gst_discoverer_cache_get_stats (dc->priv->cache, &hits, &misses);
+      DISCO_UNLOCK (dc);
+      g_value_set_uint (value, prop_id == PROP_CACHE_HITS ? hits : misses);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* Replaces the cache of @dc and its workers, the previous cache is written
+ * to its file once no worker uses it anymore */
+static void
+discoverer_set_cache (GstDiscoverer * dc, GstDiscovererCache * cache)
+{
+  GstDiscovererCache *old;
+  guint i;
+
+  DISCO_LOCK (dc);
+  old = dc->priv->cache;
+  dc->priv->cache = cache ? gst_discoverer_cache_ref (cache) : NULL;
+  for (i = 0; dc->priv->workers && i < dc->priv->workers->len; i++)
+    discoverer_set_cache (g_ptr_array_index (dc->priv->workers, i), cache);
+  DISCO_UNLOCK (dc);
+
+  if (old)
+    gst_discoverer_cache_unref (old);
+}
+
 static void
 gst_discoverer_set_timeout (GstDiscoverer * dc, GstClockTime timeout)
 {
@@ -482,6 +774,13 @@ gst_discoverer_set_timeout (GstDiscoverer * dc, GstClockTime timeout)
   /* FIXME : update current pending timeout if we're running */
   DISCO_LOCK (dc);
   dc->priv->timeout = timeout;
+  if (dc->priv->workers) {
+    guint i;
+
+    for (i = 0; i < dc->priv->workers->len; i++)
+      gst_discoverer_set_timeout (g_ptr_array_index (dc->priv->workers, i),
+          timeout);
+  }
   DISCO_UNLOCK (dc);
 }
 
@@ -1419,6 +1718,10 @@ discoverer_collect (GstDiscoverer * dc)
     }
   }
 
+  if (dc->priv->cache && !dc->priv->current_cached)
+    gst_discoverer_cache_store (dc->priv->cache, dc->priv->current_info,
+        dc->priv->parse_only);
+
   if (dc->priv->async) {
     GST_DEBUG ("Emitting 'discoverered'");
     g_signal_emit (dc, gst_discoverer_signals[SIGNAL_DISCOVERED], 0,
@@ -1522,6 +1825,12 @@ handle_message (GstDiscoverer * dc, GstMessage * msg)
       const gchar *name =
           gst_structure_get_name (gst_message_get_structure (msg));
 
+      if (!g_strcmp0 (name, "DiscovererCached")) {
+        /* The result was taken from the cache, there's nothing to wait for */
+        done = TRUE;
+        break;
+      }
+
       if (g_strcmp0 (name, "DiscovererDone"))
         break;
 
@@ -1685,6 +1994,27 @@ _setup_locked (GstDiscoverer * dc)
   dc->priv->pending_uris =
       g_list_delete_link (dc->priv->pending_uris, dc->priv->pending_uris);
 
+  if (dc->priv->cache) {
+    GstDiscovererInfo *cached;
+
+    cached = gst_discoverer_cache_lookup (dc->priv->cache,
+        dc->priv->current_info->uri, dc->priv->parse_only);
+    if (cached) {
+      GST_DEBUG ("Using cached result for %s", dc->priv->current_info->uri);
+      gst_discoverer_info_unref (dc->priv->current_info);
+      dc->priv->current_info = cached;
+      dc->priv->current_cached = TRUE;
+      dc->priv->processing = TRUE;
+
+      /* Finish from the bus like any other discovery, without ever starting
+       * the pipeline */
+      gst_element_post_message ((GstElement *) dc->priv->pipeline,
+          gst_message_new_application (NULL,
+              gst_structure_new_empty ("DiscovererCached")));
+      return;
+    }
+  }
+
   /* set uri on uridecodebin */
   g_object_set (dc->priv->uridecodebin, "uri", dc->priv->current_info->uri,
       NULL);
@@ -1716,6 +2046,15 @@ _setup_locked (GstDiscoverer * dc)
       gst_element_state_change_return_get_name (ret));
 }
 
+/* Returns TRUE if neither the discoverer nor any of its workers has URIs
+ * left to process */
+static gboolean
+discoverer_is_finished_locked (GstDiscoverer * dc)
+{
+  return dc->priv->current_info == NULL && dc->priv->pending_uris == NULL
+      && dc->priv->busy_workers == 0;
+}
+
 static void
 discoverer_cleanup (GstDiscoverer * dc)
 {
@@ -1754,6 +2093,7 @@ discoverer_cleanup (GstDiscoverer * dc)
   dc->priv->target_state = GST_STATE_NULL;
   dc->priv->no_more_pads = FALSE;
   dc->priv->cleanup = FALSE;
+  dc->priv->current_cached = FALSE;
 
 
   /* Try popping the next uri */
@@ -1763,10 +2103,13 @@ discoverer_cleanup (GstDiscoverer * dc)
       DISCO_UNLOCK (dc);
       /* Start timeout */
       handle_current_async (dc);
-    } else {
+    } else if (discoverer_is_finished_locked (dc)) {
       /* We're done ! */
       DISCO_UNLOCK (dc);
       g_signal_emit (dc, gst_discoverer_signals[SIGNAL_FINISHED], 0);
+    } else {
+      /* Some workers are still busy, the last one emits 'finished' */
+      DISCO_UNLOCK (dc);
     }
   } else
     DISCO_UNLOCK (dc);
@@ -1847,6 +2190,171 @@ beach:
   return res;
 }
 
+/* Worker pool
+ *
+ * With max-workers > 1, additional URIs are handed out to helper discoverers
+ * running in async mode on the same main context. Each helper is given one URI
+ * at a time, its results are forwarded through our own signals and it goes
+ * back to the idle queue once it emitted 'finished'. */
+
+static void
+worker_starting_cb (GstDiscoverer * worker, GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_STARTING], 0);
+}
+
+static void
+worker_discovered_cb (GstDiscoverer * worker, GstDiscovererInfo * info,
+    const GError * err, GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_DISCOVERED], 0, info, err);
+}
+
+static void
+worker_source_setup_cb (GstDiscoverer * worker, GstElement * source,
+    GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_SOURCE_SETUP], 0, source);
+}
+
+static void
+worker_finished_cb (GstDiscoverer * worker, GstDiscoverer * dc)
+{
+  gboolean finished;
+
+  GST_DEBUG_OBJECT (dc, "Worker %p is done", worker);
+
+  DISCO_LOCK (dc);
+  dc->priv->busy_workers--;
+  g_queue_push_tail (&dc->priv->idle_workers, worker);
+  DISCO_UNLOCK (dc);
+
+  discoverer_dispatch_workers (dc);
+
+  DISCO_LOCK (dc);
+  finished = dc->priv->async && discoverer_is_finished_locked (dc);
+  DISCO_UNLOCK (dc);
+
+  if (finished)
+    g_signal_emit (dc, gst_discoverer_signals[SIGNAL_FINISHED], 0);
+}
+
+/* Must be called with the lock */
+static GstDiscoverer *
+discoverer_new_worker_locked (GstDiscoverer * dc)
+{
+  GstDiscoverer *worker;
+
+  worker = g_object_new (GST_TYPE_DISCOVERER, "timeout", dc->priv->timeout,
+      NULL);
+  if (dc->priv->uridecodebin) {
+    gboolean reuse;
+
+    g_object_get (dc->priv->uridecodebin, "reuse-source", &reuse, NULL);
+    g_object_set (worker, "reuse-source", reuse, NULL);
+  }
+  g_object_set (worker, "parse-only", dc->priv->parse_only, NULL);
+  if (dc->priv->cache)
+    discoverer_set_cache (worker, dc->priv->cache);
+  g_signal_connect (worker, "starting", G_CALLBACK (worker_starting_cb), dc);
+  g_signal_connect (worker, "discovered", G_CALLBACK (worker_discovered_cb),
+      dc);
+  g_signal_connect (worker, "source-setup",
+      G_CALLBACK (worker_source_setup_cb), dc);
+  g_signal_connect (worker, "finished", G_CALLBACK (worker_finished_cb), dc);
+  g_ptr_array_add (dc->priv->workers, worker);
+
+  GST_DEBUG_OBJECT (dc, "Created worker %p, now %u workers", worker,
+      dc->priv->workers->len);
+
+  return worker;
+}
+
+/* Hands pending URIs to idle workers for as long as the max-workers budget
+ * allows it. The discoverer itself always takes its next URI in
+ * discoverer_cleanup(), so this only ever uses max-workers - 1 helpers. */
+static void
+discoverer_dispatch_workers (GstDiscoverer * dc)
+{
+  while (TRUE) {
+    GstDiscoverer *worker;
+    gchar *uri;
+
+    DISCO_LOCK (dc);
+    if (!dc->priv->async || dc->priv->pending_uris == NULL ||
+        dc->priv->busy_workers + 1 >= dc->priv->max_workers) {
+      DISCO_UNLOCK (dc);
+      return;
+    }
+
+    worker = g_queue_pop_head (&dc->priv->idle_workers);
+    if (worker == NULL)
+      worker = discoverer_new_worker_locked (dc);
+
+    uri = (gchar *) dc->priv->pending_uris->data;
+    dc->priv->pending_uris =
+        g_list_delete_link (dc->priv->pending_uris, dc->priv->pending_uris);
+    dc->priv->busy_workers++;
+    DISCO_UNLOCK (dc);
+
+    GST_DEBUG_OBJECT (dc, "Handing %s to worker %p", uri, worker);
+
+    /* The worker is idle, so this will start processing the uri right away */
+    DISCO_LOCK (worker);
+    worker->priv->pending_uris =
+        g_list_append (worker->priv->pending_uris, uri);
+    DISCO_UNLOCK (worker);
+
+    if (worker->priv->async)
+      start_discovering (worker);
+    else
+      discoverer_start_with_context (worker, dc->priv->ctx);
+  }
+}
+
+static gboolean
+retired_worker_release (gpointer worker)
+{
+  /* the worker is unreffed by the destroy notify */
+  return G_SOURCE_REMOVE;
+}
+
+static void
+discoverer_stop_workers (GstDiscoverer * dc)
+{
+  guint i = 0;
+
+  if (dc->priv->workers == NULL)
+    return;
+
+  DISCO_LOCK (dc);
+  while (i < dc->priv->workers->len) {
+    GstDiscoverer *worker = g_ptr_array_index (dc->priv->workers, i);
+
+    if (g_queue_find (&dc->priv->idle_workers, worker)) {
+      gst_discoverer_stop (worker);
+      i++;
+    } else {
+      GSource *source;
+
+      /* Interrupted in the middle of a discovery, it can't be reused but
+       * might still be referenced from one of its callbacks, so only release
+       * it from the main context once those returned */
+      g_signal_handlers_disconnect_by_data (worker, dc);
+      gst_discoverer_stop (worker);
+      g_ptr_array_remove_index_fast (dc->priv->workers, i);
+
+      source = g_idle_source_new ();
+      g_source_set_callback (source, retired_worker_release, worker,
+          g_object_unref);
+      g_source_attach (source, dc->priv->ctx);
+      g_source_unref (source);
+    }
+  }
+  dc->priv->busy_workers = 0;
+  DISCO_UNLOCK (dc);
+}
+
 /* Serializing code */
 
 static GVariant *
@@ -2174,7 +2682,6 @@ out:
 void
 gst_discoverer_start (GstDiscoverer * discoverer)
 {
-  GSource *source;
   GMainContext *ctx = NULL;
 
   g_return_if_fail (GST_IS_DISCOVERER (discoverer));
@@ -2186,24 +2693,33 @@ gst_discoverer_start (GstDiscoverer * discoverer)
     return;
   }
 
-  discoverer->priv->async = TRUE;
-  discoverer->priv->running = TRUE;
-
   ctx = g_main_context_get_thread_default ();
 
-  /* Connect to bus signals */
   if (ctx == NULL)
     ctx = g_main_context_default ();
 
-  source = gst_bus_create_watch (discoverer->priv->bus);
+  discoverer_start_with_context (discoverer, ctx);
+  discoverer_dispatch_workers (discoverer);
+  GST_DEBUG_OBJECT (discoverer, "Started");
+}
+
+static void
+discoverer_start_with_context (GstDiscoverer * dc, GMainContext * ctx)
+{
+  GSource *source;
+
+  dc->priv->async = TRUE;
+  dc->priv->running = TRUE;
+
+  /* Connect to bus signals */
+  source = gst_bus_create_watch (dc->priv->bus);
   g_source_set_callback (source, (GSourceFunc) gst_bus_async_signal_func,
       NULL, NULL);
-  discoverer->priv->sourceid = g_source_attach (source, ctx);
+  dc->priv->sourceid = g_source_attach (source, ctx);
   g_source_unref (source);
-  discoverer->priv->ctx = g_main_context_ref (ctx);
+  dc->priv->ctx = g_main_context_ref (ctx);
 
-  start_discovering (discoverer);
-  GST_DEBUG_OBJECT (discoverer, "Started");
+  start_discovering (dc);
 }
 
 /**
@@ -2240,6 +2756,8 @@ gst_discoverer_stop (GstDiscoverer * discoverer)
   discoverer->priv->running = FALSE;
   DISCO_UNLOCK (discoverer);
 
+  discoverer_stop_workers (discoverer);
+
   /* Remove timeout handler */
   if (discoverer->priv->timeoutid) {
     g_source_remove (discoverer->priv->timeoutid);
@@ -2288,7 +2806,10 @@ gst_discoverer_discover_uri_async (GstDiscoverer * discoverer,
   GST_DEBUG_OBJECT (discoverer, "uri : %s", uri);
 
   DISCO_LOCK (discoverer);
-  can_run = (discoverer->priv->pending_uris == NULL);
+  /* If we're busy, the uri will either be picked up once the current one is
+   * done or by one of the workers */
+  can_run = (discoverer->priv->pending_uris == NULL
+      && discoverer->priv->current_info == NULL);
   discoverer->priv->pending_uris =
       g_list_append (discoverer->priv->pending_uris, g_strdup (uri));
   DISCO_UNLOCK (discoverer);
@@ -2296,6 +2817,8 @@ gst_discoverer_discover_uri_async (GstDiscoverer * discoverer,
   if (can_run)
     start_discovering (discoverer);
 
+  discoverer_dispatch_workers (discoverer);
+
   return TRUE;
 }
 
@@ -109,6 +109,35 @@ struct _GstDiscovererInfo {
   gpointer _gst_reserved[GST_PADDING];
 };
 
+/* gstdiscoverer-cache.c */
+typedef struct _GstDiscovererCache GstDiscovererCache;
+
+G_GNUC_INTERNAL
+GstDiscovererCache *gst_discoverer_cache_new (const gchar * filename);
+
+G_GNUC_INTERNAL
+GstDiscovererCache *gst_discoverer_cache_ref (GstDiscovererCache * cache);
+
+G_GNUC_INTERNAL
+void gst_discoverer_cache_unref (GstDiscovererCache * cache);
+
+G_GNUC_INTERNAL
+const gchar *gst_discoverer_cache_get_filename (GstDiscovererCache * cache);
+
+G_GNUC_INTERNAL
+GstDiscovererInfo *gst_discoverer_cache_lookup (GstDiscovererCache * cache,
+                                                const gchar * uri,
+                                                gboolean parse_only);
+
+G_GNUC_INTERNAL
+void gst_discoverer_cache_store (GstDiscovererCache * cache,
+                                 GstDiscovererInfo * info,
+                                 gboolean parse_only);
+
+G_GNUC_INTERNAL
+void gst_discoverer_cache_get_stats (GstDiscovererCache * cache,
+                                     guint * hits, guint * misses);
+
 /* missing-plugins.c */
 G_GNUC_INTERNAL
 GstCaps *copy_and_clean_caps (const GstCaps * caps);
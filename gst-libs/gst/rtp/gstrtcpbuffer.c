@@ -491,20 +491,9 @@ end:
   }
 }
 
-/**
- * gst_rtcp_buffer_add_packet:
- * @rtcp: a valid RTCP buffer
- * @type: the #GstRTCPType of the new packet
- * @packet: pointer to new packet
- *
- * Add a new packet of @type to @rtcp. @packet will point to the newly created
- * packet.
- *
- * Returns: %TRUE if the packet could be created. This function returns %FALSE
- * if the max mtu is exceeded for the buffer.
- */
-gboolean
-gst_rtcp_buffer_add_packet (GstRTCPBuffer * rtcp, GstRTCPType type,
+/* write the header of a new packet of @type at @packet->offset */
+static gboolean
+write_packet_header (GstRTCPBuffer * rtcp, GstRTCPType type,
     GstRTCPPacket * packet)
 {
   guint len;
@@ -512,16 +501,6 @@ gst_rtcp_buffer_add_packet (GstRTCPBuffer * rtcp, GstRTCPType type,
   guint8 *data;
   gboolean result;
 
-  g_return_val_if_fail (rtcp != NULL, FALSE);
-  g_return_val_if_fail (GST_IS_BUFFER (rtcp->buffer), FALSE);
-  g_return_val_if_fail (type != GST_RTCP_TYPE_INVALID, FALSE);
-  g_return_val_if_fail (packet != NULL, FALSE);
-  g_return_val_if_fail (rtcp->map.flags & GST_MAP_WRITE, FALSE);
-
-  /* find free space */
-  if (gst_rtcp_buffer_get_first_packet (rtcp, packet))
-    while (gst_rtcp_packet_move_to_next (packet));
-
   maxsize = rtcp->map.maxsize;
 
   /* packet->offset is now pointing to the next free offset in the buffer to
@@ -587,6 +566,74 @@ no_space:
   }
 }
 
+/**
+ * gst_rtcp_buffer_add_packet:
+ * @rtcp: a valid RTCP buffer
+ * @type: the #GstRTCPType of the new packet
+ * @packet: pointer to new packet
+ *
+ * Add a new packet of @type to @rtcp. @packet will point to the newly created
+ * packet.
+ *
+ * Returns: %TRUE if the packet could be created. This function returns %FALSE
+ * if the max mtu is exceeded for the buffer.
+ */
+gboolean
+gst_rtcp_buffer_add_packet (GstRTCPBuffer * rtcp, GstRTCPType type,
+    GstRTCPPacket * packet)
+{
+  g_return_val_if_fail (rtcp != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (rtcp->buffer), FALSE);
+  g_return_val_if_fail (type != GST_RTCP_TYPE_INVALID, FALSE);
+  g_return_val_if_fail (packet != NULL, FALSE);
+  g_return_val_if_fail (rtcp->map.flags & GST_MAP_WRITE, FALSE);
+
+  /* find free space */
+  if (gst_rtcp_buffer_get_first_packet (rtcp, packet))
+    while (gst_rtcp_packet_move_to_next (packet));
+
+  return write_packet_header (rtcp, type, packet);
+}
+
+/**
+ * gst_rtcp_buffer_append_packet:
+ * @rtcp: a valid RTCP buffer
+ * @type: the #GstRTCPType of the new packet
+ * @packet: pointer to new packet
+ *
+ * Add a new packet of @type at the end of the data of @rtcp. @packet will
+ * point to the newly created packet.
+ *
+ * Unlike gst_rtcp_buffer_add_packet(), this function does not walk all
+ * packets already in @rtcp to find the free space, which makes building
+ * compound packets with many packets, like report blocks for hundreds of
+ * sources, linear in the number of packets. It should only be used on
+ * buffers that were created with gst_rtcp_buffer_new() and filled with the
+ * functions of this library, so that the size of the mapped data matches
+ * the end of the last packet.
+ *
+ * Returns: %TRUE if the packet could be created. This function returns %FALSE
+ * if the max mtu is exceeded for the buffer.
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_rtcp_buffer_append_packet (GstRTCPBuffer * rtcp, GstRTCPType type,
+    GstRTCPPacket * packet)
+{
+  g_return_val_if_fail (rtcp != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (rtcp->buffer), FALSE);
+  g_return_val_if_fail (type != GST_RTCP_TYPE_INVALID, FALSE);
+  g_return_val_if_fail (packet != NULL, FALSE);
+  g_return_val_if_fail (rtcp->map.flags & GST_MAP_WRITE, FALSE);
+
+  packet->rtcp = rtcp;
+  packet->offset = rtcp->map.size;
+  packet->type = GST_RTCP_TYPE_INVALID;
+
+  return write_packet_header (rtcp, type, packet);
+}
+
 /**
  * gst_rtcp_packet_remove:
  * @packet: a #GstRTCPPacket
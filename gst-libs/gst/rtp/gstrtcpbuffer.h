@@ -269,6 +269,10 @@ GST_RTP_API
 gboolean        gst_rtcp_buffer_add_packet        (GstRTCPBuffer *rtcp, GstRTCPType type,
                                                    GstRTCPPacket *packet);
 
+GST_RTP_API
+gboolean        gst_rtcp_buffer_append_packet     (GstRTCPBuffer *rtcp, GstRTCPType type,
+                                                   GstRTCPPacket *packet);
+
 GST_RTP_API
 gboolean        gst_rtcp_packet_remove            (GstRTCPPacket *packet);
 
@@ -29,6 +29,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstrtpbasedepayload.h"
 #include "gstrtpmeta.h"
 
@@ -61,6 +63,9 @@ struct _GstRTPBaseDepayloadPrivate
 
   gboolean source_info;
   GstBuffer *input_buffer;
+
+  /* GstRTPBuffer array used for process_rtp_packet_list */
+  GArray *rtp_buffers;
 };
 
 /* Filter signals and args */
@@ -251,6 +256,7 @@ gst_rtp_base_depayload_init (GstRTPBaseDepayload * filter,
   priv->pts = -1;
   priv->duration = -1;
   priv->source_info = DEFAULT_SOURCE_INFO;
+  priv->rtp_buffers = g_array_new (FALSE, FALSE, sizeof (GstRTPBuffer));
 
   gst_segment_init (&filter->segment, GST_FORMAT_UNDEFINED);
 }
@@ -258,6 +264,10 @@ gst_rtp_base_depayload_init (GstRTPBaseDepayload * filter,
 static void
 gst_rtp_base_depayload_finalize (GObject * object)
 {
+  GstRTPBaseDepayload *filter = GST_RTP_BASE_DEPAYLOAD_CAST (object);
+
+  g_array_free (filter->priv->rtp_buffers, TRUE);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -346,64 +356,40 @@ caps_not_changed:
   }
 }
 
-/* takes ownership of the input buffer */
-static GstFlowReturn
-gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
-    GstRTPBaseDepayloadClass * bclass, GstBuffer * in)
+/* Check the seqnum and ssrc of @rtp against the ones we expect and update the
+ * tracking state. This is a very simple check that makes sure that the seqnums
+ * are strictly increasing, dropping anything that is out of the ordinary.
+ * Returns %FALSE when the packet should be dropped. @discont is set to %TRUE
+ * when a discontinuity was detected. */
+static gboolean
+gst_rtp_base_depayload_check_packet (GstRTPBaseDepayload * filter,
+    GstRTPBuffer * rtp, gboolean * discont)
 {
-  GstBuffer *(*process_rtp_packet_func) (GstRTPBaseDepayload * base,
-      GstRTPBuffer * rtp_buffer);
-  GstBuffer *(*process_func) (GstRTPBaseDepayload * base, GstBuffer * in);
-  GstRTPBaseDepayloadPrivate *priv;
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstBuffer *out_buf;
+  GstRTPBaseDepayloadPrivate *priv = filter->priv;
   guint32 ssrc;
   guint16 seqnum;
   guint32 rtptime;
-  gboolean discont, buf_discont;
   gint gap;
-  GstRTPBuffer rtp = { NULL };
-
-  priv = filter->priv;
-
-  process_func = bclass->process;
-  process_rtp_packet_func = bclass->process_rtp_packet;
-
-  /* we must have a setcaps first */
-  if (G_UNLIKELY (!priv->negotiated))
-    goto not_negotiated;
-
-  if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, &rtp)))
-    goto invalid_buffer;
 
-  buf_discont = GST_BUFFER_IS_DISCONT (in);
-
-  priv->pts = GST_BUFFER_PTS (in);
-  priv->dts = GST_BUFFER_DTS (in);
-  priv->duration = GST_BUFFER_DURATION (in);
-
-  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
-  seqnum = gst_rtp_buffer_get_seq (&rtp);
-  rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (rtp);
+  seqnum = gst_rtp_buffer_get_seq (rtp);
+  rtptime = gst_rtp_buffer_get_timestamp (rtp);
 
   priv->last_seqnum = seqnum;
   priv->last_rtptime = rtptime;
 
-  discont = buf_discont;
-
   GST_LOG_OBJECT (filter, "discont %d, seqnum %u, rtptime %u, pts %"
-      GST_TIME_FORMAT ", dts %" GST_TIME_FORMAT, buf_discont, seqnum, rtptime,
-      GST_TIME_ARGS (priv->pts), GST_TIME_ARGS (priv->dts));
+      GST_TIME_FORMAT ", dts %" GST_TIME_FORMAT, *discont, seqnum, rtptime,
+      GST_TIME_ARGS (GST_BUFFER_PTS (rtp->buffer)),
+      GST_TIME_ARGS (GST_BUFFER_DTS (rtp->buffer)));
 
-  /* Check seqnum. This is a very simple check that makes sure that the seqnums
-   * are strictly increasing, dropping anything that is out of the ordinary. We
-   * can only do this when the next_seqnum is known. */
+  /* We can only do this when the next_seqnum is known. */
   if (G_LIKELY (priv->next_seqnum != -1)) {
     if (ssrc != priv->last_ssrc) {
       GST_LOG_OBJECT (filter,
           "New ssrc %u (current ssrc %u), sender restarted",
           ssrc, priv->last_ssrc);
-      discont = TRUE;
+      *discont = TRUE;
     } else {
       gap = gst_rtp_buffer_compare_seqnum (seqnum, priv->next_seqnum);
 
@@ -415,18 +401,20 @@ gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
           /* seqnum > next_seqnum, we are missing some packets, this is always a
            * DISCONT. */
           GST_LOG_OBJECT (filter, "%d missing packets", gap);
-          discont = TRUE;
+          *discont = TRUE;
         } else {
           /* seqnum < next_seqnum, we have seen this packet before or the sender
            * could be restarted. If the packet is not too old, we throw it away as
            * a duplicate, otherwise we mark discont and continue. 100 misordered
            * packets is a good threshold. See also RFC 4737. */
-          if (gap < 100)
-            goto dropping;
+          if (gap < 100) {
+            GST_WARNING_OBJECT (filter, "%d <= 100, dropping old packet", gap);
+            return FALSE;
+          }
 
           GST_LOG_OBJECT (filter,
               "%d > 100, packet too old, sender likely restarted", gap);
-          discont = TRUE;
+          *discont = TRUE;
         }
       }
     }
@@ -434,31 +422,98 @@ gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
   priv->next_seqnum = (seqnum + 1) & 0xffff;
   priv->last_ssrc = ssrc;
 
+  return TRUE;
+}
+
+/* we detected a seqnum discont but the buffer was not flagged with a discont,
+ * set the discont flag so that the subclass can throw away old data. @in is
+ * replaced with the flagged buffer. Returns %FALSE when the new buffer could
+ * not be mapped in @rtp again. */
+static gboolean
+gst_rtp_base_depayload_mark_discont (GstRTPBaseDepayload * filter,
+    GstBuffer ** in, GstRTPBuffer * rtp)
+{
+  gpointer old_inbuf = *in;
+
+  GST_LOG_OBJECT (filter, "mark DISCONT on input buffer");
+  *in = gst_buffer_make_writable (*in);
+  GST_BUFFER_FLAG_SET (*in, GST_BUFFER_FLAG_DISCONT);
+  /* depayloaders will check flag on rtpbuffer->buffer, so if the input
+   * buffer was not writable already we need to remap to make our
+   * newly-flagged buffer current on the rtpbuffer */
+  if (*in != old_inbuf) {
+    gst_rtp_buffer_unmap (rtp);
+    if (G_UNLIKELY (!gst_rtp_buffer_map (*in, GST_MAP_READ, rtp)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static void
+gst_rtp_base_depayload_not_negotiated (GstRTPBaseDepayload * filter)
+{
+  /* this is not fatal but should be filtered earlier */
+  GST_ELEMENT_ERROR (filter, CORE, NEGOTIATION,
+      ("No RTP format was negotiated."),
+      ("Input buffers need to have RTP caps set on them. This is usually "
+          "achieved by setting the 'caps' property of the upstream source "
+          "element (often udpsrc or appsrc), or by putting a capsfilter "
+          "element before the depayloader and setting the 'caps' property "
+          "on that. Also see http://cgit.freedesktop.org/gstreamer/"
+          "gst-plugins-good/tree/gst/rtp/README"));
+}
+
+/* takes ownership of the input buffer */
+static GstFlowReturn
+gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
+    GstRTPBaseDepayloadClass * bclass, GstBuffer * in)
+{
+  GstBuffer *(*process_rtp_packet_func) (GstRTPBaseDepayload * base,
+      GstRTPBuffer * rtp_buffer);
+  GstBuffer *(*process_func) (GstRTPBaseDepayload * base, GstBuffer * in);
+  GstRTPBaseDepayloadPrivate *priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *out_buf;
+  gboolean discont, buf_discont;
+  GstRTPBuffer rtp = { NULL };
+
+  priv = filter->priv;
+
+  process_func = bclass->process;
+  process_rtp_packet_func = bclass->process_rtp_packet;
+
+  /* we must have a setcaps first */
+  if (G_UNLIKELY (!priv->negotiated))
+    goto not_negotiated;
+
+  if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, &rtp)))
+    goto invalid_buffer;
+
+  buf_discont = GST_BUFFER_IS_DISCONT (in);
+
+  priv->pts = GST_BUFFER_PTS (in);
+  priv->dts = GST_BUFFER_DTS (in);
+  priv->duration = GST_BUFFER_DURATION (in);
+
+  discont = buf_discont;
+
+  if (G_UNLIKELY (!gst_rtp_base_depayload_check_packet (filter, &rtp,
+              &discont)))
+    goto dropping;
+
   if (G_UNLIKELY (discont)) {
     priv->discont = TRUE;
     if (!buf_discont) {
-      gpointer old_inbuf = in;
-
-      /* we detected a seqnum discont but the buffer was not flagged with a discont,
-       * set the discont flag so that the subclass can throw away old data. */
-      GST_LOG_OBJECT (filter, "mark DISCONT on input buffer");
-      in = gst_buffer_make_writable (in);
-      GST_BUFFER_FLAG_SET (in, GST_BUFFER_FLAG_DISCONT);
-      /* depayloaders will check flag on rtpbuffer->buffer, so if the input
-       * buffer was not writable already we need to remap to make our
-       * newly-flagged buffer current on the rtpbuffer */
-      if (in != old_inbuf) {
-        gst_rtp_buffer_unmap (&rtp);
-        if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, &rtp)))
-          goto invalid_buffer;
-      }
+      if (G_UNLIKELY (!gst_rtp_base_depayload_mark_discont (filter, &in,
+                  &rtp)))
+        goto invalid_buffer;
     }
   }
 
   /* prepare segment event if needed */
   if (filter->need_newsegment) {
-    priv->segment_event = create_segment_event (filter, rtptime,
-        GST_BUFFER_PTS (in));
+    priv->segment_event = create_segment_event (filter,
+        gst_rtp_buffer_get_timestamp (&rtp), GST_BUFFER_PTS (in));
     filter->need_newsegment = FALSE;
   }
 
@@ -487,15 +542,7 @@ gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
   /* ERRORS */
 not_negotiated:
   {
-    /* this is not fatal but should be filtered earlier */
-    GST_ELEMENT_ERROR (filter, CORE, NEGOTIATION,
-        ("No RTP format was negotiated."),
-        ("Input buffers need to have RTP caps set on them. This is usually "
-            "achieved by setting the 'caps' property of the upstream source "
-            "element (often udpsrc or appsrc), or by putting a capsfilter "
-            "element before the depayloader and setting the 'caps' property "
-            "on that. Also see http://cgit.freedesktop.org/gstreamer/"
-            "gst-plugins-good/tree/gst/rtp/README"));
+    gst_rtp_base_depayload_not_negotiated (filter);
     gst_buffer_unref (in);
     return GST_FLOW_NOT_NEGOTIATED;
   }
@@ -510,7 +557,6 @@ invalid_buffer:
 dropping:
   {
     gst_rtp_buffer_unmap (&rtp);
-    GST_WARNING_OBJECT (filter, "%d <= 100, dropping old packet", gap);
     gst_buffer_unref (in);
     return GST_FLOW_OK;
   }
@@ -525,6 +571,127 @@ no_process:
   }
 }
 
+/* Map and check all packets of @list in one go and hand the accepted ones to
+ * the process_rtp_packet_list vmethod of the subclass. Takes ownership of
+ * @list. */
+static GstFlowReturn
+gst_rtp_base_depayload_handle_buffer_list (GstRTPBaseDepayload * filter,
+    GstRTPBaseDepayloadClass * bclass, GstBufferList * list)
+{
+  GstRTPBaseDepayloadPrivate *priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBufferList *out_list;
+  GstRTPBuffer *rtps;
+  GstBuffer *in;
+  gboolean discont, buf_discont;
+  guint i, len, n_rtps;
+
+  priv = filter->priv;
+
+  /* we must have a setcaps first */
+  if (G_UNLIKELY (!priv->negotiated))
+    goto not_negotiated;
+
+  len = gst_buffer_list_length (list);
+
+  /* the array is kept around between lists so that we don't need to
+   * allocate for every list */
+  g_array_set_size (priv->rtp_buffers, len);
+  rtps = (GstRTPBuffer *) priv->rtp_buffers->data;
+  n_rtps = 0;
+
+  for (i = 0; i < len; i++) {
+    GstRTPBuffer *rtp = &rtps[n_rtps];
+
+    memset (rtp, 0, sizeof (GstRTPBuffer));
+    /* FIXME: add a way to steal buffers from list as we will unref it anyway */
+    in = gst_buffer_ref (gst_buffer_list_get (list, i));
+
+    if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, rtp))) {
+      GST_ELEMENT_WARNING (filter, STREAM, DECODE, (NULL),
+          ("Received invalid RTP payload, dropping"));
+      gst_buffer_unref (in);
+      continue;
+    }
+
+    buf_discont = GST_BUFFER_IS_DISCONT (in);
+    discont = buf_discont;
+
+    if (G_UNLIKELY (!gst_rtp_base_depayload_check_packet (filter, rtp,
+                &discont))) {
+      gst_rtp_buffer_unmap (rtp);
+      gst_buffer_unref (in);
+      continue;
+    }
+
+    if (G_UNLIKELY (discont)) {
+      /* only the first output buffer gets marked by us, for packets later in
+       * the list the subclass takes the flag over to its output */
+      if (n_rtps == 0)
+        priv->discont = TRUE;
+      if (!buf_discont) {
+        if (G_UNLIKELY (!gst_rtp_base_depayload_mark_discont (filter, &in,
+                    rtp))) {
+          GST_ELEMENT_WARNING (filter, STREAM, DECODE, (NULL),
+              ("Received invalid RTP payload, dropping"));
+          gst_buffer_unref (in);
+          continue;
+        }
+      }
+    }
+
+    /* the timestamps of the first accepted packet are applied to the first
+     * output buffer without timestamps, like in the single buffer case */
+    if (n_rtps == 0) {
+      priv->pts = GST_BUFFER_PTS (in);
+      priv->dts = GST_BUFFER_DTS (in);
+      priv->duration = GST_BUFFER_DURATION (in);
+      priv->input_buffer = in;
+
+      /* prepare segment event if needed */
+      if (filter->need_newsegment) {
+        priv->segment_event = create_segment_event (filter,
+            gst_rtp_buffer_get_timestamp (rtp), GST_BUFFER_PTS (in));
+        filter->need_newsegment = FALSE;
+      }
+    }
+    n_rtps++;
+  }
+  gst_buffer_list_unref (list);
+
+  GST_LOG_OBJECT (filter, "processing %u of %u packets", n_rtps, len);
+
+  if (n_rtps == 0)
+    return GST_FLOW_OK;
+
+  out_list = bclass->process_rtp_packet_list (filter, rtps, n_rtps);
+
+  /* let's send it out to processing */
+  if (out_list) {
+    if (gst_buffer_list_length (out_list) > 0)
+      ret = gst_rtp_base_depayload_push_list (filter, out_list);
+    else
+      gst_buffer_list_unref (out_list);
+  }
+
+  priv->input_buffer = NULL;
+  for (i = 0; i < n_rtps; i++) {
+    in = rtps[i].buffer;
+    gst_rtp_buffer_unmap (&rtps[i]);
+    gst_buffer_unref (in);
+  }
+
+  return ret;
+
+  /* ERRORS */
+not_negotiated:
+  {
+    gst_rtp_base_depayload_not_negotiated (filter);
+    gst_buffer_list_unref (list);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+}
+
 static GstFlowReturn
 gst_rtp_base_depayload_chain (GstPad * pad, GstObject * parent, GstBuffer * in)
 {
@@ -555,6 +722,10 @@ gst_rtp_base_depayload_chain_list (GstPad * pad, GstObject * parent,
 
   bclass = GST_RTP_BASE_DEPAYLOAD_GET_CLASS (basedepay);
 
+  /* let the subclass process the whole list at once if it can */
+  if (bclass->process_rtp_packet_list != NULL)
+    return gst_rtp_base_depayload_handle_buffer_list (basedepay, bclass, list);
+
   flow_ret = GST_FLOW_OK;
 
   /* chain each buffer in list individually */
@@ -82,6 +82,17 @@ struct _GstRTPBaseDepayload
  * timestamp, the timestamp of the input buffer will be applied to the result
  * buffer and the output buffer will be pushed out. If this function returns
  * %NULL, nothing is pushed out. Since: 1.6.
+ * @process_rtp_packet_list: Process all packets of an incoming #GstBufferList
+ * at once. The base class maps the packets (with GST_MAP_READ) and checks
+ * their seqnums in one pass, dropping invalid and duplicate packets and
+ * flagging the first packet after a discontinuity with DISCONT, and then
+ * passes the @n_rtp_buffers accepted packets in @rtp_buffers. The packets
+ * stay owned and mapped by the base class. Output buffers without a valid
+ * timestamp get the timestamp of the first packet. A discontinuity at the
+ * first packet is marked on the first output buffer, for later packets the
+ * subclass should flag the output itself. If this function returns
+ * %NULL or an empty list, nothing is pushed out. When not implemented, the
+ * packets of a list are processed one by one. Since: 1.16.
  *
  * Base class for RTP depayloaders.
  */
@@ -107,8 +118,12 @@ struct _GstRTPBaseDepayloadClass
 
   GstBuffer * (*process_rtp_packet) (GstRTPBaseDepayload *base, GstRTPBuffer * rtp_buffer);
 
+  GstBufferList * (*process_rtp_packet_list) (GstRTPBaseDepayload *base,
+                                              GstRTPBuffer *rtp_buffers,
+                                              guint n_rtp_buffers);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING - 1];
+  gpointer _gst_reserved[GST_PADDING - 2];
 };
 
 GST_RTP_API
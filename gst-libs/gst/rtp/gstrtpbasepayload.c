@@ -63,8 +63,87 @@ struct _GstRTPBasePayloadPrivate
 
   GstCaps *subclass_srccaps;
   GstCaps *sinkcaps;
+
+  GstBufferPool *header_pool;
 };
 
+#define RTP_HEADER_LEN 12
+/* largest RTP header without extension: 15 CSRCs */
+#define RTP_HEADER_MAX_LEN (RTP_HEADER_LEN + 15 * sizeof (guint32))
+
+/* Pool for the output buffers of header-only allocations. The buffers have
+ * one memory for the RTP header. The payload memories the payloader appends
+ * are removed again when the buffer returns to the pool. */
+typedef GstBufferPool GstRTPHeaderBufferPool;
+typedef GstBufferPoolClass GstRTPHeaderBufferPoolClass;
+
+static GType gst_rtp_header_buffer_pool_get_type (void);
+
+G_DEFINE_TYPE (GstRTPHeaderBufferPool, gst_rtp_header_buffer_pool,
+    GST_TYPE_BUFFER_POOL);
+
+/* marks the header memories allocated by a pool, the qdata is the pool */
+static GQuark header_memory_quark;
+
+static GstFlowReturn
+gst_rtp_header_buffer_pool_alloc_buffer (GstBufferPool * pool,
+    GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn ret;
+
+  ret = GST_BUFFER_POOL_CLASS (gst_rtp_header_buffer_pool_parent_class)->
+      alloc_buffer (pool, buffer, params);
+  if (ret == GST_FLOW_OK)
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (gst_buffer_peek_memory
+            (*buffer, 0)), header_memory_quark, pool, NULL);
+
+  return ret;
+}
+
+static void
+gst_rtp_header_buffer_pool_reset_buffer (GstBufferPool * pool,
+    GstBuffer * buffer)
+{
+  GstMemory *mem;
+  gsize offset, maxsize;
+
+  /* drop the payload memories that were appended to the header */
+  if (gst_buffer_n_memory (buffer) > 1)
+    gst_buffer_remove_memory_range (buffer, 1, -1);
+
+  /* the remaining memory can only be reused when it is still the header
+   * memory this pool allocated, not shared and large enough. Otherwise
+   * the memory flag stays set and the pool discards the buffer */
+  if (gst_buffer_n_memory (buffer) == 1) {
+    mem = gst_buffer_peek_memory (buffer, 0);
+    gst_buffer_get_sizes (buffer, &offset, &maxsize);
+    if (gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (mem),
+            header_memory_quark) == pool && gst_memory_is_writable (mem)
+        && maxsize >= RTP_HEADER_MAX_LEN) {
+      gst_buffer_resize (buffer, -offset, RTP_HEADER_MAX_LEN);
+      GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+    }
+  }
+
+  GST_BUFFER_POOL_CLASS (gst_rtp_header_buffer_pool_parent_class)->reset_buffer
+      (pool, buffer);
+}
+
+static void
+gst_rtp_header_buffer_pool_class_init (GstRTPHeaderBufferPoolClass * klass)
+{
+  klass->alloc_buffer = gst_rtp_header_buffer_pool_alloc_buffer;
+  klass->reset_buffer = gst_rtp_header_buffer_pool_reset_buffer;
+
+  header_memory_quark =
+      g_quark_from_static_string ("GstRTPHeaderBufferPool.memory");
+}
+
+static void
+gst_rtp_header_buffer_pool_init (GstRTPHeaderBufferPool * pool)
+{
+}
+
 /* RTPBasePayload signals and args */
 enum
 {
@@ -403,6 +482,12 @@ gst_rtp_base_payload_finalize (GObject * object)
   gst_caps_replace (&rtpbasepayload->priv->subclass_srccaps, NULL);
   gst_caps_replace (&rtpbasepayload->priv->sinkcaps, NULL);
 
+  if (rtpbasepayload->priv->header_pool) {
+    gst_buffer_pool_set_active (rtpbasepayload->priv->header_pool, FALSE);
+    gst_object_unref (rtpbasepayload->priv->header_pool);
+    rtpbasepayload->priv->header_pool = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -1406,6 +1491,51 @@ gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
   return res;
 }
 
+/* get a buffer with an RTP header with @csrc_count CSRCs from the header
+ * pool */
+static GstBuffer *
+gst_rtp_base_payload_acquire_header (GstRTPBasePayload * payload,
+    guint8 csrc_count)
+{
+  GstRTPBasePayloadPrivate *priv = payload->priv;
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+  gsize hlen;
+
+  if (G_UNLIKELY (priv->header_pool == NULL)) {
+    GstBufferPool *pool;
+    GstStructure *config;
+
+    pool = g_object_new (gst_rtp_header_buffer_pool_get_type (), NULL);
+    gst_object_ref_sink (pool);
+
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, NULL, RTP_HEADER_MAX_LEN, 0, 0);
+    if (!gst_buffer_pool_set_config (pool, config) ||
+        !gst_buffer_pool_set_active (pool, TRUE)) {
+      GST_WARNING_OBJECT (payload, "failed to activate header pool");
+      gst_object_unref (pool);
+      return NULL;
+    }
+    priv->header_pool = pool;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (priv->header_pool, &buffer,
+          NULL) != GST_FLOW_OK)
+    return NULL;
+
+  hlen = RTP_HEADER_LEN + csrc_count * sizeof (guint32);
+  gst_buffer_resize (buffer, 0, hlen);
+
+  /* fill in defaults, like gst_rtp_buffer_allocate_data() */
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0, hlen);
+  map.data[0] = (GST_RTP_VERSION << 6) | csrc_count;
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
 /**
  * gst_rtp_base_payload_allocate_output_buffer:
  * @payload: a #GstRTPBasePayload
@@ -1418,6 +1548,11 @@ gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
  * @pad_len. If @payload has #GstRTPBasePayload:source-info %TRUE additional
  * CSRCs may be allocated and filled with RTP source information.
  *
+ * When @payload_len and @pad_len are 0, the buffer only contains the RTP
+ * header and is taken from a pool. The payload is then expected to be
+ * appended as memory, for example with gst_buffer_append(). The appended
+ * memory is released when the buffer returns to the pool.
+ *
  * Returns: A newly allocated buffer that can hold an RTP packet with given
  * parameters.
  *
@@ -1428,38 +1563,138 @@ gst_rtp_base_payload_allocate_output_buffer (GstRTPBasePayload * payload,
     guint payload_len, guint8 pad_len, guint8 csrc_count)
 {
   GstBuffer *buffer = NULL;
+  GstRTPSourceMeta *meta = NULL;
+  guint total_csrc_count = csrc_count;
 
   if (payload->priv->input_meta_buffer != NULL) {
-    GstRTPSourceMeta *meta =
-        gst_buffer_get_rtp_source_meta (payload->priv->input_meta_buffer);
+    meta = gst_buffer_get_rtp_source_meta (payload->priv->input_meta_buffer);
     if (meta != NULL) {
-      guint total_csrc_count, idx, i;
-      GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-
       total_csrc_count = csrc_count + meta->csrc_count +
           (meta->ssrc_valid ? 1 : 0);
       total_csrc_count = MIN (total_csrc_count, 15);
-      buffer = gst_rtp_buffer_new_allocate (payload_len, pad_len,
-          total_csrc_count);
+    }
+  }
+
+  if (payload_len == 0 && pad_len == 0 && total_csrc_count <= 15)
+    buffer = gst_rtp_base_payload_acquire_header (payload, total_csrc_count);
+
+  if (buffer == NULL)
+    buffer = gst_rtp_buffer_new_allocate (payload_len, pad_len,
+        total_csrc_count);
+
+  if (meta != NULL) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    guint idx, i;
+
+    gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtp);
 
-      gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtp);
+    /* Skip CSRC fields requested by derived class and fill CSRCs from meta.
+     * Finally append the SSRC as a new CSRC. */
+    idx = csrc_count;
+    for (i = 0; i < meta->csrc_count && idx < 15; i++, idx++)
+      gst_rtp_buffer_set_csrc (&rtp, idx, meta->csrc[i]);
+    if (meta->ssrc_valid && idx < 15)
+      gst_rtp_buffer_set_csrc (&rtp, idx, meta->ssrc);
+
+    gst_rtp_buffer_unmap (&rtp);
+  }
 
-      /* Skip CSRC fields requested by derived class and fill CSRCs from meta.
-       * Finally append the SSRC as a new CSRC. */
-      idx = csrc_count;
-      for (i = 0; i < meta->csrc_count && idx < 15; i++, idx++)
-        gst_rtp_buffer_set_csrc (&rtp, idx, meta->csrc[i]);
-      if (meta->ssrc_valid && idx < 15)
-        gst_rtp_buffer_set_csrc (&rtp, idx, meta->ssrc);
+  return buffer;
+}
 
+/**
+ * gst_rtp_base_payload_fragment_buffer:
+ * @payload: a #GstRTPBasePayload
+ * @buffer: (transfer none): the data to payload
+ * @max_payload_len: the maximum payload length per packet, or 0
+ * @csrc_count: the minimum number of CSRC entries
+ *
+ * Create RTP packets for the data of @buffer. Each packet gets at most
+ * @max_payload_len bytes, or as much as fits in the MTU when
+ * @max_payload_len is 0. The headers are allocated with
+ * gst_rtp_base_payload_allocate_output_buffer(). The payloads reference the
+ * memory of @buffer, so no data is copied.
+ *
+ * The timestamps of @buffer are set on all packets and the marker bit is set
+ * on the last packet. The result can be pushed with
+ * gst_rtp_base_payload_push_list().
+ *
+ * Returns: (transfer full): a #GstBufferList with the RTP packets.
+ *
+ * Since: 1.16
+ */
+GstBufferList *
+gst_rtp_base_payload_fragment_buffer (GstRTPBasePayload * payload,
+    GstBuffer * buffer, guint max_payload_len, guint8 csrc_count)
+{
+  GstBufferList *list;
+  gsize size, offset = 0;
+
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), NULL);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+
+  if (max_payload_len == 0) {
+    guint n_csrcs;
+
+    n_csrcs = csrc_count + gst_rtp_base_payload_get_source_count (payload,
+        buffer);
+    max_payload_len =
+        gst_rtp_buffer_calc_payload_len (GST_RTP_BASE_PAYLOAD_MTU (payload), 0,
+        MIN (n_csrcs, 15));
+    max_payload_len = MAX (max_payload_len, 1);
+  }
+
+  size = gst_buffer_get_size (buffer);
+  list = gst_buffer_list_new_sized ((size + max_payload_len - 1) /
+      max_payload_len + 1);
+
+  do {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *outbuf;
+    gsize len, left;
+    guint idx, length;
+    gsize skip;
+
+    len = MIN (size - offset, max_payload_len);
+
+    outbuf = gst_rtp_base_payload_allocate_output_buffer (payload, 0, 0,
+        csrc_count);
+    GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (buffer);
+    GST_BUFFER_DTS (outbuf) = GST_BUFFER_DTS (buffer);
+    if (offset == 0 && GST_BUFFER_IS_DISCONT (buffer))
+      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+
+    /* set the marker before adding the payload, the payload memory is shared
+     * and can't be mapped writable */
+    if (offset + len == size) {
+      gst_rtp_buffer_map (outbuf, GST_MAP_WRITE, &rtp);
+      gst_rtp_buffer_set_marker (&rtp, TRUE);
       gst_rtp_buffer_unmap (&rtp);
     }
-  }
 
-  if (buffer == NULL)
-    buffer = gst_rtp_buffer_new_allocate (payload_len, pad_len, csrc_count);
+    /* reference the memory of the input as payload */
+    if (len > 0 && gst_buffer_find_memory (buffer, offset, len, &idx, &length,
+            &skip)) {
+      for (left = len; left > 0; idx++) {
+        GstMemory *mem = gst_buffer_peek_memory (buffer, idx);
+        gsize part = MIN (mem->size - skip, left);
+
+        if (skip == 0 && part == mem->size)
+          mem = gst_memory_ref (mem);
+        else
+          mem = gst_memory_share (mem, skip, part);
+        gst_buffer_append_memory (outbuf, mem);
+
+        left -= part;
+        skip = 0;
+      }
+    }
 
-  return buffer;
+    gst_buffer_list_add (list, outbuf);
+    offset += len;
+  } while (offset < size);
+
+  return list;
 }
 
 static GstStructure *
@@ -1664,6 +1899,12 @@ gst_rtp_base_payload_change_state (GstElement * element,
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_event_replace (&rtpbasepayload->priv->pending_segment, NULL);
+      /* the pool is created again when it is needed */
+      if (priv->header_pool) {
+        gst_buffer_pool_set_active (priv->header_pool, FALSE);
+        gst_object_unref (priv->header_pool);
+        priv->header_pool = NULL;
+      }
       break;
     default:
       break;
@@ -177,6 +177,12 @@ GstBuffer *     gst_rtp_base_payload_allocate_output_buffer (GstRTPBasePayload *
                                                              guint payload_len, guint8 pad_len,
                                                              guint8 csrc_count);
 
+GST_RTP_API
+GstBufferList * gst_rtp_base_payload_fragment_buffer (GstRTPBasePayload * payload,
+                                                      GstBuffer * buffer,
+                                                      guint max_payload_len,
+                                                      guint8 csrc_count);
+
 GST_RTP_API
 void            gst_rtp_base_payload_set_source_info_enabled (GstRTPBasePayload * payload,
                                                               gboolean enable);
@@ -514,6 +514,149 @@ gst_rtp_buffer_unmap (GstRTPBuffer * rtp)
   rtp->buffer = NULL;
 }
 
+/**
+ * gst_rtp_buffer_peek_header:
+ * @buffer: a #GstBuffer
+ * @info: (out caller-allocates) (allow-none): a #GstRTPHeaderInfo
+ *
+ * Validate the RTP header of @buffer and optionally fill in @info with its
+ * fields. Unlike gst_rtp_buffer_map() only the first memory of @buffer is
+ * mapped, which must contain the fixed header and the CSRCs, so this is
+ * useful for elements that only need to classify packets, by SSRC or payload
+ * type for example, without touching the payload.
+ *
+ * The padding is only validated when the last byte of the packet is in the
+ * first memory. Buffers that pass this check can still fail
+ * gst_rtp_buffer_map() when the padding is invalid.
+ *
+ * Returns: %TRUE if @buffer has a valid RTP header.
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_rtp_buffer_peek_header (GstBuffer * buffer, GstRTPHeaderInfo * info)
+{
+  GstMemory *mem;
+  GstMapInfo map;
+  guint8 *data;
+  gsize size, bufsize;
+  guint8 pt, csrc_count;
+  guint header_len, extlen = 0, padding = 0;
+  guint16 extbits = 0;
+  guint i;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+
+  if (G_UNLIKELY (gst_buffer_n_memory (buffer) < 1))
+    goto no_memory;
+
+  mem = gst_buffer_peek_memory (buffer, 0);
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    goto map_failed;
+
+  data = map.data;
+  size = map.size;
+  bufsize = gst_buffer_get_size (buffer);
+
+  /* the header with the CSRCs must be completely in the first memory */
+  header_len = GST_RTP_HEADER_LEN;
+  if (G_UNLIKELY (size < header_len))
+    goto wrong_length;
+
+  /* same checks as gst_rtp_buffer_map() */
+  if (G_UNLIKELY ((data[0] & 0xc0) != (GST_RTP_VERSION << 6)))
+    goto wrong_version;
+
+  pt = data[1];
+  if (G_UNLIKELY (pt >= 200 && pt <= 204))
+    goto reserved_pt;
+
+  csrc_count = (data[0] & 0x0f);
+  header_len += csrc_count * sizeof (guint32);
+  if (G_UNLIKELY (size < header_len))
+    goto wrong_length;
+
+  if (data[0] & 0x10) {
+    guint8 ext[4];
+
+    /* the extension header is usually in the first memory as well */
+    if (G_LIKELY (size >= header_len + 4)) {
+      memcpy (ext, data + header_len, 4);
+    } else if (gst_buffer_extract (buffer, header_len, ext, 4) != 4) {
+      goto wrong_length;
+    }
+    extbits = GST_READ_UINT16_BE (ext);
+    extlen = GST_READ_UINT16_BE (ext + 2) * sizeof (guint32);
+    header_len += extlen + 4;
+  }
+
+  if ((data[0] & 0x20) && bufsize == size)
+    padding = data[size - 1];
+
+  if (G_UNLIKELY (bufsize < header_len + padding))
+    goto wrong_padding;
+
+  if (info) {
+    info->version = data[0] >> 6;
+    info->padding = (data[0] & 0x20) != 0;
+    info->extension = (data[0] & 0x10) != 0;
+    info->csrc_count = csrc_count;
+    info->marker = (pt & 0x80) != 0;
+    info->payload_type = pt & 0x7f;
+    info->seq = GST_READ_UINT16_BE (data + 2);
+    info->timestamp = GST_READ_UINT32_BE (data + 4);
+    info->ssrc = GST_READ_UINT32_BE (data + 8);
+    for (i = 0; i < csrc_count; i++)
+      info->csrc[i] = GST_READ_UINT32_BE (data + GST_RTP_HEADER_LEN + i * 4);
+    info->extension_bits = extbits;
+    info->extension_len = extlen;
+    info->header_len = header_len;
+  }
+
+  gst_memory_unmap (mem, &map);
+
+  return TRUE;
+
+  /* ERRORS */
+no_memory:
+  {
+    GST_ERROR ("buffer without memory");
+    return FALSE;
+  }
+map_failed:
+  {
+    GST_ERROR ("failed to map memory");
+    return FALSE;
+  }
+wrong_length:
+  {
+    GST_DEBUG ("length check failed");
+    goto invalid;
+  }
+wrong_version:
+  {
+    GST_DEBUG ("version check failed (%d != %d)", data[0] >> 6,
+        GST_RTP_VERSION);
+    goto invalid;
+  }
+reserved_pt:
+  {
+    GST_DEBUG ("reserved PT %d found", pt);
+    goto invalid;
+  }
+wrong_padding:
+  {
+    GST_DEBUG ("padding check failed (%" G_GSIZE_FORMAT " - %d < %d)", bufsize,
+        header_len, padding);
+    goto invalid;
+  }
+invalid:
+  {
+    gst_memory_unmap (mem, &map);
+    return FALSE;
+  }
+}
+
 
 /**
  * gst_rtp_buffer_set_packet_len:
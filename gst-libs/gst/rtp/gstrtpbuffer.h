@@ -62,6 +62,48 @@ struct _GstRTPBuffer
 #define GST_RTP_BUFFER_INIT { NULL, 0, { NULL, NULL, NULL, NULL}, { 0, 0, 0, 0 }, \
   { GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT} }
 
+/**
+ * GstRTPHeaderInfo:
+ * @version: the version of the packet
+ * @padding: if the padding bit is set
+ * @extension: if the extension bit is set
+ * @csrc_count: the number of CSRCs in @csrc
+ * @marker: the marker bit
+ * @payload_type: the payload type
+ * @seq: the sequence number
+ * @timestamp: the RTP timestamp
+ * @ssrc: the SSRC
+ * @csrc: the CSRCs of the packet
+ * @extension_bits: the bits of the header extension, only valid when
+ *   @extension is set
+ * @extension_len: the length of the header extension data in bytes, without
+ *   the 4 bytes for the bits and length fields
+ * @header_len: the total length of the RTP header, including CSRCs and the
+ *   header extension
+ *
+ * The fields of an RTP header, as filled in by gst_rtp_buffer_peek_header().
+ *
+ * Since: 1.16
+ */
+typedef struct {
+  guint8       version;
+  gboolean     padding;
+  gboolean     extension;
+  guint8       csrc_count;
+  gboolean     marker;
+  guint8       payload_type;
+  guint16      seq;
+  guint32      timestamp;
+  guint32      ssrc;
+  guint32      csrc[16];
+  guint16      extension_bits;
+  guint        extension_len;
+  guint        header_len;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+} GstRTPHeaderInfo;
+
 /* creating buffers */
 
 GST_RTP_API
@@ -95,6 +137,9 @@ gboolean        gst_rtp_buffer_map                   (GstBuffer *buffer, GstMapF
 GST_RTP_API
 void            gst_rtp_buffer_unmap                 (GstRTPBuffer *rtp);
 
+GST_RTP_API
+gboolean        gst_rtp_buffer_peek_header           (GstBuffer *buffer, GstRTPHeaderInfo *info);
+
 GST_RTP_API
 void            gst_rtp_buffer_set_packet_len        (GstRTPBuffer *rtp, guint len);
 
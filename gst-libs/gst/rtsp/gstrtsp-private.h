@@ -0,0 +1,44 @@
+/* GStreamer
+ * Copyright (C) <2018> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTSP_PRIVATE_H__
+#define __GST_RTSP_PRIVATE_H__
+
+#include <gst/rtsp/gstrtspdefs.h>
+#include <gst/rtsp/gstrtspmessage.h>
+
+G_BEGIN_DECLS
+
+/* gstrtspdefs.c */
+G_GNUC_INTERNAL
+guint           gst_rtsp_header_name_hash          (const gchar *name);
+
+G_GNUC_INTERNAL
+gboolean        gst_rtsp_header_name_equal         (const gchar *name1,
+                                                    const gchar *name2);
+
+/* gstrtspmessage.c */
+G_GNUC_INTERNAL
+GstRTSPResult   gst_rtsp_message_parse_header_line (GstRTSPMessage *msg,
+                                                    gchar *line,
+                                                    gboolean lazy);
+
+G_END_DECLS
+
+#endif /* __GST_RTSP_PRIVATE_H__ */
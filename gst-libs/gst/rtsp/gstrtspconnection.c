@@ -69,6 +69,7 @@
 #include <gio/gnetworking.h>
 
 #include "gstrtspconnection.h"
+#include "gstrtsp-private.h"
 
 #ifdef IP_TOS
 union gst_sockaddr
@@ -105,6 +106,12 @@ typedef enum
 
 #define TUNNELID_LEN   24
 
+/* small reads are done in chunks of this size and buffered */
+#define READ_BUFFER_SIZE 4096
+
+#define READ_BUFFER_AVAILABLE(conn) \
+    ((conn)->read_buffer_size - (conn)->read_buffer_offset)
+
 struct _GstRTSPConnection
 {
   /*< private > */
@@ -144,7 +151,13 @@ struct _GstRTSPConnection
   gchar *initial_buffer;
   gsize initial_buffer_offset;
 
+  /* data read from input_stream but not consumed yet */
+  guint8 *read_buffer;
+  guint read_buffer_offset;
+  guint read_buffer_size;
+
   gboolean remember_session_id; /* remember the session id or not */
+  gboolean lazy_headers;        /* split header values when accessed */
 
   /* Session state */
   gint cseq;                    /* sequence number */
@@ -203,6 +216,20 @@ typedef struct
   glong body_len;
 } GstRTSPBuilder;
 
+/* a message serialized for sending: the start line and headers, or the
+ * header of interleaved data, followed by the body. The body is borrowed
+ * from the message or referenced as a GstBuffer, so it is not copied */
+typedef struct
+{
+  guint8 *data;
+  guint data_size;
+  const guint8 *body_data;
+  GstBuffer *body_buffer;
+  guint body_size;
+  guint size;                   /* data_size + body_size */
+  guint id;
+} GstRTSPSerializedMessage;
+
 /* function prototypes */
 static void add_auth_header (GstRTSPConnection * conn,
     GstRTSPMessage * message);
@@ -1203,6 +1230,187 @@ error:
   }
 }
 
+/* vectored writes go directly to the socket, which is only possible when
+ * there is no TLS or other layer in between */
+static GSocket *
+get_plain_write_socket (GstRTSPConnection * conn)
+{
+  GIOStream *stream = NULL;
+
+  if (conn->stream0 &&
+      g_io_stream_get_output_stream (conn->stream0) == conn->output_stream)
+    stream = conn->stream0;
+  else if (conn->stream1 &&
+      g_io_stream_get_output_stream (conn->stream1) == conn->output_stream)
+    stream = conn->stream1;
+
+  if (stream == NULL || !G_IS_SOCKET_CONNECTION (stream) ||
+      G_IS_TCP_WRAPPER_CONNECTION (stream))
+    return NULL;
+
+  return g_socket_connection_get_socket (G_SOCKET_CONNECTION (stream));
+}
+
+/* maximum number of vectors passed to a single write call */
+#define MAX_WRITE_VECTORS 64
+
+static GstRTSPResult
+writev_bytes (GstRTSPConnection * conn, GOutputVector * vectors,
+    guint n_vectors, gsize * idx, gboolean block, GCancellable * cancellable)
+{
+  GSocket *socket;
+  gssize r;
+  GError *err = NULL;
+
+  socket = get_plain_write_socket (conn);
+
+  while (n_vectors > 0) {
+    if (vectors[0].size == 0) {
+      vectors++;
+      n_vectors--;
+      continue;
+    }
+
+    /* the blocking mode of the socket is shared with other users of the
+     * connection, so it is never changed here. A blocking socket is only
+     * written with a vector write when we are allowed to block, otherwise the
+     * pollable stream is used */
+    if (socket && (block || !g_socket_get_blocking (socket))) {
+      r = g_socket_send_message (socket, NULL, vectors,
+          MIN (n_vectors, MAX_WRITE_VECTORS), NULL, 0, SEND_FLAGS,
+          cancellable, &err);
+      if (r < 0 && block
+          && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+        g_clear_error (&err);
+        if (!g_socket_condition_wait (socket, G_IO_OUT, cancellable, &err))
+          goto error;
+        continue;
+      }
+    } else if (block) {
+      r = g_output_stream_write (conn->output_stream, vectors[0].buffer,
+          vectors[0].size, cancellable, &err);
+    } else {
+      r = g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM
+          (conn->output_stream), vectors[0].buffer, vectors[0].size,
+          cancellable, &err);
+    }
+    if (G_UNLIKELY (r < 0))
+      goto error;
+
+    *idx += r;
+
+    /* skip everything that was written */
+    while (r > 0) {
+      if ((gsize) r >= vectors[0].size) {
+        r -= vectors[0].size;
+        vectors++;
+        n_vectors--;
+      } else {
+        vectors[0].buffer = (const guint8 *) vectors[0].buffer + r;
+        vectors[0].size -= r;
+        r = 0;
+      }
+    }
+  }
+  return GST_RTSP_OK;
+
+  /* ERRORS */
+error:
+  {
+    GST_DEBUG ("%s", err->message);
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_clear_error (&err);
+      return GST_RTSP_EINTR;
+    } else if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+      g_clear_error (&err);
+      return GST_RTSP_EINTR;
+    } else if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_TIMED_OUT)) {
+      g_clear_error (&err);
+      return GST_RTSP_ETIMEOUT;
+    }
+    g_clear_error (&err);
+    return GST_RTSP_ESYS;
+  }
+}
+
+static void
+add_vector (GOutputVector * vectors, guint * n_vectors, gconstpointer data,
+    gsize size, gsize * skip)
+{
+  if (*skip >= size) {
+    *skip -= size;
+    return;
+  }
+
+  vectors[*n_vectors].buffer = (const guint8 *) data + *skip;
+  vectors[*n_vectors].size = size - *skip;
+  (*n_vectors)++;
+  *skip = 0;
+}
+
+/* Write @messages, starting @idx bytes into the first one, with as few write
+ * calls as possible. @idx is updated with the number of bytes written */
+static GstRTSPResult
+write_messages (GstRTSPConnection * conn, GstRTSPSerializedMessage * messages,
+    guint n_messages, gsize * idx, gboolean block, GCancellable * cancellable)
+{
+  GOutputVector *vectors;
+  GstMapInfo *maps;
+  guint n_vectors = 0, n_maps = 0, max_vectors = 0;
+  gsize skip = *idx;
+  GstRTSPResult res;
+  guint i, j;
+
+  for (i = 0; i < n_messages; i++) {
+    max_vectors += 2;
+    if (messages[i].body_buffer)
+      max_vectors += gst_buffer_n_memory (messages[i].body_buffer);
+  }
+
+  vectors = g_new (GOutputVector, max_vectors);
+  maps = g_new (GstMapInfo, max_vectors);
+
+  for (i = 0; i < n_messages; i++) {
+    GstRTSPSerializedMessage *msg = &messages[i];
+
+    add_vector (vectors, &n_vectors, msg->data, msg->data_size, &skip);
+
+    if (msg->body_data) {
+      add_vector (vectors, &n_vectors, msg->body_data, msg->body_size, &skip);
+    } else if (msg->body_buffer) {
+      guint n_mem = gst_buffer_n_memory (msg->body_buffer);
+
+      for (j = 0; j < n_mem; j++) {
+        GstMemory *mem = gst_buffer_peek_memory (msg->body_buffer, j);
+
+        if (skip >= mem->size) {
+          skip -= mem->size;
+          continue;
+        }
+
+        if (!gst_memory_map (mem, &maps[n_maps], GST_MAP_READ)) {
+          GST_ERROR ("failed to map memory %p", mem);
+          res = GST_RTSP_ERROR;
+          goto done;
+        }
+        add_vector (vectors, &n_vectors, maps[n_maps].data, maps[n_maps].size,
+            &skip);
+        n_maps++;
+      }
+    }
+  }
+
+  res = writev_bytes (conn, vectors, n_vectors, idx, block, cancellable);
+
+done:
+  for (i = 0; i < n_maps; i++)
+    gst_memory_unmap (maps[i].memory, &maps[i]);
+  g_free (maps);
+  g_free (vectors);
+
+  return res;
+}
+
 static gint
 fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
     gboolean block, GError ** err)
@@ -1223,15 +1431,40 @@ fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
       conn->initial_buffer_offset += out;
   }
 
+  /* then anything left over from the previous read */
+  if (size > (guint) out && READ_BUFFER_AVAILABLE (conn) > 0) {
+    guint n = MIN (size - out, READ_BUFFER_AVAILABLE (conn));
+
+    memcpy (&buffer[out], &conn->read_buffer[conn->read_buffer_offset], n);
+    conn->read_buffer_offset += n;
+    out += n;
+  }
+
   if (G_LIKELY (size > (guint) out)) {
     gssize r;
     gsize count = size - out;
+    guint8 *dest;
+    gboolean buffered;
+
+    /* the parser asks for very few bytes at a time when reading the message
+     * headers, read as much as is available instead and keep the rest for
+     * the next call. Large reads go directly into the caller's memory */
+    buffered = count < READ_BUFFER_SIZE;
+    if (buffered) {
+      if (conn->read_buffer == NULL)
+        conn->read_buffer = g_malloc (READ_BUFFER_SIZE);
+      dest = conn->read_buffer;
+      count = READ_BUFFER_SIZE;
+    } else {
+      dest = &buffer[out];
+    }
+
     if (block)
-      r = g_input_stream_read (conn->input_stream, (gchar *) & buffer[out],
+      r = g_input_stream_read (conn->input_stream, (gchar *) dest,
           count, conn->may_cancel ? conn->cancellable : NULL, err);
     else
       r = g_pollable_input_stream_read_nonblocking (G_POLLABLE_INPUT_STREAM
-          (conn->input_stream), (gchar *) & buffer[out], count,
+          (conn->input_stream), (gchar *) dest, count,
           conn->may_cancel ? conn->cancellable : NULL, err);
 
     if (G_UNLIKELY (r < 0)) {
@@ -1242,6 +1475,13 @@ fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
         /* we have some data ignore error */
         g_clear_error (err);
       }
+    } else if (buffered) {
+      guint n = MIN ((gsize) r, size - out);
+
+      memcpy (&buffer[out], conn->read_buffer, n);
+      conn->read_buffer_offset = n;
+      conn->read_buffer_size = r;
+      out += n;
     } else
       out += r;
   }
@@ -1368,6 +1608,30 @@ read_line (GstRTSPConnection * conn, guint8 * buffer, guint * idx, guint size,
       /* the last call to read_line() left us with a character to start with */
       c = (guint8) conn->read_ahead;
       conn->read_ahead = 0;
+    } else if (conn->ctxp == NULL && conn->initial_buffer == NULL &&
+        READ_BUFFER_AVAILABLE (conn) > 0) {
+      guint8 *start = &conn->read_buffer[conn->read_buffer_offset];
+      guint8 *end = &conn->read_buffer[conn->read_buffer_size];
+      guint8 *p;
+
+      /* copy everything up to the next line ending straight from the read
+       * buffer */
+      for (p = start; p < end && *p != '\r' && *p != '\n'; p++);
+
+      if (G_LIKELY (*idx < size - 1)) {
+        guint n = MIN (p - start, size - 1 - *idx);
+
+        memcpy (&buffer[*idx], start, n);
+        *idx += n;
+      }
+      conn->read_buffer_offset += p - start;
+
+      /* no line ending yet, need more data */
+      if (p == end)
+        continue;
+
+      c = *p;
+      conn->read_buffer_offset++;
     } else {
       /* read the next character */
       i = 0;
@@ -1488,11 +1752,14 @@ gst_rtsp_connection_write (GstRTSPConnection * conn, const guint8 * data,
   return res;
 }
 
-static GString *
-message_to_string (GstRTSPConnection * conn, GstRTSPMessage * message)
+static gboolean
+serialize_message (GstRTSPConnection * conn, GstRTSPMessage * message,
+    GstRTSPSerializedMessage * serialized_message)
 {
   GString *str = NULL;
 
+  memset (serialized_message, 0, sizeof (*serialized_message));
+
   str = g_string_new ("");
 
   switch (message->type) {
@@ -1544,16 +1811,13 @@ message_to_string (GstRTSPConnection * conn, GstRTSPMessage * message)
       data_header[2] = (message->body_size >> 8) & 0xff;
       data_header[3] = message->body_size & 0xff;
 
-      /* create string with header and data */
+      /* create string with the header, the data is the body */
       str = g_string_append_len (str, (gchar *) data_header, 4);
-      str =
-          g_string_append_len (str, (gchar *) message->body,
-          message->body_size);
       break;
     }
     default:
       g_string_free (str, TRUE);
-      g_return_val_if_reached (NULL);
+      g_return_val_if_reached (FALSE);
       break;
   }
 
@@ -1570,26 +1834,68 @@ message_to_string (GstRTSPConnection * conn, GstRTSPMessage * message)
     /* append headers */
     gst_rtsp_message_append_headers (message, str);
 
-    /* append Content-Length and body if needed */
-    if (message->body != NULL && message->body_size > 0) {
+    /* append Content-Length if needed */
+    if ((message->body != NULL || message->body_buffer != NULL) &&
+        message->body_size > 0) {
       gchar *len;
 
       len = g_strdup_printf ("%d", message->body_size);
       g_string_append_printf (str, "%s: %s\r\n",
           gst_rtsp_header_as_text (GST_RTSP_HDR_CONTENT_LENGTH), len);
       g_free (len);
-      /* header ends here */
-      g_string_append (str, "\r\n");
-      str =
-          g_string_append_len (str, (gchar *) message->body,
-          message->body_size);
-    } else {
-      /* just end headers */
-      g_string_append (str, "\r\n");
     }
+    /* header ends here */
+    g_string_append (str, "\r\n");
+  }
+
+  serialized_message->data_size = str->len;
+  serialized_message->data = (guint8 *) g_string_free (str, FALSE);
+
+  /* and the body follows */
+  if (message->body_buffer) {
+    serialized_message->body_buffer = gst_buffer_ref (message->body_buffer);
+    serialized_message->body_size = message->body_size;
+  } else if (message->body != NULL) {
+    serialized_message->body_data = message->body;
+    serialized_message->body_size = message->body_size;
   }
+  serialized_message->size =
+      serialized_message->data_size + serialized_message->body_size;
+
+  return TRUE;
+}
+
+/* Append a borrowed body to the data so that the serialized message stays
+ * valid after the message is freed. If @flatten is set, a body buffer is
+ * copied into the data too */
+static void
+serialized_message_own_body (GstRTSPSerializedMessage * serialized_message,
+    gboolean flatten)
+{
+  GstRTSPSerializedMessage *msg = serialized_message;
 
-  return str;
+  if (msg->body_data == NULL && (msg->body_buffer == NULL || !flatten))
+    return;
+
+  msg->data = g_realloc (msg->data, msg->data_size + msg->body_size);
+  if (msg->body_data)
+    memcpy (msg->data + msg->data_size, msg->body_data, msg->body_size);
+  else
+    gst_buffer_extract (msg->body_buffer, 0, msg->data + msg->data_size,
+        msg->body_size);
+  msg->data_size += msg->body_size;
+
+  msg->body_data = NULL;
+  gst_buffer_replace (&msg->body_buffer, NULL);
+  msg->body_size = 0;
+}
+
+static void
+serialized_message_clear (GstRTSPSerializedMessage * serialized_message)
+{
+  g_free (serialized_message->data);
+  serialized_message->data = NULL;
+  gst_buffer_replace (&serialized_message->body_buffer, NULL);
 }
 
 /**
@@ -1610,31 +1916,41 @@ GstRTSPResult
 gst_rtsp_connection_send (GstRTSPConnection * conn, GstRTSPMessage * message,
     GTimeVal * timeout)
 {
-  GString *string = NULL;
+  GstRTSPSerializedMessage serialized_message;
   GstRTSPResult res;
-  gchar *str;
-  gsize len;
 
   g_return_val_if_fail (conn != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (message != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (conn->output_stream != NULL, GST_RTSP_EINVAL);
 
-  if (G_UNLIKELY (!(string = message_to_string (conn, message))))
+  if (G_UNLIKELY (!serialize_message (conn, message, &serialized_message)))
     goto no_message;
 
   if (conn->tunneled) {
-    str = g_base64_encode ((const guchar *) string->str, string->len);
-    g_string_free (string, TRUE);
-    len = strlen (str);
+    gchar *str;
+
+    /* everything is base64 encoded */
+    serialized_message_own_body (&serialized_message, TRUE);
+    str = g_base64_encode (serialized_message.data,
+        serialized_message.data_size);
+    res = gst_rtsp_connection_write (conn, (guint8 *) str, strlen (str),
+        timeout);
+    g_free (str);
   } else {
-    str = string->str;
-    len = string->len;
-    g_string_free (string, FALSE);
-  }
+    GstClockTime to;
+    gsize offset = 0;
+
+    to = timeout ? GST_TIMEVAL_TO_TIME (*timeout) : 0;
 
-  /* write request */
-  res = gst_rtsp_connection_write (conn, (guint8 *) str, len, timeout);
+    /* write the headers and the body without copying them together */
+    g_socket_set_timeout (conn->write_socket,
+        (to + GST_SECOND - 1) / GST_SECOND);
+    res = write_messages (conn, &serialized_message, 1, &offset, TRUE,
+        conn->cancellable);
+    g_socket_set_timeout (conn->write_socket, 0);
+  }
 
-  g_free (str);
+  serialized_message_clear (&serialized_message);
 
   return res;
 
@@ -1645,6 +1961,80 @@ no_message:
   }
 }
 
+/**
+ * gst_rtsp_connection_send_messages:
+ * @conn: a #GstRTSPConnection
+ * @messages: (array length=n_messages): the messages to send
+ * @n_messages: the number of messages to send
+ * @timeout: a timeout value or %NULL
+ *
+ * Attempt to send @messages to the connected @conn, blocking up to
+ * the specified @timeout. @timeout can be %NULL, in which case this function
+ * might block forever.
+ *
+ * Unlike calling gst_rtsp_connection_send() for each message, the messages
+ * are written with as few write calls as possible.
+ *
+ * This function can be cancelled with gst_rtsp_connection_flush().
+ *
+ * Returns: #GST_RTSP_OK on success.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_connection_send_messages (GstRTSPConnection * conn,
+    GstRTSPMessage * messages, guint n_messages, GTimeVal * timeout)
+{
+  GstRTSPSerializedMessage *serialized_messages;
+  GstClockTime to;
+  gsize offset = 0;
+  GstRTSPResult res;
+  guint i;
+
+  g_return_val_if_fail (conn != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (messages != NULL || n_messages == 0, GST_RTSP_EINVAL);
+  g_return_val_if_fail (conn->output_stream != NULL, GST_RTSP_EINVAL);
+
+  /* tunneled messages are base64 encoded one by one */
+  if (conn->tunneled) {
+    for (i = 0; i < n_messages; i++) {
+      res = gst_rtsp_connection_send (conn, &messages[i], timeout);
+      if (res != GST_RTSP_OK)
+        return res;
+    }
+    return GST_RTSP_OK;
+  }
+
+  serialized_messages = g_new0 (GstRTSPSerializedMessage, n_messages);
+  for (i = 0; i < n_messages; i++) {
+    if (G_UNLIKELY (!serialize_message (conn, &messages[i],
+                &serialized_messages[i])))
+      goto no_message;
+  }
+
+  to = timeout ? GST_TIMEVAL_TO_TIME (*timeout) : 0;
+
+  g_socket_set_timeout (conn->write_socket,
+      (to + GST_SECOND - 1) / GST_SECOND);
+  res = write_messages (conn, serialized_messages, n_messages, &offset, TRUE,
+      conn->cancellable);
+  g_socket_set_timeout (conn->write_socket, 0);
+
+done:
+  for (i = 0; i < n_messages; i++)
+    serialized_message_clear (&serialized_messages[i]);
+  g_free (serialized_messages);
+
+  return res;
+
+no_message:
+  {
+    g_warning ("Wrong message");
+    res = GST_RTSP_EINVAL;
+    goto done;
+  }
+}
+
 static GstRTSPResult
 parse_string (gchar * dest, gint size, gchar ** src)
 {
@@ -1809,136 +2199,6 @@ parse_request_line (guint8 * buffer, GstRTSPMessage * msg)
   return res;
 }
 
-/* parsing lines means reading a Key: Value pair */
-static GstRTSPResult
-parse_line (guint8 * buffer, GstRTSPMessage * msg)
-{
-  GstRTSPHeaderField field;
-  gchar *line = (gchar *) buffer;
-  gchar *field_name = NULL;
-  gchar *value;
-
-  if ((value = strchr (line, ':')) == NULL || value == line)
-    goto parse_error;
-
-  /* trim space before the colon */
-  if (value[-1] == ' ')
-    value[-1] = '\0';
-
-  /* replace the colon with a NUL */
-  *value++ = '\0';
-
-  /* find the header */
-  field = gst_rtsp_find_header_field (line);
-  /* custom header not present in the list of pre-defined headers */
-  if (field == GST_RTSP_HDR_INVALID)
-    field_name = line;
-
-  /* split up the value in multiple key:value pairs if it contains comma(s) */
-  while (*value != '\0') {
-    gchar *next_value;
-    gchar *comma = NULL;
-    gboolean quoted = FALSE;
-    guint comment = 0;
-
-    /* trim leading space */
-    if (*value == ' ')
-      value++;
-
-    /* for headers which may not appear multiple times, and thus may not
-     * contain multiple values on the same line, we can short-circuit the loop
-     * below and the entire value results in just one key:value pair*/
-    if (!gst_rtsp_header_allow_multiple (field))
-      next_value = value + strlen (value);
-    else
-      next_value = value;
-
-    /* find the next value, taking special care of quotes and comments */
-    while (*next_value != '\0') {
-      if ((quoted || comment != 0) && *next_value == '\\' &&
-          next_value[1] != '\0')
-        next_value++;
-      else if (comment == 0 && *next_value == '"')
-        quoted = !quoted;
-      else if (!quoted && *next_value == '(')
-        comment++;
-      else if (comment != 0 && *next_value == ')')
-        comment--;
-      else if (!quoted && comment == 0) {
-        /* To quote RFC 2068: "User agents MUST take special care in parsing
-         * the WWW-Authenticate field value if it contains more than one
-         * challenge, or if more than one WWW-Authenticate header field is
-         * provided, since the contents of a challenge may itself contain a
-         * comma-separated list of authentication parameters."
-         *
-         * What this means is that we cannot just look for an unquoted comma
-         * when looking for multiple values in Proxy-Authenticate and
-         * WWW-Authenticate headers. Instead we need to look for the sequence
-         * "comma [space] token space token" before we can split after the
-         * comma...
-         */
-        if (field == GST_RTSP_HDR_PROXY_AUTHENTICATE ||
-            field == GST_RTSP_HDR_WWW_AUTHENTICATE) {
-          if (*next_value == ',') {
-            if (next_value[1] == ' ') {
-              /* skip any space following the comma so we do not mistake it for
-               * separating between two tokens */
-              next_value++;
-            }
-            comma = next_value;
-          } else if (*next_value == ' ' && next_value[1] != ',' &&
-              next_value[1] != '=' && comma != NULL) {
-            next_value = comma;
-            comma = NULL;
-            break;
-          }
-        } else if (*next_value == ',')
-          break;
-      }
-
-      next_value++;
-    }
-
-    if (msg->type == GST_RTSP_MESSAGE_REQUEST && field == GST_RTSP_HDR_SESSION) {
-      /* The timeout parameter is only allowed in a session response header
-       * but some clients send it as part of the session request header.
-       * Ignore everything from the semicolon to the end of the line. */
-      next_value = value;
-      while (*next_value != '\0') {
-        if (*next_value == ';') {
-          break;
-        }
-        next_value++;
-      }
-    }
-
-    /* trim space */
-    if (value != next_value && next_value[-1] == ' ')
-      next_value[-1] = '\0';
-
-    if (*next_value != '\0')
-      *next_value++ = '\0';
-
-    /* add the key:value pair */
-    if (*value != '\0') {
-      if (field != GST_RTSP_HDR_INVALID)
-        gst_rtsp_message_add_header (msg, field, value);
-      else
-        gst_rtsp_message_add_header_by_name (msg, field_name, value);
-    }
-
-    value = next_value;
-  }
-
-  return GST_RTSP_OK;
-
-  /* ERRORS */
-parse_error:
-  {
-    return GST_RTSP_EPARSE;
-  }
-}
-
 /* convert all consecutive whitespace to a single space */
 static void
 normalize_line (guint8 * buffer)
@@ -2086,7 +2346,8 @@ build_next (GstRTSPBuilder * builder, GstRTSPMessage * message,
           }
         } else {
           /* else just parse the line */
-          res = parse_line (builder->buffer, message);
+          res = gst_rtsp_message_parse_header_line (message,
+              (gchar *) builder->buffer, conn->lazy_headers);
           if (res != GST_RTSP_OK)
             builder->status = res;
         }
@@ -2380,6 +2641,11 @@ gst_rtsp_connection_close (GstRTSPConnection * conn)
   conn->initial_buffer = NULL;
   conn->initial_buffer_offset = 0;
 
+  g_free (conn->read_buffer);
+  conn->read_buffer = NULL;
+  conn->read_buffer_offset = 0;
+  conn->read_buffer_size = 0;
+
   conn->write_socket = NULL;
   conn->read_socket = NULL;
   conn->tunneled = FALSE;
@@ -2466,6 +2732,17 @@ gst_rtsp_connection_poll (GstRTSPConnection * conn, GstRTSPEvent events,
   g_return_val_if_fail (conn->read_socket != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (conn->write_socket != NULL, GST_RTSP_EINVAL);
 
+  /* data we already read from the socket is available immediately */
+  if ((events & GST_RTSP_EV_READ) && READ_BUFFER_AVAILABLE (conn) > 0) {
+    *revents = GST_RTSP_EV_READ;
+    if (events & GST_RTSP_EV_WRITE) {
+      condition = g_socket_condition_check (conn->write_socket, G_IO_OUT);
+      if ((condition & G_IO_OUT))
+        *revents |= GST_RTSP_EV_WRITE;
+    }
+    return GST_RTSP_OK;
+  }
+
   ctx = g_main_context_new ();
 
   /* configure timeout if any */
@@ -3049,6 +3326,15 @@ gst_rtsp_connection_do_tunnel (GstRTSPConnection * conn,
       conn->input_stream = conn2->input_stream;
       conn->control_stream = g_io_stream_get_input_stream (conn->stream0);
       conn2->output_stream = NULL;
+
+      /* and whatever was already read from it */
+      g_free (conn->read_buffer);
+      conn->read_buffer = conn2->read_buffer;
+      conn->read_buffer_offset = conn2->read_buffer_offset;
+      conn->read_buffer_size = conn2->read_buffer_size;
+      conn2->read_buffer = NULL;
+      conn2->read_buffer_offset = 0;
+      conn2->read_buffer_size = 0;
     } else {
       /* conn2 is the HTTP GET channel. take its socket and set it as write
        * socket in conn */
@@ -3128,18 +3414,52 @@ gst_rtsp_connection_get_remember_session_id (GstRTSPConnection * conn)
   return conn->remember_session_id;
 }
 
+/**
+ * gst_rtsp_connection_set_lazy_headers:
+ * @conn: a #GstRTSPConnection
+ * @lazy: %TRUE to parse header values lazily
+ *
+ * Sets if received header lines with multiple values should be split into
+ * separate headers only when they are accessed. This saves work for messages
+ * that are mostly forwarded or of which only a few headers are looked at.
+ * The headers can be accessed as usual, also from several threads at once.
+ *
+ * The default value is %FALSE
+ *
+ * Since: 1.16
+ */
+void
+gst_rtsp_connection_set_lazy_headers (GstRTSPConnection * conn, gboolean lazy)
+{
+  g_return_if_fail (conn != NULL);
+
+  conn->lazy_headers = lazy;
+}
+
+/**
+ * gst_rtsp_connection_get_lazy_headers:
+ * @conn: a #GstRTSPConnection
+ *
+ * Returns: %TRUE if the #GstRTSPConnection parses header values lazily.
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_rtsp_connection_get_lazy_headers (GstRTSPConnection * conn)
+{
+  g_return_val_if_fail (conn != NULL, FALSE);
+
+  return conn->lazy_headers;
+}
+
 
 #define READ_ERR    (G_IO_HUP | G_IO_ERR | G_IO_NVAL)
 #define READ_COND   (G_IO_IN | READ_ERR)
 #define WRITE_ERR   (G_IO_HUP | G_IO_ERR | G_IO_NVAL)
 #define WRITE_COND  (G_IO_OUT | WRITE_ERR)
 
-typedef struct
-{
-  guint8 *data;
-  guint size;
-  guint id;
-} GstRTSPRec;
+/* maximum number of queued messages that are written at once */
+#define MAX_WRITE_MESSAGES 16
 
 /* async functions */
 struct _GstRTSPWatch
@@ -3162,15 +3482,24 @@ struct _GstRTSPWatch
   GMutex mutex;
   GstQueueArray *messages;
   gsize messages_bytes;
-  guint8 *write_data;
-  guint write_off;
-  guint write_size;
-  guint write_id;
+  /* messages taken from the queue that are being written */
+  GstRTSPSerializedMessage write_messages[MAX_WRITE_MESSAGES];
+  guint n_write_messages;
+  gsize write_off;
   gsize max_bytes;
   guint max_messages;
   GCond queue_not_full;
   gboolean flushing;
 
+  /* backlog watermarks */
+  gsize high_watermark;
+  gsize low_watermark;
+  gboolean above_high_watermark;
+
+  /* statistics */
+  guint64 bytes_sent;
+  guint64 messages_sent;
+
   GstRTSPWatchFuncs funcs;
 
   gpointer user_data;
@@ -3180,6 +3509,29 @@ struct _GstRTSPWatch
 #define IS_BACKLOG_FULL(w) (((w)->max_bytes != 0 && (w)->messages_bytes >= (w)->max_bytes) || \
       ((w)->max_messages != 0 && gst_queue_array_get_length((w)->messages) >= (w)->max_messages))
 
+typedef GstRTSPResult (*GstRTSPWatchBacklogFunc) (GstRTSPWatch * watch,
+    gpointer user_data);
+
+/* called with the watch lock. Returns the callback to call, if any, once
+ * the lock is released */
+static GstRTSPWatchBacklogFunc
+check_watermarks (GstRTSPWatch * watch)
+{
+  if (watch->high_watermark == 0)
+    return NULL;
+
+  if (!watch->above_high_watermark &&
+      watch->messages_bytes >= watch->high_watermark) {
+    watch->above_high_watermark = TRUE;
+    return watch->funcs.backlog_high;
+  } else if (watch->above_high_watermark &&
+      watch->messages_bytes <= watch->low_watermark) {
+    watch->above_high_watermark = FALSE;
+    return watch->funcs.backlog_low;
+  }
+  return NULL;
+}
+
 static gboolean
 gst_rtsp_source_prepare (GSource * source, gint * timeout)
 {
@@ -3188,6 +3540,9 @@ gst_rtsp_source_prepare (GSource * source, gint * timeout)
   if (watch->conn->initial_buffer != NULL)
     return TRUE;
 
+  if (READ_BUFFER_AVAILABLE (watch->conn) > 0)
+    return TRUE;
+
   *timeout = (watch->conn->timeout * 1000);
 
   return FALSE;
@@ -3283,6 +3638,8 @@ gst_rtsp_source_dispatch_read (GPollableInputStream * stream,
       conn->stream1 = NULL;
       conn->socket1 = NULL;
       conn->input_stream = NULL;
+      conn->read_buffer_offset = 0;
+      conn->read_buffer_size = 0;
     }
     g_mutex_unlock (&watch->mutex);
 
@@ -3409,7 +3766,7 @@ gst_rtsp_source_dispatch (GSource * source, GSourceFunc callback G_GNUC_UNUSED,
   GstRTSPWatch *watch = (GstRTSPWatch *) source;
   GstRTSPConnection *conn = watch->conn;
 
-  if (conn->initial_buffer != NULL) {
+  if (conn->initial_buffer != NULL || READ_BUFFER_AVAILABLE (conn) > 0) {
     gst_rtsp_source_dispatch_read (G_POLLABLE_INPUT_STREAM (conn->input_stream),
         watch);
   }
@@ -3422,6 +3779,7 @@ gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
 {
   GstRTSPResult res = GST_RTSP_ERROR;
   GstRTSPConnection *conn = watch->conn;
+  guint write_id = 0;
 
   /* if this connection was already closed, stop now */
   if (G_POLLABLE_OUTPUT_STREAM (conn->output_stream) != stream)
@@ -3429,66 +3787,93 @@ gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
 
   g_mutex_lock (&watch->mutex);
   do {
-    if (watch->write_data == NULL) {
-      GstRTSPRec *rec_ptr, rec;
-
-      /* get a new message from the queue */
-      rec_ptr = gst_queue_array_pop_head_struct (watch->messages);
-      if (rec_ptr == NULL) {
-        if (watch->writesrc) {
-          if (!g_source_is_destroyed ((GSource *) watch))
-            g_source_remove_child_source ((GSource *) watch, watch->writesrc);
-          g_source_unref (watch->writesrc);
-          watch->writesrc = NULL;
-          /* we create and add the write source again when we actually have
-           * something to write */
-
-          /* since write source is now removed we add read source on the write
-           * socket instead to be able to detect when client closes get channel
-           * in tunneled mode */
-          if (watch->conn->control_stream) {
-            watch->controlsrc =
-                g_pollable_input_stream_create_source (G_POLLABLE_INPUT_STREAM
-                (watch->conn->control_stream), NULL);
-            g_source_set_callback (watch->controlsrc,
-                (GSourceFunc) gst_rtsp_source_dispatch_read_get_channel, watch,
-                NULL);
-            g_source_add_child_source ((GSource *) watch, watch->controlsrc);
-          } else {
-            watch->controlsrc = NULL;
-          }
-        }
+    guint ids[MAX_WRITE_MESSAGES];
+    guint n_ids = 0, n_done = 0, error_id, i;
+    GstRTSPWatchBacklogFunc backlog_func;
+    gsize old_off;
+
+    /* take as many messages from the queue as we can write at once */
+    while (watch->n_write_messages < MAX_WRITE_MESSAGES) {
+      GstRTSPSerializedMessage *msg;
+
+      msg = gst_queue_array_pop_head_struct (watch->messages);
+      if (msg == NULL)
         break;
-      }
 
-      rec = *rec_ptr;
-      watch->messages_bytes -= rec.size;
+      watch->messages_bytes -= msg->size;
+      watch->write_messages[watch->n_write_messages++] = *msg;
+    }
 
-      watch->write_off = 0;
-      watch->write_data = rec.data;
-      watch->write_size = rec.size;
-      watch->write_id = rec.id;
+    if (watch->n_write_messages == 0) {
+      if (watch->writesrc) {
+        if (!g_source_is_destroyed ((GSource *) watch))
+          g_source_remove_child_source ((GSource *) watch, watch->writesrc);
+        g_source_unref (watch->writesrc);
+        watch->writesrc = NULL;
+        /* we create and add the write source again when we actually have
+         * something to write */
+
+        /* since write source is now removed we add read source on the write
+         * socket instead to be able to detect when client closes get channel
+         * in tunneled mode */
+        if (watch->conn->control_stream) {
+          watch->controlsrc =
+              g_pollable_input_stream_create_source (G_POLLABLE_INPUT_STREAM
+              (watch->conn->control_stream), NULL);
+          g_source_set_callback (watch->controlsrc,
+              (GSourceFunc) gst_rtsp_source_dispatch_read_get_channel, watch,
+              NULL);
+          g_source_add_child_source ((GSource *) watch, watch->controlsrc);
+        } else {
+          watch->controlsrc = NULL;
+        }
+      }
+      break;
     }
 
-    res = write_bytes (conn->output_stream, watch->write_data,
-        &watch->write_off, watch->write_size, FALSE, conn->cancellable);
+    old_off = watch->write_off;
+    res = write_messages (conn, watch->write_messages,
+        watch->n_write_messages, &watch->write_off, FALSE, conn->cancellable);
+    watch->bytes_sent += watch->write_off - old_off;
+
+    /* remove the messages that were written completely */
+    while (n_done < watch->n_write_messages &&
+        watch->write_off >= watch->write_messages[n_done].size) {
+      GstRTSPSerializedMessage *msg = &watch->write_messages[n_done];
+
+      watch->write_off -= msg->size;
+      if (msg->id != 0)
+        ids[n_ids++] = msg->id;
+      serialized_message_clear (msg);
+      n_done++;
+    }
+    watch->n_write_messages -= n_done;
+    watch->messages_sent += n_done;
+    memmove (watch->write_messages, &watch->write_messages[n_done],
+        watch->n_write_messages * sizeof (GstRTSPSerializedMessage));
+    error_id = watch->n_write_messages > 0 ? watch->write_messages[0].id : 0;
 
     if (!IS_BACKLOG_FULL (watch))
       g_cond_signal (&watch->queue_not_full);
+    backlog_func = check_watermarks (watch);
     g_mutex_unlock (&watch->mutex);
 
+    if (backlog_func)
+      backlog_func (watch, watch->user_data);
+
+    if (watch->funcs.message_sent) {
+      for (i = 0; i < n_ids; i++)
+        watch->funcs.message_sent (watch, ids[i], watch->user_data);
+    }
+
     if (res == GST_RTSP_EINTR)
       goto write_blocked;
-    else if (G_LIKELY (res == GST_RTSP_OK)) {
-      if (watch->funcs.message_sent)
-        watch->funcs.message_sent (watch, watch->write_id, watch->user_data);
-    } else {
+    else if (G_UNLIKELY (res != GST_RTSP_OK)) {
+      write_id = error_id;
       goto write_error;
     }
-    g_mutex_lock (&watch->mutex);
 
-    g_free (watch->write_data);
-    watch->write_data = NULL;
+    g_mutex_lock (&watch->mutex);
   } while (TRUE);
   g_mutex_unlock (&watch->mutex);
 
@@ -3503,8 +3888,7 @@ eof:
 write_error:
   {
     if (watch->funcs.error_full)
-      watch->funcs.error_full (watch, res, NULL,
-          watch->write_id, watch->user_data);
+      watch->funcs.error_full (watch, res, NULL, write_id, watch->user_data);
     else if (watch->funcs.error)
       watch->funcs.error (watch, res, watch->user_data);
 
@@ -3512,19 +3896,12 @@ write_error:
   }
 }
 
-static void
-gst_rtsp_rec_clear (gpointer data)
-{
-  GstRTSPRec *rec = data;
-
-  g_free (rec->data);
-}
-
 static void
 gst_rtsp_source_finalize (GSource * source)
 {
   GstRTSPWatch *watch = (GstRTSPWatch *) source;
-  GstRTSPRec *rec;
+  GstRTSPSerializedMessage *msg;
+  guint i;
 
   if (watch->notify)
     watch->notify (watch->user_data);
@@ -3532,13 +3909,15 @@ gst_rtsp_source_finalize (GSource * source)
   build_reset (&watch->builder);
   gst_rtsp_message_unset (&watch->message);
 
-  while ((rec = gst_queue_array_pop_head_struct (watch->messages)))
-    gst_rtsp_rec_clear (rec);
+  while ((msg = gst_queue_array_pop_head_struct (watch->messages)))
+    serialized_message_clear (msg);
   gst_queue_array_free (watch->messages);
   watch->messages = NULL;
   watch->messages_bytes = 0;
 
-  g_free (watch->write_data);
+  for (i = 0; i < watch->n_write_messages; i++)
+    serialized_message_clear (&watch->write_messages[i]);
+  watch->n_write_messages = 0;
   g_cond_clear (&watch->queue_not_full);
 
   if (watch->readsrc)
@@ -3596,7 +3975,8 @@ gst_rtsp_watch_new (GstRTSPConnection * conn,
   result->builder.state = STATE_START;
 
   g_mutex_init (&result->mutex);
-  result->messages = gst_queue_array_new_for_struct (sizeof (GstRTSPRec), 10);
+  result->messages =
+      gst_queue_array_new_for_struct (sizeof (GstRTSPSerializedMessage), 10);
   g_cond_init (&result->queue_not_full);
 
   gst_rtsp_watch_reset (result);
@@ -3754,83 +4134,73 @@ gst_rtsp_watch_get_send_backlog (GstRTSPWatch * watch,
   g_mutex_unlock (&watch->mutex);
 }
 
-/**
- * gst_rtsp_watch_write_data:
- * @watch: a #GstRTSPWatch
- * @data: (array length=size) (transfer full): the data to queue
- * @size: the size of @data
- * @id: (out) (allow-none): location for a message ID or %NULL
- *
- * Write @data using the connection of the @watch. If it cannot be sent
- * immediately, it will be queued for transmission in @watch. The contents of
- * @message will then be serialized and transmitted when the connection of the
- * @watch becomes writable. In case the @message is queued, the ID returned in
- * @id will be non-zero and used as the ID argument in the message_sent
- * callback.
- *
- * This function will take ownership of @data and g_free() it after use.
- *
- * If the amount of queued data exceeds the limits set with
- * gst_rtsp_watch_set_send_backlog(), this function will return
- * #GST_RTSP_ENOMEM.
- *
- * Returns: #GST_RTSP_OK on success. #GST_RTSP_ENOMEM when the backlog limits
- * are reached. #GST_RTSP_EINTR when @watch was flushing.
- */
-GstRTSPResult
-gst_rtsp_watch_write_data (GstRTSPWatch * watch, const guint8 * data,
-    guint size, guint * id)
+/* Takes ownership of the contents of @messages. Only the last message gets
+ * an id, which is reported with the message_sent callback */
+static GstRTSPResult
+gst_rtsp_watch_write_serialized_messages (GstRTSPWatch * watch,
+    GstRTSPSerializedMessage * messages, guint n_messages, guint * id)
 {
   GstRTSPResult res;
-  GstRTSPRec rec;
-  guint off = 0;
   GMainContext *context = NULL;
-
-  g_return_val_if_fail (watch != NULL, GST_RTSP_EINVAL);
-  g_return_val_if_fail (data != NULL, GST_RTSP_EINVAL);
-  g_return_val_if_fail (size != 0, GST_RTSP_EINVAL);
+  GstRTSPWatchBacklogFunc backlog_func = NULL;
+  gsize off = 0;
+  guint i = 0, msg_id;
 
   g_mutex_lock (&watch->mutex);
   if (watch->flushing)
     goto flushing;
 
-  /* try to send the message synchronously first */
+  /* try to send the messages synchronously first */
   if (gst_queue_array_get_length (watch->messages) == 0
-      && watch->write_data == NULL) {
-    res =
-        write_bytes (watch->conn->output_stream, data, &off, size, FALSE,
+      && watch->n_write_messages == 0) {
+    res = write_messages (watch->conn, messages, n_messages, &off, FALSE,
         watch->conn->cancellable);
+    watch->bytes_sent += off;
     if (res != GST_RTSP_EINTR) {
+      if (res == GST_RTSP_OK)
+        watch->messages_sent += n_messages;
       if (id != NULL)
         *id = 0;
-      g_free ((gpointer) data);
       goto done;
     }
+
+    /* skip the messages that were sent completely */
+    while (i < n_messages && off >= messages[i].size) {
+      off -= messages[i].size;
+      serialized_message_clear (&messages[i]);
+      watch->messages_sent++;
+      i++;
+    }
   }
 
   /* check limits */
   if (IS_BACKLOG_FULL (watch))
     goto too_much_backlog;
 
-  /* make a record with the data and id for sending async */
-  memset (&rec, 0, sizeof (rec));
-  if (off == 0) {
-    rec.data = (guint8 *) data;
-    rec.size = size;
-  } else {
-    rec.data = g_memdup (data + off, size - off);
-    rec.size = size - off;
-    g_free ((gpointer) data);
-  }
-
   do {
-    /* make sure rec->id is never 0 */
-    rec.id = ++watch->id;
-  } while (G_UNLIKELY (rec.id == 0));
-
-  /* add the record to a queue. */
-  gst_queue_array_push_tail_struct (watch->messages, &rec);
-  watch->messages_bytes += rec.size;
+    /* make sure the id is never 0 */
+    msg_id = ++watch->id;
+  } while (G_UNLIKELY (msg_id == 0));
+
+  for (; i < n_messages; i++) {
+    GstRTSPSerializedMessage *msg = &messages[i];
+
+    /* the body might still belong to the message */
+    serialized_message_own_body (msg, FALSE);
+    msg->id = (i == n_messages - 1) ? msg_id : 0;
+
+    if (off > 0) {
+      /* partially sent already, continue with this one */
+      watch->write_messages[0] = *msg;
+      watch->n_write_messages = 1;
+      watch->write_off = off;
+      off = 0;
+    } else {
+      /* add the message to a queue. */
+      gst_queue_array_push_tail_struct (watch->messages, msg);
+      watch->messages_bytes += msg->size;
+    }
+  }
 
   /* make sure the main context will now also check for writability on the
    * socket */
@@ -3853,24 +4223,31 @@ gst_rtsp_watch_write_data (GstRTSPWatch * watch, const guint8 * data,
   }
 
   if (id != NULL)
-    *id = rec.id;
+    *id = msg_id;
   res = GST_RTSP_OK;
+  n_messages = 0;
+  backlog_func = check_watermarks (watch);
 
 done:
   g_mutex_unlock (&watch->mutex);
 
+  for (; i < n_messages; i++)
+    serialized_message_clear (&messages[i]);
+
   if (context)
     g_main_context_wakeup (context);
 
+  if (backlog_func)
+    backlog_func (watch, watch->user_data);
+
   return res;
 
   /* ERRORS */
 flushing:
   {
     GST_DEBUG ("we are flushing");
-    g_mutex_unlock (&watch->mutex);
-    g_free ((gpointer) data);
-    return GST_RTSP_EINTR;
+    res = GST_RTSP_EINTR;
+    goto done;
   }
 too_much_backlog:
   {
@@ -3878,12 +4255,53 @@ too_much_backlog:
         G_GSIZE_FORMAT ", max_messages %u, current %u", watch->max_bytes,
         watch->messages_bytes, watch->max_messages,
         gst_queue_array_get_length (watch->messages));
-    g_mutex_unlock (&watch->mutex);
-    g_free ((gpointer) data);
-    return GST_RTSP_ENOMEM;
+    res = GST_RTSP_ENOMEM;
+    goto done;
   }
 }
 
+/**
+ * gst_rtsp_watch_write_data:
+ * @watch: a #GstRTSPWatch
+ * @data: (array length=size) (transfer full): the data to queue
+ * @size: the size of @data
+ * @id: (out) (allow-none): location for a message ID or %NULL
+ *
+ * Write @data using the connection of the @watch. If it cannot be sent
+ * immediately, it will be queued for transmission in @watch. The contents of
+ * @message will then be serialized and transmitted when the connection of the
+ * @watch becomes writable. In case the @message is queued, the ID returned in
+ * @id will be non-zero and used as the ID argument in the message_sent
+ * callback.
+ *
+ * This function will take ownership of @data and g_free() it after use.
+ *
+ * If the amount of queued data exceeds the limits set with
+ * gst_rtsp_watch_set_send_backlog(), this function will return
+ * #GST_RTSP_ENOMEM.
+ *
+ * Returns: #GST_RTSP_OK on success. #GST_RTSP_ENOMEM when the backlog limits
+ * are reached. #GST_RTSP_EINTR when @watch was flushing.
+ */
+GstRTSPResult
+gst_rtsp_watch_write_data (GstRTSPWatch * watch, const guint8 * data,
+    guint size, guint * id)
+{
+  GstRTSPSerializedMessage serialized_message;
+
+  g_return_val_if_fail (watch != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (data != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (size != 0, GST_RTSP_EINVAL);
+
+  memset (&serialized_message, 0, sizeof (serialized_message));
+  serialized_message.data = (guint8 *) data;
+  serialized_message.data_size = size;
+  serialized_message.size = size;
+
+  return gst_rtsp_watch_write_serialized_messages (watch, &serialized_message,
+      1, id);
+}
+
 /**
  * gst_rtsp_watch_send_message:
  * @watch: a #GstRTSPWatch
@@ -3897,23 +4315,156 @@ too_much_backlog:
  * @id will be non-zero and used as the ID argument in the message_sent
  * callback.
  *
+ * A body set with gst_rtsp_message_set_body_buffer() is written directly
+ * from the #GstBuffer and only referenced while it is queued.
+ *
  * Returns: #GST_RTSP_OK on success.
  */
 GstRTSPResult
 gst_rtsp_watch_send_message (GstRTSPWatch * watch, GstRTSPMessage * message,
     guint * id)
 {
-  GString *str;
-  guint size;
+  GstRTSPSerializedMessage serialized_message;
 
   g_return_val_if_fail (watch != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (message != NULL, GST_RTSP_EINVAL);
 
-  /* make a record with the message as a string and id */
-  str = message_to_string (watch->conn, message);
-  size = str->len;
-  return gst_rtsp_watch_write_data (watch,
-      (guint8 *) g_string_free (str, FALSE), size, id);
+  if (G_UNLIKELY (!serialize_message (watch->conn, message,
+              &serialized_message)))
+    return GST_RTSP_EINVAL;
+
+  return gst_rtsp_watch_write_serialized_messages (watch, &serialized_message,
+      1, id);
+}
+
+/**
+ * gst_rtsp_watch_send_messages:
+ * @watch: a #GstRTSPWatch
+ * @messages: (array length=n_messages): the messages to send
+ * @n_messages: the number of messages to send
+ * @id: (out) (allow-none): location for a message ID or %NULL
+ *
+ * Sends @messages using the connection of the @watch. If they cannot be sent
+ * immediately, they will be queued for transmission in @watch. The contents
+ * of @messages will then be serialized and transmitted when the connection of
+ * the @watch becomes writable. In case the @messages are queued, the ID
+ * returned in @id will be non-zero and used as the ID argument in the
+ * message_sent callback once the last message is sent. The callback will
+ * only be called once for all messages.
+ *
+ * Compared to calling gst_rtsp_watch_send_message() for each message, the
+ * messages are written with as few write calls as possible.
+ *
+ * Returns: #GST_RTSP_OK on success. #GST_RTSP_ENOMEM when the backlog limits
+ * are reached. #GST_RTSP_EINTR when @watch was flushing.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_watch_send_messages (GstRTSPWatch * watch, GstRTSPMessage * messages,
+    guint n_messages, guint * id)
+{
+  GstRTSPSerializedMessage *serialized_messages;
+  GstRTSPResult res;
+  guint i;
+
+  g_return_val_if_fail (watch != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (messages != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (n_messages != 0, GST_RTSP_EINVAL);
+
+  serialized_messages = g_new0 (GstRTSPSerializedMessage, n_messages);
+  for (i = 0; i < n_messages; i++) {
+    if (G_UNLIKELY (!serialize_message (watch->conn, &messages[i],
+                &serialized_messages[i])))
+      goto no_message;
+  }
+
+  res = gst_rtsp_watch_write_serialized_messages (watch, serialized_messages,
+      n_messages, id);
+  g_free (serialized_messages);
+
+  return res;
+
+no_message:
+  {
+    while (i > 0)
+      serialized_message_clear (&serialized_messages[--i]);
+    g_free (serialized_messages);
+    return GST_RTSP_EINVAL;
+  }
+}
+
+/**
+ * gst_rtsp_watch_set_send_watermarks:
+ * @watch: a #GstRTSPWatch
+ * @high: high watermark in bytes
+ * @low: low watermark in bytes
+ *
+ * Set the backlog watermarks of @watch. When the amount of queued bytes
+ * reaches @high, the backlog_high callback is called. Once the queue drained
+ * again to @low or less, the backlog_low callback is called.
+ *
+ * This allows senders to pause producing data before the limits set with
+ * gst_rtsp_watch_set_send_backlog() are reached.
+ *
+ * A value of 0 for @high disables the watermarks.
+ *
+ * Since: 1.16
+ */
+void
+gst_rtsp_watch_set_send_watermarks (GstRTSPWatch * watch, gsize high,
+    gsize low)
+{
+  g_return_if_fail (watch != NULL);
+  g_return_if_fail (high == 0 || low <= high);
+
+  g_mutex_lock (&watch->mutex);
+  watch->high_watermark = high;
+  watch->low_watermark = low;
+  watch->above_high_watermark = FALSE;
+  g_mutex_unlock (&watch->mutex);
+
+  GST_DEBUG ("set watermarks to high %" G_GSIZE_FORMAT ", low %"
+      G_GSIZE_FORMAT, high, low);
+}
+
+/**
+ * gst_rtsp_watch_get_send_stats:
+ * @watch: a #GstRTSPWatch
+ * @bytes_sent: (out) (allow-none): total bytes written
+ * @messages_sent: (out) (allow-none): total messages written
+ * @bytes_queued: (out) (allow-none): bytes currently queued
+ * @messages_queued: (out) (allow-none): messages currently queued
+ *
+ * Get the send statistics of @watch. The queued amounts include the
+ * messages that were partially written.
+ *
+ * Since: 1.16
+ */
+void
+gst_rtsp_watch_get_send_stats (GstRTSPWatch * watch, guint64 * bytes_sent,
+    guint64 * messages_sent, gsize * bytes_queued, guint * messages_queued)
+{
+  gsize queued;
+  guint i;
+
+  g_return_if_fail (watch != NULL);
+
+  g_mutex_lock (&watch->mutex);
+  if (bytes_sent)
+    *bytes_sent = watch->bytes_sent;
+  if (messages_sent)
+    *messages_sent = watch->messages_sent;
+  if (bytes_queued) {
+    queued = watch->messages_bytes;
+    for (i = 0; i < watch->n_write_messages; i++)
+      queued += watch->write_messages[i].size;
+    *bytes_queued = queued - watch->write_off;
+  }
+  if (messages_queued)
+    *messages_queued = gst_queue_array_get_length (watch->messages) +
+        watch->n_write_messages;
+  g_mutex_unlock (&watch->mutex);
 }
 
 /**
@@ -4003,10 +4554,12 @@ gst_rtsp_watch_set_flushing (GstRTSPWatch * watch, gboolean flushing)
   watch->flushing = flushing;
   g_cond_signal (&watch->queue_not_full);
   if (flushing) {
-    GstRTSPRec *rec;
+    GstRTSPSerializedMessage *msg;
 
-    while ((rec = gst_queue_array_pop_head_struct (watch->messages)))
-      gst_rtsp_rec_clear (rec);
+    while ((msg = gst_queue_array_pop_head_struct (watch->messages)))
+      serialized_message_clear (msg);
+    watch->messages_bytes = 0;
+    watch->above_high_watermark = FALSE;
   }
   g_mutex_unlock (&watch->mutex);
 }
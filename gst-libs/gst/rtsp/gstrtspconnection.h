@@ -136,6 +136,10 @@ GST_RTSP_API
 GstRTSPResult      gst_rtsp_connection_send           (GstRTSPConnection *conn, GstRTSPMessage *message,
                                                        GTimeVal *timeout);
 
+GST_RTSP_API
+GstRTSPResult      gst_rtsp_connection_send_messages  (GstRTSPConnection *conn, GstRTSPMessage *messages,
+                                                       guint n_messages, GTimeVal *timeout);
+
 GST_RTSP_API
 GstRTSPResult      gst_rtsp_connection_receive        (GstRTSPConnection *conn, GstRTSPMessage *message,
                                                        GTimeVal *timeout);
@@ -226,6 +230,12 @@ void               gst_rtsp_connection_set_remember_session_id (GstRTSPConnectio
 GST_RTSP_API
 gboolean           gst_rtsp_connection_get_remember_session_id (GstRTSPConnection *conn);
 
+GST_RTSP_API
+void               gst_rtsp_connection_set_lazy_headers (GstRTSPConnection *conn, gboolean lazy);
+
+GST_RTSP_API
+gboolean           gst_rtsp_connection_get_lazy_headers (GstRTSPConnection *conn);
+
 /* async IO */
 
 /**
@@ -253,6 +263,10 @@ typedef struct _GstRTSPWatch GstRTSPWatch;
  * @tunnel_http_response: callback when an HTTP response to the GET request
  *   is about to be sent for a tunneled connection. The response can be
  *   modified in the callback. Since 1.4.
+ * @backlog_high: callback when the queued bytes reached the high watermark
+ *   set with gst_rtsp_watch_set_send_watermarks(). Since 1.16.
+ * @backlog_low: callback when the queued bytes dropped to the low watermark
+ *   after the high watermark was reached. Since 1.16.
  *
  * Callback functions from a #GstRTSPWatch.
  */
@@ -274,9 +288,11 @@ typedef struct {
                                              GstRTSPMessage *request,
                                              GstRTSPMessage *response,
                                              gpointer user_data);
+  GstRTSPResult     (*backlog_high)     (GstRTSPWatch *watch, gpointer user_data);
+  GstRTSPResult     (*backlog_low)      (GstRTSPWatch *watch, gpointer user_data);
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING-1];
+  gpointer _gst_reserved[GST_PADDING-3];
 } GstRTSPWatchFuncs;
 
 GST_RTSP_API
@@ -313,6 +329,23 @@ GstRTSPResult      gst_rtsp_watch_send_message       (GstRTSPWatch *watch,
                                                       GstRTSPMessage *message,
                                                       guint *id);
 
+GST_RTSP_API
+GstRTSPResult      gst_rtsp_watch_send_messages      (GstRTSPWatch *watch,
+                                                      GstRTSPMessage *messages,
+                                                      guint n_messages,
+                                                      guint *id);
+
+GST_RTSP_API
+void               gst_rtsp_watch_set_send_watermarks (GstRTSPWatch *watch,
+                                                       gsize high, gsize low);
+
+GST_RTSP_API
+void               gst_rtsp_watch_get_send_stats     (GstRTSPWatch *watch,
+                                                      guint64 *bytes_sent,
+                                                      guint64 *messages_sent,
+                                                      gsize *bytes_queued,
+                                                      guint *messages_queued);
+
 GST_RTSP_API
 GstRTSPResult      gst_rtsp_watch_wait_backlog       (GstRTSPWatch * watch,
                                                       GTimeVal *timeout);
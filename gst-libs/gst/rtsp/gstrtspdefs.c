@@ -57,6 +57,7 @@
 #include <string.h>
 
 #include "gstrtspdefs.h"
+#include "gstrtsp-private.h"
 #include <gst/gst.h>
 
 struct rtsp_header
@@ -402,14 +403,41 @@ gst_rtsp_status_as_text (GstRTSPStatusCode code)
 GstRTSPHeaderField
 gst_rtsp_find_header_field (const gchar * header)
 {
-  gint idx;
-
-  for (idx = 0; rtsp_headers[idx].name; idx++) {
-    if (g_ascii_strcasecmp (rtsp_headers[idx].name, header) == 0) {
-      return idx + 1;
+  static gsize init = 0;
+  static GHashTable *fields;
+
+  if (g_once_init_enter (&init)) {
+    gint idx;
+
+    /* maps the case insensitive header names to their field */
+    fields = g_hash_table_new ((GHashFunc) gst_rtsp_header_name_hash,
+        (GEqualFunc) gst_rtsp_header_name_equal);
+    for (idx = 0; rtsp_headers[idx].name; idx++) {
+      g_hash_table_insert (fields, (gpointer) rtsp_headers[idx].name,
+          GINT_TO_POINTER (idx + 1));
     }
+    g_once_init_leave (&init, 1);
   }
-  return GST_RTSP_HDR_INVALID;
+
+  return GPOINTER_TO_INT (g_hash_table_lookup (fields, header));
+}
+
+/* case insensitive hash of a header name */
+guint
+gst_rtsp_header_name_hash (const gchar * name)
+{
+  guint hash = 5381;
+
+  for (; *name != '\0'; name++)
+    hash = (hash << 5) + hash + g_ascii_tolower (*name);
+
+  return hash;
+}
+
+gboolean
+gst_rtsp_header_name_equal (const gchar * name1, const gchar * name2)
+{
+  return g_ascii_strcasecmp (name1, name2) == 0;
 }
 
 /**
@@ -58,14 +58,388 @@
 
 #include <gst/gstutils.h>
 #include "gstrtspmessage.h"
+#include "gstrtsp-private.h"
 
 typedef struct _RTSPKeyValue
 {
   GstRTSPHeaderField field;
   gchar *value;
   gchar *custom_key;            /* custom header string (field is INVALID then) */
+  guint custom_hash;            /* case insensitive hash of custom_key */
+  gboolean undecoded;           /* value contains multiple values that are
+                                 * split when the header is accessed */
 } RTSPKeyValue;
 
+/* Index of the headers of a message, stored in the first reserved pointer.
+ * It has a bit for each header field and a small bloom filter of the custom
+ * header names, so that looking up a missing header, the common case, does not
+ * need to scan all headers. Bits are only cleared when headers are removed. */
+typedef struct
+{
+  guint32 fields[(GST_RTSP_HDR_LAST + 31) / 32];
+  guint32 custom;
+  gint n_undecoded;
+} RTSPHeaderIndex;
+
+#define HEADER_INDEX(msg) ((RTSPHeaderIndex *) (msg)->_gst_reserved[0])
+
+/* A body set as plain data is owned by a BodyData, stored in the second
+ * reserved pointer, that is shared with the GstBuffer wrapping the data. This
+ * keeps both the data and the buffer view of the body available without
+ * converting between them in the const getters, while the data can still be
+ * stolen without a copy when nobody else holds the buffer. */
+typedef struct
+{
+  guint8 *data;
+} BodyData;
+
+#define BODY_DATA(msg) ((BodyData *) (msg)->_gst_reserved[1])
+
+/* A body set as a buffer with a single memory stays mapped while the message
+ * holds it, so that msg->body remains valid. The mapping is stored in the
+ * third reserved pointer. */
+#define BODY_MAP(msg) ((GstMapInfo *) (msg)->_gst_reserved[2])
+
+static void
+body_data_free (BodyData * body)
+{
+  g_free (body->data);
+  g_slice_free (BodyData, body);
+}
+
+static void
+body_clear (GstRTSPMessage * msg)
+{
+  GstMapInfo *map = BODY_MAP (msg);
+
+  if (map != NULL) {
+    gst_buffer_unmap (msg->body_buffer, map);
+    g_slice_free (GstMapInfo, map);
+    msg->_gst_reserved[2] = NULL;
+  } else if (BODY_DATA (msg) == NULL && msg->body_buffer == NULL) {
+    /* the body was assigned to the public field directly */
+    g_free (msg->body);
+  }
+  gst_buffer_replace (&msg->body_buffer, NULL);
+  msg->body = NULL;
+  msg->body_size = 0;
+  msg->_gst_reserved[1] = NULL;
+}
+
+static void
+header_index_add (GstRTSPMessage * msg, const RTSPKeyValue * kv)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+
+  if (index == NULL) {
+    index = g_slice_new0 (RTSPHeaderIndex);
+    msg->_gst_reserved[0] = index;
+  }
+
+  if ((guint) kv->field < GST_RTSP_HDR_LAST)
+    index->fields[kv->field / 32] |= 1u << (kv->field % 32);
+  if (kv->custom_key != NULL)
+    index->custom |= 1u << (kv->custom_hash % 32);
+
+  if (kv->undecoded)
+    g_atomic_int_inc (&index->n_undecoded);
+}
+
+static void
+header_index_rebuild (GstRTSPMessage * msg)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+  guint i;
+
+  if (index == NULL)
+    return;
+
+  memset (index, 0, sizeof (RTSPHeaderIndex));
+  for (i = 0; i < msg->hdr_fields->len; i++)
+    header_index_add (msg, &g_array_index (msg->hdr_fields, RTSPKeyValue, i));
+}
+
+/* returns FALSE if @msg certainly contains no header @field */
+static gboolean
+header_index_has_field (const GstRTSPMessage * msg, GstRTSPHeaderField field)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+
+  if (index == NULL)
+    return FALSE;
+
+  if ((guint) field >= GST_RTSP_HDR_LAST)
+    return TRUE;
+
+  return (index->fields[field / 32] & (1u << (field % 32))) != 0;
+}
+
+/* returns FALSE if @msg certainly contains no custom header with @hash */
+static gboolean
+header_index_has_custom (const GstRTSPMessage * msg, guint hash)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+
+  if (index == NULL)
+    return FALSE;
+
+  return (index->custom & (1u << (hash % 32))) != 0;
+}
+
+static void
+append_key_value (GstRTSPMessage * msg, const RTSPKeyValue * kv)
+{
+  g_array_append_vals (msg->hdr_fields, kv, 1);
+  header_index_add (msg, kv);
+}
+
+typedef void (*HeaderValueFunc) (gchar * value, gpointer user_data);
+
+/* Split @value of a header with @field into its values and call @func for
+ * each of them. @value is modified in place. */
+static void
+header_value_split (GstRTSPMsgType type, GstRTSPHeaderField field,
+    gchar * value, HeaderValueFunc func, gpointer user_data)
+{
+  /* split up the value in multiple key:value pairs if it contains comma(s) */
+  while (*value != '\0') {
+    gchar *next_value;
+    gchar *comma = NULL;
+    gboolean quoted = FALSE;
+    guint comment = 0;
+
+    /* trim leading space */
+    if (*value == ' ')
+      value++;
+
+    /* for headers which may not appear multiple times, and thus may not
+     * contain multiple values on the same line, we can short-circuit the loop
+     * below and the entire value results in just one key:value pair*/
+    if (!gst_rtsp_header_allow_multiple (field))
+      next_value = value + strlen (value);
+    else
+      next_value = value;
+
+    /* find the next value, taking special care of quotes and comments */
+    while (*next_value != '\0') {
+      if ((quoted || comment != 0) && *next_value == '\\' &&
+          next_value[1] != '\0')
+        next_value++;
+      else if (comment == 0 && *next_value == '"')
+        quoted = !quoted;
+      else if (!quoted && *next_value == '(')
+        comment++;
+      else if (comment != 0 && *next_value == ')')
+        comment--;
+      else if (!quoted && comment == 0) {
+        /* To quote RFC 2068: "User agents MUST take special care in parsing
+         * the WWW-Authenticate field value if it contains more than one
+         * challenge, or if more than one WWW-Authenticate header field is
+         * provided, since the contents of a challenge may itself contain a
+         * comma-separated list of authentication parameters."
+         *
+         * What this means is that we cannot just look for an unquoted comma
+         * when looking for multiple values in Proxy-Authenticate and
+         * WWW-Authenticate headers. Instead we need to look for the sequence
+         * "comma [space] token space token" before we can split after the
+         * comma...
+         */
+        if (field == GST_RTSP_HDR_PROXY_AUTHENTICATE ||
+            field == GST_RTSP_HDR_WWW_AUTHENTICATE) {
+          if (*next_value == ',') {
+            if (next_value[1] == ' ') {
+              /* skip any space following the comma so we do not mistake it for
+               * separating between two tokens */
+              next_value++;
+            }
+            comma = next_value;
+          } else if (*next_value == ' ' && next_value[1] != ',' &&
+              next_value[1] != '=' && comma != NULL) {
+            next_value = comma;
+            comma = NULL;
+            break;
+          }
+        } else if (*next_value == ',')
+          break;
+      }
+
+      next_value++;
+    }
+
+    if (type == GST_RTSP_MESSAGE_REQUEST && field == GST_RTSP_HDR_SESSION) {
+      /* The timeout parameter is only allowed in a session response header
+       * but some clients send it as part of the session request header.
+       * Ignore everything from the semicolon to the end of the line. */
+      next_value = value;
+      while (*next_value != '\0') {
+        if (*next_value == ';') {
+          break;
+        }
+        next_value++;
+      }
+    }
+
+    /* trim space */
+    if (value != next_value && next_value[-1] == ' ')
+      next_value[-1] = '\0';
+
+    if (*next_value != '\0')
+      *next_value++ = '\0';
+
+    /* add the key:value pair */
+    if (*value != '\0')
+      func (value, user_data);
+
+    value = next_value;
+  }
+}
+
+typedef struct
+{
+  GstRTSPMessage *msg;
+  GstRTSPHeaderField field;
+  const gchar *name;
+  GArray *values;
+} HeaderSplitData;
+
+static void
+add_split_value (gchar * value, HeaderSplitData * data)
+{
+  if (data->field != GST_RTSP_HDR_INVALID)
+    gst_rtsp_message_take_header (data->msg, data->field, g_strdup (value));
+  else
+    gst_rtsp_message_take_header_by_name (data->msg, data->name,
+        g_strdup (value));
+}
+
+static void
+collect_split_value (gchar * value, HeaderSplitData * data)
+{
+  RTSPKeyValue key_value = { 0, };
+
+  key_value.field = data->field;
+  key_value.value = g_strdup (value);
+
+  g_array_append_val (data->values, key_value);
+}
+
+/* Split the undecoded header at @pos into its values. Returns the number of
+ * headers that replace it */
+static guint
+decode_header (GstRTSPMessage * msg, guint pos)
+{
+  RTSPKeyValue *kv = &g_array_index (msg->hdr_fields, RTSPKeyValue, pos);
+  HeaderSplitData data = { msg, kv->field, NULL, NULL };
+  gchar *value = kv->value;
+  guint n_values;
+
+  data.values = g_array_new (FALSE, FALSE, sizeof (RTSPKeyValue));
+  header_value_split (msg->type, kv->field, value,
+      (HeaderValueFunc) collect_split_value, &data);
+  g_free (value);
+
+  g_array_remove_index (msg->hdr_fields, pos);
+  g_array_insert_vals (msg->hdr_fields, pos, data.values->data,
+      data.values->len);
+  n_values = data.values->len;
+  g_array_free (data.values, TRUE);
+
+  g_atomic_int_add (&HEADER_INDEX (msg)->n_undecoded, -1);
+
+  return n_values;
+}
+
+/* Lazily parsed headers are split by lookups that only get a const message
+ * and may run concurrently in several threads. While a message has undecoded
+ * headers, its lookups hold this lock. Once all headers are decoded, lookups
+ * don't modify the message anymore and run without the lock. */
+static GMutex decode_lock;
+
+/* returns TRUE if the decode lock was taken and must be released */
+static gboolean
+decode_lock_acquire (const GstRTSPMessage * msg)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+
+  if (index == NULL || g_atomic_int_get (&index->n_undecoded) == 0)
+    return FALSE;
+
+  g_mutex_lock (&decode_lock);
+  return TRUE;
+}
+
+static void
+decode_lock_release (gboolean locked)
+{
+  if (locked)
+    g_mutex_unlock (&decode_lock);
+}
+
+/* make sure all headers with @field are split into their values */
+static void
+decode_headers (GstRTSPMessage * msg, GstRTSPHeaderField field)
+{
+  RTSPHeaderIndex *index = HEADER_INDEX (msg);
+  guint i = 0;
+
+  if (index == NULL || g_atomic_int_get (&index->n_undecoded) == 0)
+    return;
+
+  while (i < msg->hdr_fields->len) {
+    RTSPKeyValue *kv = &g_array_index (msg->hdr_fields, RTSPKeyValue, i);
+
+    if (kv->undecoded && kv->field == field)
+      i += decode_header (msg, i);
+    else
+      i++;
+  }
+}
+
+/* Parse a "Key: Value" header line and add its values to @msg. @line is
+ * modified in place. With @lazy, a value with multiple values is stored as is
+ * and only split when the header is accessed */
+GstRTSPResult
+gst_rtsp_message_parse_header_line (GstRTSPMessage * msg, gchar * line,
+    gboolean lazy)
+{
+  HeaderSplitData data = { msg, GST_RTSP_HDR_INVALID, NULL, NULL };
+  gchar *value;
+
+  if ((value = strchr (line, ':')) == NULL || value == line)
+    return GST_RTSP_EPARSE;
+
+  /* trim space before the colon */
+  if (value[-1] == ' ')
+    value[-1] = '\0';
+
+  /* replace the colon with a NUL */
+  *value++ = '\0';
+
+  /* find the header */
+  data.field = gst_rtsp_find_header_field (line);
+  /* custom header not present in the list of pre-defined headers */
+  if (data.field == GST_RTSP_HDR_INVALID)
+    data.name = line;
+
+  if (lazy && gst_rtsp_header_allow_multiple (data.field) &&
+      strchr (value, ',') != NULL) {
+    RTSPKeyValue key_value = { 0, };
+
+    if (*value == ' ')
+      value++;
+
+    key_value.field = data.field;
+    key_value.value = g_strdup (value);
+    key_value.undecoded = TRUE;
+    append_key_value (msg, &key_value);
+  } else {
+    header_value_split (msg->type, data.field, value,
+        (HeaderValueFunc) add_split_value, &data);
+  }
+
+  return GST_RTSP_OK;
+}
+
 static void
 key_value_foreach (GArray * array, GFunc func, gpointer user_data)
 {
@@ -79,17 +453,19 @@ key_value_foreach (GArray * array, GFunc func, gpointer user_data)
 }
 
 static void
-key_value_append (const RTSPKeyValue * kv, GArray * array)
+key_value_append (const RTSPKeyValue * kv, GstRTSPMessage * msg)
 {
   RTSPKeyValue kvcopy;
   g_return_if_fail (kv != NULL);
-  g_return_if_fail (array != NULL);
+  g_return_if_fail (msg != NULL);
 
   kvcopy.field = kv->field;
   kvcopy.value = g_strdup (kv->value);
   kvcopy.custom_key = g_strdup (kv->custom_key);
+  kvcopy.custom_hash = kv->custom_hash;
+  kvcopy.undecoded = kv->undecoded;
 
-  g_array_append_val (array, kvcopy);
+  append_key_value (msg, &kvcopy);
 }
 
 static GstRTSPMessage *
@@ -506,7 +882,9 @@ gst_rtsp_message_unset (GstRTSPMessage * msg)
     }
     g_array_free (msg->hdr_fields, TRUE);
   }
-  g_free (msg->body);
+  if (HEADER_INDEX (msg))
+    g_slice_free (RTSPHeaderIndex, HEADER_INDEX (msg));
+  body_clear (msg);
 
   memset (msg, 0, sizeof (GstRTSPMessage));
 
@@ -552,6 +930,7 @@ gst_rtsp_message_copy (const GstRTSPMessage * msg, GstRTSPMessage ** copy)
 {
   GstRTSPResult ret;
   GstRTSPMessage *cp;
+  gboolean locked;
 
   if (msg == NULL)
     return GST_RTSP_EINVAL;
@@ -585,8 +964,14 @@ gst_rtsp_message_copy (const GstRTSPMessage * msg, GstRTSPMessage ** copy)
       return GST_RTSP_EINVAL;
   }
 
-  key_value_foreach (msg->hdr_fields, (GFunc) key_value_append, cp->hdr_fields);
-  gst_rtsp_message_set_body (cp, msg->body, msg->body_size);
+  locked = decode_lock_acquire (msg);
+  key_value_foreach (msg->hdr_fields, (GFunc) key_value_append, cp);
+  decode_lock_release (locked);
+
+  if (gst_rtsp_message_has_body_buffer (msg))
+    gst_rtsp_message_set_body_buffer (cp, msg->body_buffer);
+  else
+    gst_rtsp_message_set_body (cp, msg->body, msg->body_size);
 
   return GST_RTSP_OK;
 }
@@ -615,8 +1000,10 @@ gst_rtsp_message_take_header (GstRTSPMessage * msg, GstRTSPHeaderField field,
   key_value.field = field;
   key_value.value = value;
   key_value.custom_key = NULL;
+  key_value.custom_hash = 0;
+  key_value.undecoded = FALSE;
 
-  g_array_append_val (msg->hdr_fields, key_value);
+  append_key_value (msg, &key_value);
 
   return GST_RTSP_OK;
 }
@@ -660,11 +1047,17 @@ gst_rtsp_message_remove_header (GstRTSPMessage * msg, GstRTSPHeaderField field,
 
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
 
+  if (!header_index_has_field (msg, field))
+    return res;
+
+  decode_headers (msg, field);
+
   while (i < msg->hdr_fields->len) {
     RTSPKeyValue *key_value = &g_array_index (msg->hdr_fields, RTSPKeyValue, i);
 
     if (key_value->field == field && (indx == -1 || cnt++ == indx)) {
       g_free (key_value->value);
+      g_free (key_value->custom_key);
       g_array_remove_index (msg->hdr_fields, i);
       res = GST_RTSP_OK;
       if (indx != -1)
@@ -673,6 +1066,9 @@ gst_rtsp_message_remove_header (GstRTSPMessage * msg, GstRTSPHeaderField field,
       i++;
     }
   }
+  if (res == GST_RTSP_OK)
+    header_index_rebuild (msg);
+
   return res;
 }
 
@@ -693,6 +1089,8 @@ GstRTSPResult
 gst_rtsp_message_get_header (const GstRTSPMessage * msg,
     GstRTSPHeaderField field, gchar ** value, gint indx)
 {
+  GstRTSPResult res = GST_RTSP_ENOTIMPL;
+  gboolean locked;
   guint i;
   gint cnt = 0;
 
@@ -702,17 +1100,26 @@ gst_rtsp_message_get_header (const GstRTSPMessage * msg,
   if (msg->hdr_fields == NULL)
     return GST_RTSP_ENOTIMPL;
 
+  if (!header_index_has_field (msg, field))
+    return GST_RTSP_ENOTIMPL;
+
+  /* split lazily parsed values now that they are needed */
+  locked = decode_lock_acquire (msg);
+  decode_headers ((GstRTSPMessage *) msg, field);
+
   for (i = 0; i < msg->hdr_fields->len; i++) {
     RTSPKeyValue *key_value = &g_array_index (msg->hdr_fields, RTSPKeyValue, i);
 
     if (key_value->field == field && cnt++ == indx) {
       if (value)
         *value = key_value->value;
-      return GST_RTSP_OK;
+      res = GST_RTSP_OK;
+      break;
     }
   }
+  decode_lock_release (locked);
 
-  return GST_RTSP_ENOTIMPL;
+  return res;
 }
 
 /**
@@ -771,8 +1178,10 @@ gst_rtsp_message_take_header_by_name (GstRTSPMessage * msg,
   key_value.field = GST_RTSP_HDR_INVALID;
   key_value.value = value;
   key_value.custom_key = g_strdup (header);
+  key_value.custom_hash = gst_rtsp_header_name_hash (header);
+  key_value.undecoded = FALSE;
 
-  g_array_append_val (msg->hdr_fields, key_value);
+  append_key_value (msg, &key_value);
 
   return GST_RTSP_OK;
 }
@@ -783,6 +1192,7 @@ gst_rtsp_message_find_header_by_name (GstRTSPMessage * msg,
     const gchar * header, gint index)
 {
   GstRTSPHeaderField field;
+  guint hash = 0;
   gint cnt = 0;
   guint i;
 
@@ -791,6 +1201,16 @@ gst_rtsp_message_find_header_by_name (GstRTSPMessage * msg,
     return -1;
 
   field = gst_rtsp_find_header_field (header);
+  if (field != GST_RTSP_HDR_INVALID) {
+    if (!header_index_has_field (msg, field))
+      return -1;
+    decode_headers (msg, field);
+  } else {
+    hash = gst_rtsp_header_name_hash (header);
+    if (!header_index_has_custom (msg, hash))
+      return -1;
+  }
+
   for (i = 0; i < msg->hdr_fields->len; i++) {
     RTSPKeyValue *key_val;
 
@@ -799,8 +1219,8 @@ gst_rtsp_message_find_header_by_name (GstRTSPMessage * msg,
     if (key_val->field != field)
       continue;
 
-    if (key_val->custom_key != NULL &&
-        g_ascii_strcasecmp (key_val->custom_key, header) != 0)
+    if (key_val->custom_key != NULL && (key_val->custom_hash != hash ||
+            g_ascii_strcasecmp (key_val->custom_key, header) != 0))
       continue;
 
     if (index < 0 || cnt++ == index)
@@ -847,6 +1267,9 @@ gst_rtsp_message_remove_header_by_name (GstRTSPMessage * msg,
     res = GST_RTSP_OK;
   } while (index < 0);
 
+  if (res == GST_RTSP_OK)
+    header_index_rebuild (msg);
+
   return res;
 }
 
@@ -870,22 +1293,24 @@ gst_rtsp_message_get_header_by_name (GstRTSPMessage * msg,
     const gchar * header, gchar ** value, gint index)
 {
   RTSPKeyValue *key_val;
+  gboolean locked;
   gint pos;
 
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (header != NULL, GST_RTSP_EINVAL);
 
+  locked = decode_lock_acquire (msg);
   pos = gst_rtsp_message_find_header_by_name (msg, header, index);
 
-  if (pos < 0)
-    return GST_RTSP_ENOTIMPL;
-
-  key_val = &g_array_index (msg->hdr_fields, RTSPKeyValue, pos);
+  if (pos >= 0) {
+    key_val = &g_array_index (msg->hdr_fields, RTSPKeyValue, pos);
 
-  if (value)
-    *value = key_val->value;
+    if (value)
+      *value = key_val->value;
+  }
+  decode_lock_release (locked);
 
-  return GST_RTSP_OK;
+  return pos >= 0 ? GST_RTSP_OK : GST_RTSP_ENOTIMPL;
 }
 
 /**
@@ -901,11 +1326,13 @@ gst_rtsp_message_get_header_by_name (GstRTSPMessage * msg,
 GstRTSPResult
 gst_rtsp_message_append_headers (const GstRTSPMessage * msg, GString * str)
 {
+  gboolean locked;
   guint i;
 
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (str != NULL, GST_RTSP_EINVAL);
 
+  locked = decode_lock_acquire (msg);
   for (i = 0; i < msg->hdr_fields->len; i++) {
     RTSPKeyValue *key_value;
     const gchar *keystr;
@@ -919,6 +1346,8 @@ gst_rtsp_message_append_headers (const GstRTSPMessage * msg, GString * str)
 
     g_string_append_printf (str, "%s: %s\r\n", keystr, key_value->value);
   }
+  decode_lock_release (locked);
+
   return GST_RTSP_OK;
 }
 
@@ -955,13 +1384,26 @@ gst_rtsp_message_set_body (GstRTSPMessage * msg, const guint8 * data,
 GstRTSPResult
 gst_rtsp_message_take_body (GstRTSPMessage * msg, guint8 * data, guint size)
 {
+  BodyData *body;
+
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (data != NULL || size == 0, GST_RTSP_EINVAL);
 
-  g_free (msg->body);
+  body_clear (msg);
 
+  if (size == 0) {
+    g_free (data);
+    return GST_RTSP_OK;
+  }
+
+  body = g_slice_new (BodyData);
+  body->data = data;
+
+  msg->body_buffer = gst_buffer_new_wrapped_full (0, data, size, 0, size, body,
+      (GDestroyNotify) body_data_free);
   msg->body = data;
   msg->body_size = size;
+  msg->_gst_reserved[1] = body;
 
   return GST_RTSP_OK;
 }
@@ -975,7 +1417,11 @@ gst_rtsp_message_take_body (GstRTSPMessage * msg, guint8 * data, guint size)
  * Get the body of @msg. @data remains valid for as long as @msg is valid and
  * unchanged.
  *
- * Returns: #GST_RTSP_OK.
+ * If the body was set as a #GstBuffer made of multiple memories, it is not
+ * available as contiguous data and #GST_RTSP_EINVAL is returned. Use
+ * gst_rtsp_message_get_body_buffer() for such bodies.
+ *
+ * Returns: #GST_RTSP_OK, or #GST_RTSP_EINVAL when the body is not contiguous.
  */
 GstRTSPResult
 gst_rtsp_message_get_body (const GstRTSPMessage * msg, guint8 ** data,
@@ -985,6 +1431,12 @@ gst_rtsp_message_get_body (const GstRTSPMessage * msg, guint8 ** data,
   g_return_val_if_fail (data != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (size != NULL, GST_RTSP_EINVAL);
 
+  if (msg->body == NULL && msg->body_buffer != NULL) {
+    *data = NULL;
+    *size = 0;
+    return GST_RTSP_EINVAL;
+  }
+
   *data = msg->body;
   *size = msg->body_size;
 
@@ -1000,24 +1452,182 @@ gst_rtsp_message_get_body (const GstRTSPMessage * msg, guint8 ** data,
  * Take the body of @msg and store it in @data and @size. After this method,
  * the body and size of @msg will be set to %NULL and 0 respectively.
  *
+ * The data is copied if the body was set as a #GstBuffer or if its buffer
+ * is still used elsewhere.
+ *
  * Returns: #GST_RTSP_OK.
  */
 GstRTSPResult
 gst_rtsp_message_steal_body (GstRTSPMessage * msg, guint8 ** data, guint * size)
 {
+  BodyData *body;
+
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (data != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (size != NULL, GST_RTSP_EINVAL);
 
-  *data = msg->body;
+  body = BODY_DATA (msg);
   *size = msg->body_size;
 
-  msg->body = NULL;
-  msg->body_size = 0;
+  if (body != NULL && GST_MINI_OBJECT_REFCOUNT_VALUE (msg->body_buffer) == 1
+      && gst_buffer_n_memory (msg->body_buffer) == 1
+      && GST_MINI_OBJECT_REFCOUNT_VALUE (gst_buffer_peek_memory
+          (msg->body_buffer, 0)) == 1) {
+    /* nobody else can see the data, take it away from the buffer */
+    *data = body->data;
+    body->data = NULL;
+  } else if (msg->body_buffer != NULL) {
+    *data = g_malloc (*size);
+    gst_buffer_extract (msg->body_buffer, 0, *data, *size);
+  } else {
+    /* the body was assigned to the public field directly, if at all */
+    *data = msg->body;
+    msg->body = NULL;
+  }
+
+  body_clear (msg);
+
+  return GST_RTSP_OK;
+}
+
+/**
+ * gst_rtsp_message_set_body_buffer:
+ * @msg: a #GstRTSPMessage
+ * @buffer: (transfer none): a #GstBuffer
+ *
+ * Set the body of @msg to @buffer. The buffer is referenced, not copied, and
+ * is written to the connection as is when @msg is sent, which avoids copying
+ * large bodies and interleaved data.
+ *
+ * Returns: #GST_RTSP_OK.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_message_set_body_buffer (GstRTSPMessage * msg, GstBuffer * buffer)
+{
+  g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_RTSP_EINVAL);
+
+  return gst_rtsp_message_take_body_buffer (msg, gst_buffer_ref (buffer));
+}
+
+/**
+ * gst_rtsp_message_take_body_buffer:
+ * @msg: a #GstRTSPMessage
+ * @buffer: (transfer full): a #GstBuffer
+ *
+ * Set the body of @msg to @buffer. This method takes ownership of @buffer.
+ *
+ * Returns: #GST_RTSP_OK.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_message_take_body_buffer (GstRTSPMessage * msg, GstBuffer * buffer)
+{
+  g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_RTSP_EINVAL);
+
+  body_clear (msg);
+
+  msg->body_buffer = buffer;
+  msg->body_size = gst_buffer_get_size (buffer);
+
+  /* a single memory is also exposed as contiguous data, it stays mapped
+   * until the body is cleared */
+  if (gst_buffer_n_memory (buffer) == 1) {
+    GstMapInfo *map = g_slice_new (GstMapInfo);
+
+    if (gst_buffer_map (buffer, map, GST_MAP_READ)) {
+      msg->body = map->data;
+      msg->_gst_reserved[2] = map;
+    } else {
+      g_slice_free (GstMapInfo, map);
+    }
+  }
+
+  return GST_RTSP_OK;
+}
+
+/**
+ * gst_rtsp_message_get_body_buffer:
+ * @msg: a #GstRTSPMessage
+ * @buffer: (out) (transfer none): location for the buffer
+ *
+ * Get the body of @msg as a #GstBuffer. @buffer remains valid for as long as
+ * @msg is valid and unchanged.
+ *
+ * If the body was set as plain data, @buffer wraps that data without a copy.
+ *
+ * Returns: #GST_RTSP_OK.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_message_get_body_buffer (const GstRTSPMessage * msg,
+    GstBuffer ** buffer)
+{
+  g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (buffer != NULL, GST_RTSP_EINVAL);
+
+  *buffer = msg->body_buffer;
 
   return GST_RTSP_OK;
 }
 
+/**
+ * gst_rtsp_message_steal_body_buffer:
+ * @msg: a #GstRTSPMessage
+ * @buffer: (out) (transfer full): location for the buffer
+ *
+ * Take the body of @msg as a #GstBuffer and store it in @buffer. After this
+ * method, @msg has no body anymore.
+ *
+ * Returns: #GST_RTSP_OK.
+ *
+ * Since: 1.16
+ */
+GstRTSPResult
+gst_rtsp_message_steal_body_buffer (GstRTSPMessage * msg, GstBuffer ** buffer)
+{
+  g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
+  g_return_val_if_fail (buffer != NULL, GST_RTSP_EINVAL);
+
+  if (msg->body_buffer != NULL) {
+    /* a plain data body stays alive with the buffer */
+    *buffer = gst_buffer_ref (msg->body_buffer);
+  } else if (msg->body != NULL) {
+    /* the body was assigned to the public field directly */
+    *buffer = gst_buffer_new_wrapped (msg->body, msg->body_size);
+    msg->body = NULL;
+  } else {
+    *buffer = NULL;
+  }
+
+  body_clear (msg);
+
+  return GST_RTSP_OK;
+}
+
+/**
+ * gst_rtsp_message_has_body_buffer:
+ * @msg: a #GstRTSPMessage
+ *
+ * Checks if @msg has a body set as a #GstBuffer.
+ *
+ * Returns: %TRUE if @msg has a body buffer.
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_rtsp_message_has_body_buffer (const GstRTSPMessage * msg)
+{
+  g_return_val_if_fail (msg != NULL, FALSE);
+
+  return msg->body_buffer != NULL && BODY_DATA (msg) == NULL;
+}
+
 static void
 dump_key_value (gpointer data, gpointer user_data G_GNUC_UNUSED)
 {
@@ -1032,6 +1642,23 @@ dump_key_value (gpointer data, gpointer user_data G_GNUC_UNUSED)
   g_print ("   key: '%s', value: '%s'\n", key_string, key_value->value);
 }
 
+/* dumps a body buffer without flattening it into the message */
+static void
+dump_body (const GstRTSPMessage * msg)
+{
+  guint8 *data;
+
+  if (msg->body != NULL || msg->body_buffer == NULL) {
+    gst_util_dump_mem (msg->body, msg->body_size);
+    return;
+  }
+
+  data = g_malloc (msg->body_size);
+  gst_buffer_extract (msg->body_buffer, 0, data, msg->body_size);
+  gst_util_dump_mem (data, msg->body_size);
+  g_free (data);
+}
+
 /**
  * gst_rtsp_message_dump:
  * @msg: a #GstRTSPMessage
@@ -1043,9 +1670,6 @@ dump_key_value (gpointer data, gpointer user_data G_GNUC_UNUSED)
 GstRTSPResult
 gst_rtsp_message_dump (GstRTSPMessage * msg)
 {
-  guint8 *data;
-  guint size;
-
   g_return_val_if_fail (msg != NULL, GST_RTSP_EINVAL);
 
   switch (msg->type) {
@@ -1060,8 +1684,7 @@ gst_rtsp_message_dump (GstRTSPMessage * msg)
       g_print (" headers:\n");
       key_value_foreach (msg->hdr_fields, dump_key_value, NULL);
       g_print (" body:\n");
-      gst_rtsp_message_get_body (msg, &data, &size);
-      gst_util_dump_mem (data, size);
+      dump_body (msg);
       break;
     case GST_RTSP_MESSAGE_RESPONSE:
       g_print ("RTSP response message %p\n", msg);
@@ -1072,9 +1695,8 @@ gst_rtsp_message_dump (GstRTSPMessage * msg)
           gst_rtsp_version_as_text (msg->type_data.response.version));
       g_print (" headers:\n");
       key_value_foreach (msg->hdr_fields, dump_key_value, NULL);
-      gst_rtsp_message_get_body (msg, &data, &size);
-      g_print (" body: length %d\n", size);
-      gst_util_dump_mem (data, size);
+      g_print (" body: length %d\n", msg->body_size);
+      dump_body (msg);
       break;
     case GST_RTSP_MESSAGE_HTTP_REQUEST:
       g_print ("HTTP request message %p\n", msg);
@@ -1087,8 +1709,7 @@ gst_rtsp_message_dump (GstRTSPMessage * msg)
       g_print (" headers:\n");
       key_value_foreach (msg->hdr_fields, dump_key_value, NULL);
       g_print (" body:\n");
-      gst_rtsp_message_get_body (msg, &data, &size);
-      gst_util_dump_mem (data, size);
+      dump_body (msg);
       break;
     case GST_RTSP_MESSAGE_HTTP_RESPONSE:
       g_print ("HTTP response message %p\n", msg);
@@ -1099,16 +1720,14 @@ gst_rtsp_message_dump (GstRTSPMessage * msg)
           gst_rtsp_version_as_text (msg->type_data.response.version));
       g_print (" headers:\n");
       key_value_foreach (msg->hdr_fields, dump_key_value, NULL);
-      gst_rtsp_message_get_body (msg, &data, &size);
-      g_print (" body: length %d\n", size);
-      gst_util_dump_mem (data, size);
+      g_print (" body: length %d\n", msg->body_size);
+      dump_body (msg);
       break;
     case GST_RTSP_MESSAGE_DATA:
       g_print ("RTSP data message %p\n", msg);
       g_print (" channel: '%d'\n", msg->type_data.data.channel);
       g_print (" size:    '%d'\n", msg->body_size);
-      gst_rtsp_message_get_body (msg, &data, &size);
-      gst_util_dump_mem (data, size);
+      dump_body (msg);
       break;
     default:
       g_print ("unsupported message type %d\n", msg->type);
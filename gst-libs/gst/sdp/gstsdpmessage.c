@@ -3124,6 +3124,86 @@ gst_sdp_parse_line (SDPContext * c, gchar type, gchar * buffer)
   return TRUE;
 }
 
+/* Splits SDP text into "<type>=<value>" lines without copying, the value
+ * points into the original data and is not NUL terminated */
+typedef struct
+{
+  const gchar *data;
+  guint size;
+  guint pos;
+  gboolean in_line;
+} SDPLineReader;
+
+static void
+sdp_line_reader_init (SDPLineReader * reader, const guint8 * data, guint size)
+{
+  reader->data = (const gchar *) data;
+  reader->size = size;
+  reader->pos = 0;
+  reader->in_line = FALSE;
+}
+
+static gboolean
+sdp_line_reader_next (SDPLineReader * reader, gchar * type,
+    const gchar ** value, guint * len)
+{
+  const gchar *data = reader->data;
+  guint size = reader->size;
+  guint p = reader->pos;
+  guint s;
+
+  while (TRUE) {
+    if (reader->in_line) {
+      /* skip the remainder of the current line */
+      while (p < size && data[p] != '\n' && data[p] != '\0')
+        p++;
+
+      if (p >= size)
+        goto done;
+
+      if (data[p] == '\n')
+        p++;
+      reader->in_line = FALSE;
+    }
+
+    while (p < size && g_ascii_isspace (data[p]))
+      p++;
+
+    if (p >= size)
+      goto done;
+
+    *type = data[p++];
+    if (*type == '\0')
+      goto done;
+
+    if (p >= size)
+      goto done;
+
+    reader->in_line = TRUE;
+
+    if (data[p] != '=')
+      continue;
+    p++;
+
+    if (p >= size)
+      goto done;
+
+    s = p;
+    while (p < size && data[p] != '\n' && data[p] != '\r' && data[p] != '\0')
+      p++;
+
+    *value = data + s;
+    *len = p - s;
+    reader->pos = p;
+
+    return TRUE;
+  }
+
+done:
+  reader->pos = size;
+  return FALSE;
+}
+
 /**
  * gst_sdp_message_parse_buffer:
  * @data: (array length=size): the start of the buffer
@@ -3139,8 +3219,9 @@ GstSDPResult
 gst_sdp_message_parse_buffer (const guint8 * data, guint size,
     GstSDPMessage * msg)
 {
-  gchar *p, *s;
+  SDPLineReader reader;
   SDPContext c;
+  const gchar *s;
   gchar type;
   gchar *buffer = NULL;
   guint bufsize = 0;
@@ -3154,36 +3235,8 @@ gst_sdp_message_parse_buffer (const guint8 * data, guint size,
   c.msg = msg;
   c.media = NULL;
 
-#define SIZE_CHECK_GUARD \
-  G_STMT_START { \
-    if (p - (gchar *) data >= size) \
-      goto out; \
-  } G_STMT_END
-
-  p = (gchar *) data;
-  while (TRUE) {
-    while (p - (gchar *) data < size && g_ascii_isspace (*p))
-      p++;
-
-    SIZE_CHECK_GUARD;
-
-    type = *p++;
-    if (type == '\0')
-      break;
-
-    SIZE_CHECK_GUARD;
-
-    if (*p != '=')
-      goto line_done;
-    p++;
-
-    SIZE_CHECK_GUARD;
-
-    s = p;
-    while (p - (gchar *) data < size && *p != '\n' && *p != '\r' && *p != '\0')
-      p++;
-
-    len = p - s;
+  sdp_line_reader_init (&reader, data, size);
+  while (sdp_line_reader_next (&reader, &type, &s, &len)) {
     if (bufsize <= len) {
       buffer = g_realloc (buffer, len + 1);
       bufsize = len + 1;
@@ -3192,25 +3245,89 @@ gst_sdp_message_parse_buffer (const guint8 * data, guint size,
     buffer[len] = '\0';
 
     gst_sdp_parse_line (&c, type, buffer);
+  }
 
-    SIZE_CHECK_GUARD;
+  g_free (buffer);
 
-  line_done:
-    while (p - (gchar *) data < size && *p != '\n' && *p != '\0')
-      p++;
+  return GST_SDP_OK;
+}
 
-    SIZE_CHECK_GUARD;
+/**
+ * gst_sdp_buffer_find_attribute:
+ * @data: (array length=size): the start of the buffer
+ * @size: the size of the buffer
+ * @media_idx: the index of the media description or -1 for the session
+ * @key: the key
+ * @nth: the index
+ * @value: (out) (transfer none) (allow-none): the value of the attribute
+ * @value_len: (out) (allow-none): the length of @value
+ *
+ * Find the @nth attribute with @key of the session or of the media
+ * description at @media_idx in the SDP in @data, without parsing it into a
+ * #GstSDPMessage. This is useful when only a few attributes of a message are
+ * needed.
+ *
+ * @value points into @data and is not NUL terminated. It is the empty string
+ * for property attributes, like gst_sdp_message_parse_buffer() would store.
+ *
+ * Returns: %TRUE when the attribute was found.
+ *
+ * Since: 1.16
+ */
+gboolean
+gst_sdp_buffer_find_attribute (const guint8 * data, guint size,
+    gint media_idx, const gchar * key, guint nth, const gchar ** value,
+    guint * value_len)
+{
+  SDPLineReader reader;
+  const gchar *line, *end;
+  gchar type;
+  guint len, keylen;
+  gint media = -1;
 
-    if (*p == '\n')
-      p++;
-  }
+  g_return_val_if_fail (data != NULL || size == 0, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
 
-#undef SIZE_CHECK_GUARD
+  keylen = strlen (key);
 
-out:
-  g_free (buffer);
+  sdp_line_reader_init (&reader, data, size);
+  while (sdp_line_reader_next (&reader, &type, &line, &len)) {
+    if (type == 'm') {
+      /* the attributes we look for can't come after the next media */
+      if (media++ == media_idx)
+        break;
+      continue;
+    }
+    if (type != 'a' || media != media_idx)
+      continue;
 
-  return GST_SDP_OK;
+    end = line + len;
+    /* skip spaces before the key */
+    while (line < end && g_ascii_isspace (*line))
+      line++;
+
+    if ((guint) (end - line) < keylen || memcmp (line, key, keylen) != 0)
+      continue;
+    line += keylen;
+
+    if (line < end && *line != ':')
+      continue;
+
+    if (nth > 0) {
+      nth--;
+      continue;
+    }
+
+    if (line < end)
+      line++;
+    if (value)
+      *value = line;
+    if (value_len)
+      *value_len = end - line;
+
+    return TRUE;
+  }
+  return FALSE;
 }
 
 static void
@@ -337,6 +337,12 @@ GstSDPResult            gst_sdp_message_copy                (const GstSDPMessage
 GST_SDP_API
 GstSDPResult            gst_sdp_message_parse_buffer        (const guint8 *data, guint size, GstSDPMessage *msg);
 
+GST_SDP_API
+gboolean                gst_sdp_buffer_find_attribute       (const guint8 *data, guint size,
+                                                             gint media_idx, const gchar *key,
+                                                             guint nth, const gchar **value,
+                                                             guint *value_len);
+
 GST_SDP_API
 gchar*                  gst_sdp_message_as_text             (const GstSDPMessage *msg);
 
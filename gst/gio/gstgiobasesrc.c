@@ -35,10 +35,24 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+enum
+{
+  PROP_0,
+  PROP_READ_AHEAD_BLOCK_SIZE,
+  PROP_READ_AHEAD_BLOCKS
+};
+
+#define DEFAULT_READ_AHEAD_BLOCK_SIZE (64 * 1024)
+#define DEFAULT_READ_AHEAD_BLOCKS 0
+
 #define gst_gio_base_src_parent_class parent_class
 G_DEFINE_TYPE (GstGioBaseSrc, gst_gio_base_src, GST_TYPE_BASE_SRC);
 
 static void gst_gio_base_src_finalize (GObject * object);
+static void gst_gio_base_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_gio_base_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_gio_base_src_start (GstBaseSrc * base_src);
 static gboolean gst_gio_base_src_stop (GstBaseSrc * base_src);
@@ -52,6 +66,10 @@ static GstFlowReturn gst_gio_base_src_create (GstBaseSrc * base_src,
 static gboolean gst_gio_base_src_query (GstBaseSrc * base_src,
     GstQuery * query);
 
+static void gst_gio_base_src_stop_read_ahead (GstGioBaseSrc * src);
+static GstFlowReturn gst_gio_base_src_create_read_ahead (GstGioBaseSrc * src,
+    guint64 offset, guint size, GstBuffer ** buf_return);
+
 static void
 gst_gio_base_src_class_init (GstGioBaseSrcClass * klass)
 {
@@ -63,6 +81,44 @@ gst_gio_base_src_class_init (GstGioBaseSrcClass * klass)
       "GIO base source");
 
   gobject_class->finalize = gst_gio_base_src_finalize;
+  gobject_class->set_property = gst_gio_base_src_set_property;
+  gobject_class->get_property = gst_gio_base_src_get_property;
+
+  /**
+   * GstGioBaseSrc:read-ahead-block-size:
+   *
+   * Size in bytes of the blocks kept in the read-ahead cache.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD_BLOCK_SIZE,
+      g_param_spec_uint ("read-ahead-block-size", "Read-ahead block size",
+          "Size in bytes of the blocks in the read-ahead cache", 4096,
+          G_MAXINT, DEFAULT_READ_AHEAD_BLOCK_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGioBaseSrc:read-ahead-blocks:
+   *
+   * Number of blocks kept in the read-ahead cache, or 0 to disable the
+   * read-ahead thread.
+   *
+   * When enabled, a background thread reads blocks following the current
+   * read position while downstream processes the data, and recently used
+   * blocks are kept so that seeks back into them don't need another round
+   * trip to the storage. This mostly helps with slow (e.g. network-mounted)
+   * locations. Up to half of the blocks are used for prefetching, the least
+   * recently used blocks are evicted first.
+   *
+   * Changes take effect the next time the element is started.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD_BLOCKS,
+      g_param_spec_uint ("read-ahead-blocks", "Read-ahead blocks",
+          "Number of blocks in the read-ahead cache (0 = disabled)", 0,
+          G_MAXINT, DEFAULT_READ_AHEAD_BLOCKS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_static_pad_template (gstelement_class, &src_factory);
 
@@ -82,6 +138,14 @@ static void
 gst_gio_base_src_init (GstGioBaseSrc * src)
 {
   src->cancel = g_cancellable_new ();
+
+  src->read_ahead_block_size = DEFAULT_READ_AHEAD_BLOCK_SIZE;
+  src->read_ahead_blocks = DEFAULT_READ_AHEAD_BLOCKS;
+
+  g_mutex_init (&src->stream_lock);
+  g_mutex_init (&src->ra_lock);
+  g_cond_init (&src->ra_cond);
+  g_queue_init (&src->ra_cache);
 }
 
 static void
@@ -104,9 +168,59 @@ gst_gio_base_src_finalize (GObject * object)
     src->cache = NULL;
   }
 
+  g_mutex_clear (&src->stream_lock);
+  g_mutex_clear (&src->ra_lock);
+  g_cond_clear (&src->ra_cond);
+
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
 
+static void
+gst_gio_base_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstGioBaseSrc *src = GST_GIO_BASE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_READ_AHEAD_BLOCK_SIZE:
+      GST_OBJECT_LOCK (src);
+      src->read_ahead_block_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_READ_AHEAD_BLOCKS:
+      GST_OBJECT_LOCK (src);
+      src->read_ahead_blocks = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_gio_base_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGioBaseSrc *src = GST_GIO_BASE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_READ_AHEAD_BLOCK_SIZE:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->read_ahead_block_size);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_READ_AHEAD_BLOCKS:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->read_ahead_blocks);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_gio_base_src_start (GstBaseSrc * base_src)
 {
@@ -130,6 +244,17 @@ gst_gio_base_src_start (GstBaseSrc * base_src)
   if (G_IS_SEEKABLE (src->stream))
     src->position = g_seekable_tell (G_SEEKABLE (src->stream));
 
+  GST_OBJECT_LOCK (src);
+  src->ra_block_size = src->read_ahead_block_size;
+  src->ra_n_blocks = src->read_ahead_blocks;
+  GST_OBJECT_UNLOCK (src);
+
+  src->ra_request = GST_BUFFER_OFFSET_NONE;
+  src->ra_next = GST_BUFFER_OFFSET_NONE;
+  src->ra_window_end = 0;
+  src->ra_eos = GST_BUFFER_OFFSET_NONE;
+  src->ra_flushing = FALSE;
+
   GST_DEBUG_OBJECT (src, "started source");
 
   return TRUE;
@@ -143,6 +268,8 @@ gst_gio_base_src_stop (GstBaseSrc * base_src)
   gboolean success;
   GError *err = NULL;
 
+  gst_gio_base_src_stop_read_ahead (src);
+
   if (klass->close_on_stop && G_IS_INPUT_STREAM (src->stream)) {
     GST_DEBUG_OBJECT (src, "closing stream");
 
@@ -209,6 +336,9 @@ gst_gio_base_src_get_size (GstBaseSrc * base_src, guint64 * size)
     GSeekable *seekable = G_SEEKABLE (src->stream);
     GError *err = NULL;
 
+    /* the read-ahead thread might be using the stream */
+    g_mutex_lock (&src->stream_lock);
+
     old = g_seekable_tell (seekable);
 
     ret = g_seekable_seek (seekable, 0, G_SEEK_END, src->cancel, &err);
@@ -224,12 +354,14 @@ gst_gio_base_src_get_size (GstBaseSrc * base_src, guint64 * size)
       } else {
         GST_WARNING_OBJECT (src, "Seeking to end of stream failed");
       }
+      g_mutex_unlock (&src->stream_lock);
       return FALSE;
     }
 
     stream_size = g_seekable_tell (seekable);
 
     ret = g_seekable_seek (seekable, old, G_SEEK_SET, src->cancel, &err);
+    g_mutex_unlock (&src->stream_lock);
     if (!ret) {
       if (!gst_gio_error (src, "g_seekable_seek", &err, NULL)) {
         if (GST_GIO_ERROR_MATCHES (err, NOT_SUPPORTED))
@@ -275,6 +407,11 @@ gst_gio_base_src_unlock (GstBaseSrc * base_src)
 
   g_cancellable_cancel (src->cancel);
 
+  g_mutex_lock (&src->ra_lock);
+  src->ra_flushing = TRUE;
+  g_cond_broadcast (&src->ra_cond);
+  g_mutex_unlock (&src->ra_lock);
+
   return TRUE;
 }
 
@@ -288,9 +425,320 @@ gst_gio_base_src_unlock_stop (GstBaseSrc * base_src)
   g_object_unref (src->cancel);
   src->cancel = g_cancellable_new ();
 
+  g_mutex_lock (&src->ra_lock);
+  src->ra_flushing = FALSE;
+  g_clear_error (&src->ra_error);
+  g_mutex_unlock (&src->ra_lock);
+
   return TRUE;
 }
 
+/* Reads the block starting at @offset from the stream. Returns NULL and
+ * leaves @err unset at the end of the stream */
+static GstBuffer *
+gst_gio_base_src_read_block (GstGioBaseSrc * src, guint64 offset,
+    GError ** err)
+{
+  GstBuffer *block = NULL;
+  GstMemory *mem;
+  GstMapInfo map;
+  gssize res = 0;
+  gsize read = 0;
+
+  g_mutex_lock (&src->stream_lock);
+
+  if (offset != src->position) {
+    if (!GST_GIO_STREAM_IS_SEEKABLE (src->stream)) {
+      g_set_error (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+          "Stream is not seekable");
+      goto done;
+    }
+
+    GST_DEBUG_OBJECT (src, "Seeking to position %" G_GUINT64_FORMAT, offset);
+    if (!g_seekable_seek (G_SEEKABLE (src->stream), offset, G_SEEK_SET,
+            src->ra_cancel, err))
+      goto done;
+    src->position = offset;
+  }
+
+  mem = gst_allocator_alloc (NULL, src->ra_block_size, NULL);
+  if (mem == NULL) {
+    g_set_error (err, G_IO_ERROR, G_IO_ERROR_FAILED,
+        "Failed to allocate %u bytes", src->ra_block_size);
+    goto done;
+  }
+
+  /* like in the normal path, loop until we have a full block or the stream
+   * doesn't give us anything anymore */
+  gst_memory_map (mem, &map, GST_MAP_WRITE);
+  while (read < src->ra_block_size && (res =
+          g_input_stream_read (src->stream, map.data + read,
+              src->ra_block_size - read, src->ra_cancel, err)) > 0) {
+    read += res;
+    src->position += res;
+  }
+  gst_memory_unmap (mem, &map);
+
+  if (res < 0 || read == 0) {
+    gst_memory_unref (mem);
+    goto done;
+  }
+
+  gst_memory_resize (mem, 0, read);
+  block = gst_buffer_new ();
+  gst_buffer_append_memory (block, mem);
+  GST_BUFFER_OFFSET (block) = offset;
+  GST_BUFFER_OFFSET_END (block) = offset + read;
+
+done:
+  g_mutex_unlock (&src->stream_lock);
+
+  return block;
+}
+
+/* Called with ra_lock. If @touch is set, the block is moved to the front
+ * of the LRU list */
+static GstBuffer *
+gst_gio_base_src_find_block (GstGioBaseSrc * src, guint64 offset,
+    gboolean touch)
+{
+  GList *l;
+
+  for (l = src->ra_cache.head; l; l = l->next) {
+    GstBuffer *block = l->data;
+
+    if (GST_BUFFER_OFFSET (block) == offset) {
+      if (touch && l != src->ra_cache.head) {
+        g_queue_unlink (&src->ra_cache, l);
+        g_queue_push_head_link (&src->ra_cache, l);
+      }
+      return block;
+    }
+  }
+
+  return NULL;
+}
+
+/* Called with ra_lock */
+static void
+gst_gio_base_src_insert_block (GstGioBaseSrc * src, GstBuffer * block)
+{
+  if (gst_gio_base_src_find_block (src, GST_BUFFER_OFFSET (block), FALSE)) {
+    gst_buffer_unref (block);
+    return;
+  }
+
+  g_queue_push_head (&src->ra_cache, block);
+  while (g_queue_get_length (&src->ra_cache) > src->ra_n_blocks)
+    gst_buffer_unref (g_queue_pop_tail (&src->ra_cache));
+}
+
+static gpointer
+gst_gio_base_src_read_ahead_loop (GstGioBaseSrc * src)
+{
+  g_mutex_lock (&src->ra_lock);
+  while (src->ra_running) {
+    GstBuffer *block;
+    GError *err = NULL;
+    guint64 offset;
+    gboolean prefetch;
+
+    if (src->ra_request != GST_BUFFER_OFFSET_NONE) {
+      offset = src->ra_request;
+      prefetch = FALSE;
+    } else if (src->ra_next != GST_BUFFER_OFFSET_NONE
+        && src->ra_next < src->ra_window_end && src->ra_next < src->ra_eos) {
+      offset = src->ra_next;
+      prefetch = TRUE;
+
+      if (gst_gio_base_src_find_block (src, offset, FALSE)) {
+        src->ra_next += src->ra_block_size;
+        continue;
+      }
+    } else {
+      g_cond_wait (&src->ra_cond, &src->ra_lock);
+      continue;
+    }
+
+    GST_LOG_OBJECT (src, "%s block at offset %" G_GUINT64_FORMAT,
+        prefetch ? "Prefetching" : "Reading", offset);
+
+    g_mutex_unlock (&src->ra_lock);
+    block = gst_gio_base_src_read_block (src, offset, &err);
+    g_mutex_lock (&src->ra_lock);
+
+    if (block) {
+      if (GST_BUFFER_OFFSET_END (block) < offset + src->ra_block_size)
+        src->ra_eos = GST_BUFFER_OFFSET_END (block);
+      gst_gio_base_src_insert_block (src, block);
+    } else if (err == NULL) {
+      src->ra_eos = MIN (src->ra_eos, offset);
+    }
+
+    if (prefetch) {
+      if (err) {
+        /* don't fail on data nobody asked for yet, create() will try again
+         * once it actually needs it */
+        GST_DEBUG_OBJECT (src, "Prefetching failed: %s", err->message);
+        g_clear_error (&err);
+        src->ra_next = GST_BUFFER_OFFSET_NONE;
+      } else if (src->ra_next == offset) {
+        src->ra_next += src->ra_block_size;
+      }
+    } else {
+      if (src->ra_request == offset)
+        src->ra_request = GST_BUFFER_OFFSET_NONE;
+      g_clear_error (&src->ra_error);
+      src->ra_error = err;
+    }
+
+    g_cond_broadcast (&src->ra_cond);
+  }
+  g_mutex_unlock (&src->ra_lock);
+
+  return NULL;
+}
+
+static void
+gst_gio_base_src_stop_read_ahead (GstGioBaseSrc * src)
+{
+  g_mutex_lock (&src->ra_lock);
+  src->ra_running = FALSE;
+  g_cond_broadcast (&src->ra_cond);
+  g_mutex_unlock (&src->ra_lock);
+
+  if (src->ra_thread) {
+    g_cancellable_cancel (src->ra_cancel);
+    g_thread_join (src->ra_thread);
+    src->ra_thread = NULL;
+    g_object_unref (src->ra_cancel);
+    src->ra_cancel = NULL;
+  }
+
+  g_queue_foreach (&src->ra_cache, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&src->ra_cache);
+  g_clear_error (&src->ra_error);
+}
+
+static GstFlowReturn
+gst_gio_base_src_create_read_ahead (GstGioBaseSrc * src, guint64 offset,
+    guint size, GstBuffer ** buf_return)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *buf;
+  guint64 pos, end, next;
+
+  g_mutex_lock (&src->ra_lock);
+
+  if (G_UNLIKELY (src->ra_thread == NULL)) {
+    GError *err = NULL;
+
+    GST_DEBUG_OBJECT (src, "Starting read-ahead thread with %u blocks of %u "
+        "bytes", src->ra_n_blocks, src->ra_block_size);
+
+    src->ra_cancel = g_cancellable_new ();
+    src->ra_running = TRUE;
+    src->ra_thread = g_thread_try_new ("gio-read-ahead",
+        (GThreadFunc) gst_gio_base_src_read_ahead_loop, src, &err);
+    if (src->ra_thread == NULL) {
+      src->ra_running = FALSE;
+      g_clear_object (&src->ra_cancel);
+      g_mutex_unlock (&src->ra_lock);
+      GST_ELEMENT_ERROR (src, RESOURCE, FAILED, (NULL),
+          ("Could not start read-ahead thread: %s", err->message));
+      g_clear_error (&err);
+      return GST_FLOW_ERROR;
+    }
+  }
+
+  buf = gst_buffer_new ();
+  pos = offset;
+  end = offset + size;
+
+  while (pos < end && pos < src->ra_eos) {
+    guint64 block_offset = pos - pos % src->ra_block_size;
+    GstBuffer *block;
+    guint64 copy_end;
+
+    if (G_UNLIKELY (src->ra_flushing)) {
+      ret = GST_FLOW_FLUSHING;
+      break;
+    }
+
+    block = gst_gio_base_src_find_block (src, block_offset, TRUE);
+    if (block == NULL) {
+      if (G_UNLIKELY (src->ra_error))
+        goto read_error;
+
+      src->ra_request = block_offset;
+      g_cond_broadcast (&src->ra_cond);
+      g_cond_wait (&src->ra_cond, &src->ra_lock);
+      continue;
+    }
+
+    copy_end = MIN (end, GST_BUFFER_OFFSET_END (block));
+    GST_LOG_OBJECT (src, "Taking %" G_GUINT64_FORMAT " bytes from block at %"
+        G_GUINT64_FORMAT, copy_end - pos, block_offset);
+    gst_buffer_copy_into (buf, block, GST_BUFFER_COPY_MEMORY,
+        pos - block_offset, copy_end - pos);
+    pos = copy_end;
+  }
+
+  /* move the prefetch window to follow the reader. If it jumped somewhere
+   * else, start prefetching from there. The window is at most half the cache
+   * so that prefetching never evicts the blocks create() is waiting for */
+  next = pos - pos % src->ra_block_size + src->ra_block_size;
+  src->ra_window_end = next + (src->ra_n_blocks / 2) * src->ra_block_size;
+  if (src->ra_next == GST_BUFFER_OFFSET_NONE || src->ra_next < next
+      || src->ra_next >= src->ra_window_end)
+    src->ra_next = next;
+  g_cond_broadcast (&src->ra_cond);
+
+  g_mutex_unlock (&src->ra_lock);
+
+  if (ret != GST_FLOW_OK) {
+    gst_buffer_unref (buf);
+    return ret;
+  }
+
+  if (pos == offset) {
+    GST_DEBUG_OBJECT (src, "EOS at offset %" G_GUINT64_FORMAT, offset);
+    gst_buffer_unref (buf);
+    return GST_FLOW_EOS;
+  }
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = pos;
+
+  *buf_return = buf;
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+read_error:
+  {
+    GError *err = src->ra_error;
+
+    src->ra_error = NULL;
+    g_mutex_unlock (&src->ra_lock);
+    gst_buffer_unref (buf);
+
+    if (GST_GIO_ERROR_MATCHES (err, NOT_SUPPORTED)) {
+      GST_DEBUG_OBJECT (src, "Can't read at offset %" G_GUINT64_FORMAT ": %s",
+          offset, err->message);
+      g_clear_error (&err);
+      return GST_FLOW_NOT_SUPPORTED;
+    }
+
+    if (!gst_gio_error (src, "g_input_stream_read", &err, &ret)) {
+      GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+          ("Could not read from stream: %s", err->message));
+      g_clear_error (&err);
+    }
+    return ret;
+  }
+}
+
 static GstFlowReturn
 gst_gio_base_src_create (GstBaseSrc * base_src, guint64 offset, guint size,
     GstBuffer ** buf_return)
@@ -301,6 +749,9 @@ gst_gio_base_src_create (GstBaseSrc * base_src, guint64 offset, guint size,
 
   g_return_val_if_fail (G_IS_INPUT_STREAM (src->stream), GST_FLOW_ERROR);
 
+  if (src->ra_n_blocks > 0)
+    return gst_gio_base_src_create_read_ahead (src, offset, size, buf_return);
+
   /* If we have the requested part in our cache take a subbuffer of that,
    * otherwise fill the cache again with at least 4096 bytes from the
    * requested offset and return a subbuffer of that.
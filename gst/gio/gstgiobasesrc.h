@@ -55,6 +55,28 @@ struct _GstGioBaseSrc
   /* < private > */
   GInputStream *stream;
   GstBuffer *cache;
+
+  /* properties */
+  guint read_ahead_block_size;
+  guint read_ahead_blocks;
+
+  /* read-ahead state, protected by ra_lock. The stream itself and position
+   * are protected by stream_lock while the read-ahead thread is running */
+  GMutex stream_lock;
+  GMutex ra_lock;
+  GCond ra_cond;
+  GThread *ra_thread;
+  GCancellable *ra_cancel;
+  gboolean ra_running;
+  gboolean ra_flushing;
+  guint ra_block_size;
+  guint ra_n_blocks;
+  GQueue ra_cache;              /* blocks, most recently used first */
+  guint64 ra_request;           /* block wanted by create() */
+  guint64 ra_next;              /* next block to prefetch */
+  guint64 ra_window_end;        /* don't prefetch at or after this offset */
+  guint64 ra_eos;               /* end of the stream, once known */
+  GError *ra_error;             /* error reading the requested block */
 };
 
 struct _GstGioBaseSrcClass 
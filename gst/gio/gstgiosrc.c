@@ -58,6 +58,11 @@
  * ]|
  *  The above pipeline will read and decode and play an mp3 file from a
  * SAMBA server.
+ * |[
+ * gst-launch-1.0 -v giosrc location=file:///home/joe/movie.mp4 use-mmap=true ! qtdemux ! fakesink
+ * ]|
+ *  The above pipeline memory-maps a local file and hands out slices of the
+ * mapping instead of copying the data into newly allocated buffers.
  *
  */
 
@@ -76,6 +81,14 @@
 #include "gstgiosrc.h"
 #include <string.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <errno.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_gio_src_debug);
 #define GST_CAT_DEFAULT gst_gio_src_debug
 
@@ -83,9 +96,12 @@ enum
 {
   PROP_0,
   PROP_LOCATION,
-  PROP_FILE
+  PROP_FILE,
+  PROP_USE_MMAP
 };
 
+#define DEFAULT_USE_MMAP FALSE
+
 #define gst_gio_src_parent_class parent_class
 G_DEFINE_TYPE_WITH_CODE (GstGioSrc, gst_gio_src,
     GST_TYPE_GIO_BASE_SRC, gst_gio_uri_handler_do_init (g_define_type_id));
@@ -100,6 +116,9 @@ static void gst_gio_src_get_property (GObject * object, guint prop_id,
 static GInputStream *gst_gio_src_get_stream (GstGioBaseSrc * bsrc);
 
 static gboolean gst_gio_src_query (GstBaseSrc * base_src, GstQuery * query);
+static gboolean gst_gio_src_stop (GstBaseSrc * base_src);
+static GstFlowReturn gst_gio_src_create (GstBaseSrc * base_src,
+    guint64 offset, guint size, GstBuffer ** buf);
 
 static void
 gst_gio_src_class_init (GstGioSrcClass * klass)
@@ -128,6 +147,22 @@ gst_gio_src_class_init (GstGioSrcClass * klass)
       g_param_spec_object ("file", "File", "GFile to read from",
           G_TYPE_FILE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstGioSrc:use-mmap:
+   *
+   * Memory-map local files and output read-only slices of the mapping
+   * instead of copying the data into newly allocated buffers. Locations that
+   * are not available as a local path are read normally.
+   *
+   * The file must not be truncated while it is being read.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Memory-map local files instead of reading them", DEFAULT_USE_MMAP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class, "GIO source",
       "Source/File",
       "Read from any GIO-supported location",
@@ -135,6 +170,8 @@ gst_gio_src_class_init (GstGioSrcClass * klass)
       "Sebastian Dröge <sebastian.droege@collabora.co.uk>");
 
   gstbasesrc_class->query = GST_DEBUG_FUNCPTR (gst_gio_src_query);
+  gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_gio_src_stop);
+  gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_gio_src_create);
 
   gstgiobasesrc_class->get_stream = GST_DEBUG_FUNCPTR (gst_gio_src_get_stream);
   gstgiobasesrc_class->close_on_stop = TRUE;
@@ -143,6 +180,7 @@ gst_gio_src_class_init (GstGioSrcClass * klass)
 static void
 gst_gio_src_init (GstGioSrc * src)
 {
+  src->use_mmap = DEFAULT_USE_MMAP;
 }
 
 static void
@@ -207,6 +245,11 @@ gst_gio_src_set_property (GObject * object, guint prop_id,
 
       src->file = g_value_dup_object (value);
 
+      GST_OBJECT_UNLOCK (GST_OBJECT (src));
+      break;
+    case PROP_USE_MMAP:
+      GST_OBJECT_LOCK (GST_OBJECT (src));
+      src->use_mmap = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (GST_OBJECT (src));
       break;
     default:
@@ -241,6 +284,11 @@ gst_gio_src_get_property (GObject * object, guint prop_id,
       g_value_set_object (value, src->file);
       GST_OBJECT_UNLOCK (GST_OBJECT (src));
       break;
+    case PROP_USE_MMAP:
+      GST_OBJECT_LOCK (GST_OBJECT (src));
+      g_value_set_boolean (value, src->use_mmap);
+      GST_OBJECT_UNLOCK (GST_OBJECT (src));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -297,6 +345,118 @@ gst_gio_src_query (GstBaseSrc * base_src, GstQuery * query)
   return res;
 }
 
+static gboolean
+gst_gio_src_stop (GstBaseSrc * base_src)
+{
+  GstGioSrc *src = GST_GIO_SRC (base_src);
+
+  if (src->mapped_file) {
+    /* buffers still referencing the mapping keep it alive */
+    g_mapped_file_unref (src->mapped_file);
+    src->mapped_file = NULL;
+  }
+
+  return GST_CALL_PARENT_WITH_DEFAULT (GST_BASE_SRC_CLASS, stop, (base_src),
+      TRUE);
+}
+
+/* Try to memory-map the file if it is available as a local path */
+static void
+gst_gio_src_map_file (GstGioSrc * src)
+{
+  GError *err = NULL;
+  gchar *path;
+
+  path = g_file_get_path (src->file);
+  if (path == NULL) {
+    GST_DEBUG_OBJECT (src, "not a local file, reading normally");
+    return;
+  }
+
+  src->mapped_file = g_mapped_file_new (path, FALSE, &err);
+  if (src->mapped_file == NULL) {
+    GST_WARNING_OBJECT (src, "could not map %s, reading normally: %s", path,
+        err->message);
+    g_clear_error (&err);
+  } else if (g_mapped_file_get_length (src->mapped_file) == 0) {
+    /* empty files don't have a mapping */
+    g_mapped_file_unref (src->mapped_file);
+    src->mapped_file = NULL;
+  } else {
+    GST_DEBUG_OBJECT (src, "mapped %s, %" G_GSIZE_FORMAT " bytes", path,
+        g_mapped_file_get_length (src->mapped_file));
+
+#if defined (HAVE_MMAP) && defined (MADV_SEQUENTIAL)
+    if (madvise (g_mapped_file_get_contents (src->mapped_file),
+            g_mapped_file_get_length (src->mapped_file), MADV_SEQUENTIAL) < 0)
+      GST_DEBUG_OBJECT (src, "madvise failed: %s", g_strerror (errno));
+#endif
+  }
+  g_free (path);
+
+#if defined (HAVE_UNISTD_H) && defined (_SC_PAGESIZE)
+  src->pagesize = sysconf (_SC_PAGESIZE);
+#else
+  src->pagesize = 4096;
+#endif
+}
+
+static GstFlowReturn
+gst_gio_src_create (GstBaseSrc * base_src, guint64 offset, guint size,
+    GstBuffer ** buf_return)
+{
+  GstGioSrc *src = GST_GIO_SRC (base_src);
+  guint8 *data;
+  gsize length;
+  GstBuffer *buf;
+
+  if (src->mapped_file == NULL)
+    return GST_CALL_PARENT_WITH_DEFAULT (GST_BASE_SRC_CLASS, create,
+        (base_src, offset, size, buf_return), GST_FLOW_NOT_SUPPORTED);
+
+  data = (guint8 *) g_mapped_file_get_contents (src->mapped_file);
+  length = g_mapped_file_get_length (src->mapped_file);
+
+  if (G_UNLIKELY (offset >= length)) {
+    GST_DEBUG_OBJECT (src, "EOS, offset %" G_GUINT64_FORMAT, offset);
+    return GST_FLOW_EOS;
+  }
+
+  size = MIN (size, length - offset);
+
+  GST_LOG_OBJECT (src, "Creating buffer from mapping: offset %"
+      G_GUINT64_FORMAT " length %u", offset, size);
+
+#if defined (HAVE_MMAP) && defined (MADV_WILLNEED)
+  /* let the kernel start reading the range following this one */
+  if (offset + 2 * size <= length) {
+    gsize start = (offset + size) & ~(src->pagesize - 1);
+
+    madvise (data + start, offset + 2 * size - start, MADV_WILLNEED);
+  }
+#endif
+
+  if (*buf_return != NULL) {
+    /* the caller provided a buffer, we have to copy into that */
+    buf = *buf_return;
+    gst_buffer_fill (buf, 0, data + offset, size);
+    gst_buffer_set_size (buf, size);
+  } else {
+    buf = gst_buffer_new ();
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, length,
+            offset, size, g_mapped_file_ref (src->mapped_file),
+            (GDestroyNotify) g_mapped_file_unref));
+  }
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + size;
+
+  *buf_return = buf;
+
+  return GST_FLOW_OK;
+}
+
 static GInputStream *
 gst_gio_src_get_stream (GstGioBaseSrc * bsrc)
 {
@@ -346,5 +506,8 @@ gst_gio_src_get_stream (GstGioBaseSrc * bsrc)
   GST_DEBUG_OBJECT (src, "opened location %s", uri);
   g_free (uri);
 
+  if (src->use_mmap)
+    gst_gio_src_map_file (src);
+
   return stream;
 }
@@ -54,6 +54,10 @@ struct _GstGioSrc
   
   /*< private >*/
   GFile *file;
+
+  gboolean use_mmap;
+  GMappedFile *mapped_file;
+  gsize pagesize;
 };
 
 struct _GstGioSrcClass 
@@ -165,6 +165,7 @@ struct _GstDecodeBin
   GMutex factories_lock;
   guint32 factories_cookie;     /* Cookie from last time when factories was updated */
   GList *factories;             /* factories we can use for selecting elements */
+  gchar *factories_id;          /* identifies factories in the filter cache */
 
   GMutex subtitle_lock;         /* Protects changes to subtitles and encoding */
   GList *subtitles;             /* List of elements with subtitle-encoding,
@@ -1040,6 +1041,8 @@ gst_decode_bin_update_factories_list (GstDecodeBin * dbin)
         g_list_sort (dbin->factories,
         gst_playback_utils_compare_factories_func);
     dbin->factories_cookie = cookie;
+    g_free (dbin->factories_id);
+    dbin->factories_id = gst_playback_utils_get_factories_id (dbin->factories);
   }
 }
 
@@ -1118,6 +1121,8 @@ gst_decode_bin_dispose (GObject * object)
   if (decode_bin->factories)
     gst_plugin_feature_list_free (decode_bin->factories);
   decode_bin->factories = NULL;
+  g_free (decode_bin->factories_id);
+  decode_bin->factories_id = NULL;
 
   if (decode_bin->decode_chain)
     gst_decode_chain_free (decode_bin->decode_chain);
@@ -1381,9 +1386,8 @@ gst_decode_bin_autoplug_factories (GstElement * element, GstPad * pad,
   /* return all compatible factories for caps */
   g_mutex_lock (&dbin->factories_lock);
   gst_decode_bin_update_factories_list (dbin);
-  list =
-      gst_element_factory_list_filter (dbin->factories, caps, GST_PAD_SINK,
-      gst_caps_is_fixed (caps));
+  list = gst_playback_utils_filter_factories (dbin->factories_id,
+      dbin->factories_cookie, dbin->factories, caps, gst_caps_is_fixed (caps));
   g_mutex_unlock (&dbin->factories_lock);
 
   result = g_value_array_new (g_list_length (list));
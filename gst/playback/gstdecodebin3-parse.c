@@ -547,6 +547,8 @@ parsebin_pad_added_cb (GstElement * demux, GstPad * pad, DecodebinInput * input)
   GST_DEBUG_OBJECT (dbin, "New pad %s:%s (input:%p)", GST_DEBUG_PAD_NAME (pad),
       input);
 
+  startup_mark (dbin, STARTUP_STAGE_STREAM);
+
   ppad = g_new0 (PendingPad, 1);
   ppad->dbin = dbin;
   ppad->input = input;
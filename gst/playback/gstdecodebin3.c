@@ -32,6 +32,7 @@
 
 #include "gstplayback.h"
 #include "gstplay-enum.h"
+#include "gstplaybackutils.h"
 #include "gstrawcaps.h"
 
 /**
@@ -203,6 +204,17 @@ typedef struct _DecodebinInputStream DecodebinInputStream;
 typedef struct _DecodebinInput DecodebinInput;
 typedef struct _DecodebinOutputStream DecodebinOutputStream;
 
+/* Stages of the startup, in the order in which they are reached */
+typedef enum
+{
+  STARTUP_STAGE_START,          /* READY to PAUSED */
+  STARTUP_STAGE_CAPS,           /* Container caps known */
+  STARTUP_STAGE_STREAM,         /* First stream out of parsebin */
+  STARTUP_STAGE_DECODER,        /* First decoder created */
+  STARTUP_STAGE_OUTPUT,         /* First source pad exposed */
+  STARTUP_N_STAGES
+} DecodebinStartupStage;
+
 struct _GstDecodebin3
 {
   GstBin bin;
@@ -259,12 +271,24 @@ struct _GstDecodebin3
   GList *decoder_factories;
   /* DECODABLE but not DECODER factories */
   GList *decodable_factories;
+  /* Identifiers of the above lists in the factory filter cache */
+  gchar *decoder_factories_id;
+  gchar *decodable_factories_id;
 
   /* counters for pads */
   guint32 apadcount, vpadcount, tpadcount, opadcount;
 
   /* Properties */
   GstCaps *caps;
+  gboolean fast_start;
+
+  /* Startup tracking, protected by the object lock. Timestamps at which
+   * the stages were reached since the last READY to PAUSED transition */
+  GstClockTime startup_ts[STARTUP_N_STAGES];
+  gboolean startup_posted;
+  gboolean preload_started;
+  /* Time spent preloading elements in fast-start mode */
+  GstClockTime preload_time;
 };
 
 struct _GstDecodebin3Class
@@ -371,9 +395,15 @@ typedef struct _PendingPad
 enum
 {
   PROP_0,
-  PROP_CAPS
+  PROP_CAPS,
+  PROP_FAST_START
 };
 
+#define DEFAULT_FAST_START FALSE
+
+/* Maximum number of decoders preloaded in fast-start mode */
+#define FAST_START_MAX_DECODERS 8
+
 /* signals */
 enum
 {
@@ -485,6 +515,9 @@ static gboolean gst_decodebin3_send_event (GstElement * element,
     GstEvent * event);
 
 static void gst_decode_bin_update_factories_list (GstDecodebin3 * dbin);
+static void startup_reset (GstDecodebin3 * dbin);
+static void startup_mark (GstDecodebin3 * dbin, DecodebinStartupStage stage);
+static void startup_post (GstDecodebin3 * dbin);
 #if 0
 static gboolean have_factory (GstDecodebin3 * dbin, GstCaps * caps,
     GstElementFactoryListType ftype);
@@ -551,6 +584,29 @@ gst_decodebin3_class_init (GstDecodebin3Class * klass)
           "The caps on which to stop decoding. (NULL = default)",
           GST_TYPE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDecodebin3:fast-start:
+   *
+   * Reduces the time to the first decoded output. As soon as the container
+   * caps are known, the demuxer or parser that will handle them and the
+   * decoders for the streams it can output are looked up and their plugins
+   * loaded on a separate thread, while the data is still being typefound
+   * and demuxed.
+   *
+   * In fast-start mode, decodebin3 also posts a "decodebin3-startup" element
+   * message once its first source pad is exposed. It contains the time spent
+   * in each stage of the startup as #GstClockTime fields: "typefind",
+   * "demux", "decoder-setup", "output" and their sum "total", and the
+   * "preload" time spent on the separate thread.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_klass, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Preload the elements likely needed as soon as the container "
+          "caps are known", DEFAULT_FAST_START,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* FIXME : ADD SIGNALS ! */
   /**
    * GstDecodebin3::select-stream
@@ -628,6 +684,8 @@ gst_decodebin3_init (GstDecodebin3 * dbin)
   g_mutex_init (&dbin->input_lock);
 
   dbin->caps = gst_static_caps_get (&default_raw_caps);
+  dbin->fast_start = DEFAULT_FAST_START;
+  startup_reset (dbin);
 
   GST_OBJECT_FLAG_SET (dbin, GST_BIN_FLAG_STREAMS_AWARE);
 }
@@ -644,6 +702,8 @@ gst_decodebin3_dispose (GObject * object)
     g_list_free (dbin->decoder_factories);
   if (dbin->decodable_factories)
     g_list_free (dbin->decodable_factories);
+  g_free (dbin->decoder_factories_id);
+  g_free (dbin->decodable_factories_id);
   g_list_free_full (dbin->requested_selection, g_free);
   g_list_free (dbin->active_selection);
   g_list_free (dbin->to_activate);
@@ -679,6 +739,11 @@ gst_decodebin3_set_property (GObject * object, guint prop_id,
       dbin->caps = g_value_dup_boxed (value);
       GST_OBJECT_UNLOCK (dbin);
       break;
+    case PROP_FAST_START:
+      GST_OBJECT_LOCK (dbin);
+      dbin->fast_start = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (dbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -698,18 +763,216 @@ gst_decodebin3_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_boxed (value, dbin->caps);
       GST_OBJECT_UNLOCK (dbin);
       break;
+    case PROP_FAST_START:
+      GST_OBJECT_LOCK (dbin);
+      g_value_set_boolean (value, dbin->fast_start);
+      GST_OBJECT_UNLOCK (dbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* Call with the object lock taken */
+static void
+startup_reset (GstDecodebin3 * dbin)
+{
+  guint i;
+
+  for (i = 0; i < STARTUP_N_STAGES; i++)
+    dbin->startup_ts[i] = GST_CLOCK_TIME_NONE;
+  dbin->startup_posted = FALSE;
+  dbin->preload_started = FALSE;
+  dbin->preload_time = GST_CLOCK_TIME_NONE;
+}
+
+/* Records the time at which @stage was first reached */
+static void
+startup_mark (GstDecodebin3 * dbin, DecodebinStartupStage stage)
+{
+  GST_OBJECT_LOCK (dbin);
+  if (!GST_CLOCK_TIME_IS_VALID (dbin->startup_ts[stage]))
+    dbin->startup_ts[stage] = gst_util_get_timestamp ();
+  GST_OBJECT_UNLOCK (dbin);
+}
+
+/* Posts the startup latency breakdown in fast-start mode when the first
+ * source pad got exposed. Stages that were skipped (e.g. no decoder is needed
+ * for raw streams) take no time */
+static void
+startup_post (GstDecodebin3 * dbin)
+{
+  static const gchar *stage_names[STARTUP_N_STAGES] = {
+    NULL, "typefind", "demux", "decoder-setup", "output"
+  };
+  GstClockTime ts[STARTUP_N_STAGES], preload_time, prev;
+  GstStructure *s;
+  guint i;
+
+  GST_OBJECT_LOCK (dbin);
+  if (!dbin->fast_start || dbin->startup_posted
+      || !GST_CLOCK_TIME_IS_VALID (dbin->startup_ts[STARTUP_STAGE_START])) {
+    GST_OBJECT_UNLOCK (dbin);
+    return;
+  }
+  dbin->startup_posted = TRUE;
+  if (!GST_CLOCK_TIME_IS_VALID (dbin->startup_ts[STARTUP_STAGE_OUTPUT]))
+    dbin->startup_ts[STARTUP_STAGE_OUTPUT] = gst_util_get_timestamp ();
+  for (i = 0; i < STARTUP_N_STAGES; i++)
+    ts[i] = dbin->startup_ts[i];
+  preload_time = dbin->preload_time;
+  GST_OBJECT_UNLOCK (dbin);
+
+  s = gst_structure_new_empty ("decodebin3-startup");
+
+  prev = ts[STARTUP_STAGE_START];
+  for (i = STARTUP_STAGE_CAPS; i < STARTUP_N_STAGES; i++) {
+    if (!GST_CLOCK_TIME_IS_VALID (ts[i]) || ts[i] < prev)
+      ts[i] = prev;
+    gst_structure_set (s, stage_names[i], G_TYPE_UINT64, ts[i] - prev, NULL);
+    prev = ts[i];
+  }
+  gst_structure_set (s, "total", G_TYPE_UINT64,
+      ts[STARTUP_STAGE_OUTPUT] - ts[STARTUP_STAGE_START], NULL);
+  if (GST_CLOCK_TIME_IS_VALID (preload_time))
+    gst_structure_set (s, "preload", G_TYPE_UINT64, preload_time, NULL);
+
+  GST_INFO_OBJECT (dbin, "Startup: %" GST_PTR_FORMAT, s);
+
+  gst_element_post_message (GST_ELEMENT_CAST (dbin),
+      gst_message_new_element (GST_OBJECT_CAST (dbin), s));
+}
+
+/* Loads the plugin of @factory and initializes the element class, which is
+ * what makes creating the first element of a factory expensive */
+static gboolean
+preload_factory (GstElementFactory * factory)
+{
+  GstPluginFeature *loaded;
+  GType type;
+
+  loaded = gst_plugin_feature_load (GST_PLUGIN_FEATURE_CAST (factory));
+  if (loaded == NULL)
+    return FALSE;
+
+  type = gst_element_factory_get_element_type ((GstElementFactory *) loaded);
+  if (type != G_TYPE_INVALID)
+    g_type_class_unref (g_type_class_ref (type));
+
+  GST_DEBUG ("Preloaded %s", GST_OBJECT_NAME (loaded));
+  gst_object_unref (loaded);
+
+  return TRUE;
+}
+
+/* Preloads the first decoder for each structure of @caps. Returns the
+ * updated list of preloaded decoders */
+static GList *
+preload_decoders (GList * decoders, GstCaps * caps, GList * preloaded)
+{
+  guint i, n = gst_caps_get_size (caps);
+
+  for (i = 0; i < n; i++) {
+    GstElementFactory *factory;
+    GstCaps *stream_caps;
+    GList *res;
+
+    if (g_list_length (preloaded) >= FAST_START_MAX_DECODERS)
+      break;
+
+    stream_caps = gst_caps_copy_nth (caps, i);
+    res = gst_element_factory_list_filter (decoders, stream_caps,
+        GST_PAD_SINK, FALSE);
+    gst_caps_unref (stream_caps);
+    if (res == NULL)
+      continue;
+
+    factory = res->data;
+    if (!g_list_find (preloaded, factory) && preload_factory (factory))
+      preloaded = g_list_prepend (preloaded, factory);
+    gst_plugin_feature_list_free (res);
+  }
+
+  return preloaded;
+}
+
+/* Runs on the element thread pool in fast-start mode once the container
+ * caps are known. Preloads the demuxer or parser parsebin will plug first
+ * for @caps and the decoders for what it can output, while the streaming
+ * thread is still typefinding and demuxing */
+static void
+preload_elements (GstDecodebin3 * dbin, GstCaps * caps)
+{
+  GList *demuxers, *decoders, *preloaded = NULL;
+  GstClockTime start = gst_util_get_timestamp (), elapsed;
+
+  g_mutex_lock (&dbin->factories_lock);
+  gst_decode_bin_update_factories_list (dbin);
+  demuxers = gst_playback_utils_filter_factories (dbin->decodable_factories_id,
+      dbin->factories_cookie, dbin->decodable_factories, caps, FALSE);
+  decoders = gst_plugin_feature_list_copy (dbin->decoder_factories);
+  g_mutex_unlock (&dbin->factories_lock);
+
+  /* Elementary streams can go straight to a decoder */
+  preloaded = preload_decoders (decoders, caps, preloaded);
+
+  if (demuxers && preload_factory (demuxers->data)) {
+    const GList *templates;
+
+    templates =
+        gst_element_factory_get_static_pad_templates (demuxers->data);
+    for (; templates; templates = templates->next) {
+      GstStaticPadTemplate *templ = templates->data;
+      GstCaps *templ_caps;
+
+      if (templ->direction != GST_PAD_SRC)
+        continue;
+
+      templ_caps = gst_static_pad_template_get_caps (templ);
+      if (!gst_caps_is_any (templ_caps))
+        preloaded = preload_decoders (decoders, templ_caps, preloaded);
+      gst_caps_unref (templ_caps);
+    }
+  }
+
+  elapsed = gst_util_get_timestamp () - start;
+  GST_DEBUG_OBJECT (dbin, "Preloaded %u decoders for %" GST_PTR_FORMAT
+      " in %" GST_TIME_FORMAT, g_list_length (preloaded), caps,
+      GST_TIME_ARGS (elapsed));
+
+  GST_OBJECT_LOCK (dbin);
+  dbin->preload_time = elapsed;
+  GST_OBJECT_UNLOCK (dbin);
+
+  g_list_free (preloaded);
+  gst_plugin_feature_list_free (decoders);
+  gst_plugin_feature_list_free (demuxers);
+}
+
 static gboolean
 parsebin_autoplug_continue_cb (GstElement * parsebin, GstPad * pad,
     GstCaps * caps, GstDecodebin3 * dbin)
 {
+  gboolean preload = FALSE;
+
   GST_DEBUG_OBJECT (pad, "caps %" GST_PTR_FORMAT, caps);
 
+  /* The first caps are the ones found by typefind */
+  GST_OBJECT_LOCK (dbin);
+  if (!GST_CLOCK_TIME_IS_VALID (dbin->startup_ts[STARTUP_STAGE_CAPS]))
+    dbin->startup_ts[STARTUP_STAGE_CAPS] = gst_util_get_timestamp ();
+  if (dbin->fast_start && !dbin->preload_started) {
+    dbin->preload_started = TRUE;
+    preload = TRUE;
+  }
+  GST_OBJECT_UNLOCK (dbin);
+
+  if (preload)
+    gst_element_call_async (GST_ELEMENT_CAST (dbin),
+        (GstElementCallAsyncFunc) preload_elements, gst_caps_ref (caps),
+        (GDestroyNotify) gst_caps_unref);
+
   /* If it matches our target caps, expose it */
   if (gst_caps_can_intersect (caps, dbin->caps))
     return FALSE;
@@ -1045,6 +1308,12 @@ gst_decode_bin_update_factories_list (GstDecodebin3 * dbin)
         dbin->decodable_factories =
             g_list_append (dbin->decodable_factories, fact);
     }
+    g_free (dbin->decoder_factories_id);
+    dbin->decoder_factories_id =
+        gst_playback_utils_get_factories_id (dbin->decoder_factories);
+    g_free (dbin->decodable_factories_id);
+    dbin->decodable_factories_id =
+        gst_playback_utils_get_factories_id (dbin->decodable_factories);
   }
 }
 
@@ -2077,12 +2346,12 @@ create_element (GstDecodebin3 * dbin, GstStream * stream,
   caps = gst_stream_get_caps (stream);
   if (ftype == GST_ELEMENT_FACTORY_TYPE_DECODER)
     res =
-        gst_element_factory_list_filter (dbin->decoder_factories,
-        caps, GST_PAD_SINK, TRUE);
+        gst_playback_utils_filter_factories (dbin->decoder_factories_id,
+        dbin->factories_cookie, dbin->decoder_factories, caps, TRUE);
   else
     res =
-        gst_element_factory_list_filter (dbin->decodable_factories,
-        caps, GST_PAD_SINK, TRUE);
+        gst_playback_utils_filter_factories (dbin->decodable_factories_id,
+        dbin->factories_cookie, dbin->decodable_factories, caps, TRUE);
   g_mutex_unlock (&dbin->factories_lock);
 
   if (res) {
@@ -2219,6 +2488,7 @@ reconfigure_output_stream (DecodebinOutputStream * output,
       SELECTION_LOCK (dbin);
       goto cleanup;
     }
+    startup_mark (dbin, STARTUP_STAGE_DECODER);
     if (!gst_bin_add ((GstBin *) dbin, output->decoder)) {
       GST_ERROR_OBJECT (dbin, "could not add decoder to pipeline");
       goto cleanup;
@@ -2250,6 +2520,7 @@ reconfigure_output_stream (DecodebinOutputStream * output,
   if (output->src_exposed == FALSE) {
     output->src_exposed = TRUE;
     gst_element_add_pad (GST_ELEMENT_CAST (dbin), output->src_pad);
+    startup_post (dbin);
   }
 
   if (output->decoder)
@@ -2870,6 +3141,12 @@ gst_decodebin3_change_state (GstElement * element, GstStateChange transition)
 
   /* Upwards */
   switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      GST_OBJECT_LOCK (dbin);
+      startup_reset (dbin);
+      dbin->startup_ts[STARTUP_STAGE_START] = gst_util_get_timestamp ();
+      GST_OBJECT_UNLOCK (dbin);
+      break;
     default:
       break;
   }
@@ -162,6 +162,7 @@ struct _GstParseBin
   GMutex factories_lock;
   guint32 factories_cookie;     /* Cookie from last time when factories was updated */
   GList *factories;             /* factories we can use for selecting elements */
+  gchar *factories_id;          /* identifies factories in the filter cache */
 
   GMutex subtitle_lock;         /* Protects changes to subtitles and encoding */
   GList *subtitles;             /* List of elements with subtitle-encoding,
@@ -885,6 +886,9 @@ gst_parse_bin_update_factories_list (GstParseBin * parsebin)
         g_list_sort (parsebin->factories,
         gst_playback_utils_compare_factories_func);
     parsebin->factories_cookie = cookie;
+    g_free (parsebin->factories_id);
+    parsebin->factories_id =
+        gst_playback_utils_get_factories_id (parsebin->factories);
   }
 }
 
@@ -955,6 +959,8 @@ gst_parse_bin_dispose (GObject * object)
   if (parse_bin->factories)
     gst_plugin_feature_list_free (parse_bin->factories);
   parse_bin->factories = NULL;
+  g_free (parse_bin->factories_id);
+  parse_bin->factories_id = NULL;
 
   if (parse_bin->parse_chain)
     gst_parse_chain_free (parse_bin->parse_chain);
@@ -1132,8 +1138,8 @@ gst_parse_bin_autoplug_factories (GstElement * element, GstPad * pad,
   /* return all compatible factories for caps */
   g_mutex_lock (&parsebin->factories_lock);
   gst_parse_bin_update_factories_list (parsebin);
-  list =
-      gst_element_factory_list_filter (parsebin->factories, caps, GST_PAD_SINK,
+  list = gst_playback_utils_filter_factories (parsebin->factories_id,
+      parsebin->factories_cookie, parsebin->factories, caps,
       gst_caps_is_fixed (caps));
   g_mutex_unlock (&parsebin->factories_lock);
 
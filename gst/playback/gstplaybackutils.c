@@ -23,6 +23,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <gst/gst.h>
 #include "gstplaybackutils.h"
 
@@ -162,3 +164,102 @@ gst_playback_utils_compare_factories_func (gconstpointer p1, gconstpointer p2)
    * and then by factory name */
   return gst_plugin_feature_rank_compare_func (p1, p2);
 }
+
+/* Process-wide cache of gst_element_factory_list_filter() results for fixed
+ * caps. Entries are keyed on an identifier of the filtered factory list,
+ * built from the names and ranks of its factories when the list is created,
+ * so that rank changes (which don't change the registry cookie) give new
+ * instances fresh results. The whole cache is flushed when the cookie changes
+ * and when it grows too large, e.g. because of caps with per-stream
+ * codec_data */
+#define FILTER_CACHE_MAX_ENTRIES 512
+
+static GMutex filter_cache_lock;
+static GHashTable *filter_cache = NULL;
+static guint32 filter_cache_cookie;
+
+/* Returns an identifier of the content of @factories: the names and ranks of
+ * its factories, in order. Call it whenever the list is (re)built and pass
+ * it to gst_playback_utils_filter_factories(). Free with g_free() */
+gchar *
+gst_playback_utils_get_factories_id (GList * factories)
+{
+  GChecksum *checksum;
+  GList *tmp;
+  gchar *id;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  for (tmp = factories; tmp; tmp = tmp->next) {
+    GstPluginFeature *feature = GST_PLUGIN_FEATURE_CAST (tmp->data);
+    const gchar *name = gst_plugin_feature_get_name (feature);
+    guint32 rank = gst_plugin_feature_get_rank (feature);
+
+    /* Include the terminating NUL to separate the names */
+    g_checksum_update (checksum, (const guchar *) name, strlen (name) + 1);
+    g_checksum_update (checksum, (const guchar *) &rank, sizeof (rank));
+  }
+  id = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return id;
+}
+
+/* Returns the factories of @factories that can sink @caps, like
+ * gst_element_factory_list_filter(). @factories_id is the identifier
+ * gst_playback_utils_get_factories_id() returned for @factories and @cookie
+ * is the registry feature list cookie it was created with. Free the result
+ * with gst_plugin_feature_list_free() */
+GList *
+gst_playback_utils_filter_factories (const gchar * factories_id,
+    guint32 cookie, GList * factories, GstCaps * caps, gboolean subsetonly)
+{
+  GList *result;
+  gchar *caps_str, *key;
+
+  if (!gst_caps_is_fixed (caps))
+    return gst_element_factory_list_filter (factories, caps, GST_PAD_SINK,
+        subsetonly);
+
+  caps_str = gst_caps_to_string (caps);
+  key = g_strdup_printf ("%s/%d/%s", factories_id, ! !subsetonly, caps_str);
+  g_free (caps_str);
+
+  g_mutex_lock (&filter_cache_lock);
+  if (filter_cache == NULL) {
+    filter_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) gst_plugin_feature_list_free);
+    filter_cache_cookie = cookie;
+  } else if (filter_cache_cookie != cookie) {
+    GST_DEBUG ("Registry changed, flushing factory filter cache");
+    g_hash_table_remove_all (filter_cache);
+    filter_cache_cookie = cookie;
+  }
+
+  if (g_hash_table_lookup_extended (filter_cache, key, NULL,
+          (gpointer *) & result)) {
+    result = gst_plugin_feature_list_copy (result);
+    g_mutex_unlock (&filter_cache_lock);
+    GST_LOG ("Cached factories for %s", key);
+    g_free (key);
+    return result;
+  }
+  g_mutex_unlock (&filter_cache_lock);
+
+  result = gst_element_factory_list_filter (factories, caps, GST_PAD_SINK,
+      subsetonly);
+
+  g_mutex_lock (&filter_cache_lock);
+  if (filter_cache_cookie == cookie) {
+    if (g_hash_table_size (filter_cache) >= FILTER_CACHE_MAX_ENTRIES) {
+      GST_DEBUG ("Factory filter cache full, flushing");
+      g_hash_table_remove_all (filter_cache);
+    }
+    g_hash_table_replace (filter_cache, key,
+        gst_plugin_feature_list_copy (result));
+    key = NULL;
+  }
+  g_mutex_unlock (&filter_cache_lock);
+  g_free (key);
+
+  return result;
+}
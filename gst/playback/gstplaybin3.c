@@ -315,6 +315,7 @@ struct _SourcePad
   GstPad *pad;                  /* The controlled pad */
   GstStreamType stream_type;    /* stream type of the controlled pad */
   gulong event_probe_id;
+  gulong buffer_probe_id;
 };
 
 /* a structure to hold the objects for decoding a uri and the subtitle uri
@@ -350,6 +351,19 @@ struct _GstSourceGroup
    * FIXME : Move this logic to uridecodebin3 later */
   gboolean pending_about_to_finish;
 
+  /* TRUE once 'about-to-finish' was emitted (or is pending) for this group,
+   * either because its input got drained or because it entered the pre-roll
+   * window. Reset by flushing seeks */
+  gboolean about_to_finish_emitted;
+
+  /* Gapless pre-roll tracking, protected by the group lock */
+  gboolean window_reached;      /* emission for the pre-roll window scheduled */
+  GstClockTime duration;        /* duration of the stream, if known */
+  GstClockTime duration_query_pos;      /* position of the last duration query */
+  gboolean is_next;             /* activated while another group was active */
+  GstClockTime ready_time;      /* when the first decoded buffer arrived */
+  GstClockTime switch_time;     /* when the group started being outputted */
+
   /* uridecodebin to handle uri and suburi */
   GstElement *uridecodebin;
 
@@ -503,6 +517,10 @@ struct _GstPlayBin3
   GSequence *velements;         /* a list of GstAVElements for video stream */
 
   guint64 ring_buffer_max_size; /* 0 means disabled */
+
+  gboolean fast_start;
+
+  GstClockTime preroll_window;  /* protected by the object lock */
 };
 
 struct _GstPlayBin3Class
@@ -539,6 +557,8 @@ struct _GstPlayBin3Class
 #define DEFAULT_BUFFER_DURATION   -1
 #define DEFAULT_BUFFER_SIZE       -1
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_FAST_START        FALSE
+#define DEFAULT_PREROLL_WINDOW    0
 
 enum
 {
@@ -570,7 +590,9 @@ enum
   PROP_AUDIO_FILTER,
   PROP_VIDEO_FILTER,
   PROP_MULTIVIEW_MODE,
-  PROP_MULTIVIEW_FLAGS
+  PROP_MULTIVIEW_FLAGS,
+  PROP_FAST_START,
+  PROP_PREROLL_WINDOW
 };
 
 /* signals */
@@ -613,6 +635,10 @@ static GstStateChangeReturn setup_next_source (GstPlayBin3 * playbin);
 
 static void gst_play_bin3_check_group_status (GstPlayBin3 * playbin);
 static void emit_about_to_finish (GstPlayBin3 * playbin);
+static void group_about_to_finish (GstPlayBin3 * playbin,
+    GstSourceGroup * group);
+static GstMessage *gapless_message_new (GstPlayBin3 * playbin,
+    GstSourceGroup * group);
 static void reconfigure_output (GstPlayBin3 * playbin);
 static void pad_removed_cb (GstElement * decodebin, GstPad * pad,
     GstSourceGroup * group);
@@ -973,6 +999,46 @@ gst_play_bin3_class_init (GstPlayBin3Class * klass)
           GST_TYPE_VIDEO_MULTIVIEW_FLAGS, GST_VIDEO_MULTIVIEW_FLAGS_NONE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPlayBin3:fast-start:
+   *
+   * Preload the demuxer and decoder elements likely needed for the next
+   * uri as soon as its container caps are known, to reduce the time to
+   * the first frame. The time spent in each startup stage is then posted as
+   * a "decodebin3-startup" element message. See #GstDecodebin3:fast-start.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_klass, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Preload the elements likely needed as soon as the container "
+          "caps are known", DEFAULT_FAST_START,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPlayBin3:preroll-window:
+   *
+   * Time before the end of the current stream at which the next uri is
+   * prepared, in nanoseconds. When the remaining duration of the current
+   * stream drops below this value, #GstPlayBin3::about-to-finish is emitted
+   * (unless it already was) and the next uri is set up right away, so that
+   * its source and decoders have produced their first decoded buffers when
+   * the current stream ends. 0 only prepares the next uri once the current
+   * input is drained.
+   *
+   * For each gapless switch a "playbin3-gapless" element message is posted,
+   * with the "uri" of the next stream and the time between its first decoded
+   * buffer and the start of its output as "ready-ahead" (a
+   * #GstClockTimeDiff, negative if it was not ready in time).
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_klass, PROP_PREROLL_WINDOW,
+      g_param_spec_uint64 ("preroll-window", "Pre-roll window",
+          "Prepare the next uri when the current one has less than this "
+          "remaining (in ns, 0 = when the input is drained)", 0, G_MAXUINT64,
+          DEFAULT_PREROLL_WINDOW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstPlayBin3::about-to-finish
    * @playbin: a #GstPlayBin3
@@ -1370,6 +1436,8 @@ gst_play_bin3_init (GstPlayBin3 * playbin)
   playbin->buffer_duration = DEFAULT_BUFFER_DURATION;
   playbin->buffer_size = DEFAULT_BUFFER_SIZE;
   playbin->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  playbin->fast_start = DEFAULT_FAST_START;
+  playbin->preroll_window = DEFAULT_PREROLL_WINDOW;
 
   playbin->force_aspect_ratio = TRUE;
 
@@ -1864,6 +1932,16 @@ gst_play_bin3_set_property (GObject * object, guint prop_id,
       playbin->multiview_flags = g_value_get_flags (value);
       GST_PLAY_BIN3_UNLOCK (playbin);
       break;
+    case PROP_FAST_START:
+      GST_PLAY_BIN3_LOCK (playbin);
+      playbin->fast_start = g_value_get_boolean (value);
+      GST_PLAY_BIN3_UNLOCK (playbin);
+      break;
+    case PROP_PREROLL_WINDOW:
+      GST_OBJECT_LOCK (playbin);
+      playbin->preroll_window = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (playbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2066,6 +2144,16 @@ gst_play_bin3_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_flags (value, playbin->multiview_flags);
       GST_OBJECT_UNLOCK (playbin);
       break;
+    case PROP_FAST_START:
+      GST_PLAY_BIN3_LOCK (playbin);
+      g_value_set_boolean (value, playbin->fast_start);
+      GST_PLAY_BIN3_UNLOCK (playbin);
+      break;
+    case PROP_PREROLL_WINDOW:
+      GST_OBJECT_LOCK (playbin);
+      g_value_set_uint64 (value, playbin->preroll_window);
+      GST_OBJECT_UNLOCK (playbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2453,7 +2541,7 @@ gst_play_bin3_handle_message (GstBin * bin, GstMessage * msg)
     GstSourceGroup *group = NULL, *other_group = NULL;
     gboolean changed = FALSE;
     guint group_id;
-    GstMessage *buffering_msg;
+    GstMessage *buffering_msg, *gapless_msg = NULL;
 
     if (!gst_message_parse_group_id (msg, &group_id)) {
       GST_ERROR_OBJECT (bin,
@@ -2490,6 +2578,12 @@ gst_play_bin3_handle_message (GstBin * bin, GstMessage * msg)
     group->playing = TRUE;
     buffering_msg = group->pending_buffering_msg;
     group->pending_buffering_msg = NULL;
+    if (changed && group->is_next
+        && !GST_CLOCK_TIME_IS_VALID (group->switch_time)) {
+      group->switch_time = gst_util_get_timestamp ();
+      if (GST_CLOCK_TIME_IS_VALID (group->ready_time))
+        gapless_msg = gapless_message_new (playbin, group);
+    }
     GST_SOURCE_GROUP_UNLOCK (group);
 
     GST_SOURCE_GROUP_LOCK (other_group);
@@ -2505,6 +2599,18 @@ gst_play_bin3_handle_message (GstBin * bin, GstMessage * msg)
     /* If there was a pending buffering message to send, do it now */
     if (buffering_msg)
       GST_BIN_CLASS (parent_class)->handle_message (bin, buffering_msg);
+    if (gapless_msg)
+      gst_element_post_message (GST_ELEMENT_CAST (playbin), gapless_msg);
+  } else if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_DURATION_CHANGED) {
+    GstSourceGroup *group;
+
+    /* Have the pre-roll window query the new duration on the next buffer */
+    group = find_source_group_owner (playbin, msg->src);
+    if (group) {
+      GST_SOURCE_GROUP_LOCK (group);
+      group->duration_query_pos = GST_CLOCK_TIME_NONE;
+      GST_SOURCE_GROUP_UNLOCK (group);
+    }
   } else if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_BUFFERING) {
     GstSourceGroup *group;
 
@@ -2745,6 +2851,22 @@ find_source_pad (GstSourceGroup * group, GstPad * target)
   return NULL;
 }
 
+/* Call with the group lock taken, once both the ready and switch times of
+ * the group are known */
+static GstMessage *
+gapless_message_new (GstPlayBin3 * playbin, GstSourceGroup * group)
+{
+  GstClockTimeDiff ahead;
+
+  ahead = GST_CLOCK_DIFF (group->ready_time, group->switch_time);
+  GST_DEBUG_OBJECT (playbin, "group %p was ready %" GST_STIME_FORMAT
+      " before the switch", group, GST_STIME_ARGS (ahead));
+
+  return gst_message_new_element (GST_OBJECT_CAST (playbin),
+      gst_structure_new ("playbin3-gapless", "uri", G_TYPE_STRING,
+          group->uri, "ready-ahead", G_TYPE_INT64, ahead, NULL));
+}
+
 static GstPadProbeReturn
 _decodebin_event_probe (GstPad * pad, GstPadProbeInfo * info, gpointer udata)
 {
@@ -2789,6 +2911,15 @@ _decodebin_event_probe (GstPad * pad, GstPadProbeInfo * info, gpointer udata)
       }
       break;
     }
+    case GST_EVENT_FLUSH_STOP:
+      /* After a flushing seek the group can get drained or enter the pre-roll
+       * window again */
+      GST_SOURCE_GROUP_LOCK (group);
+      group->about_to_finish_emitted = FALSE;
+      group->window_reached = FALSE;
+      group->duration_query_pos = GST_CLOCK_TIME_NONE;
+      GST_SOURCE_GROUP_UNLOCK (group);
+      break;
     default:
       break;
   }
@@ -2796,6 +2927,113 @@ _decodebin_event_probe (GstPad * pad, GstPadProbeInfo * info, gpointer udata)
   return ret;
 }
 
+/* Called from the element thread pool once the playing group entered the
+ * pre-roll window, so that the next group is not set up from the streaming
+ * thread */
+static void
+preroll_window_reached (GstElement * element, gpointer udata)
+{
+  GstSourceGroup *group = (GstSourceGroup *) udata;
+  GstPlayBin3 *playbin = GST_PLAY_BIN3 (element);
+  gboolean reached;
+
+  if (g_atomic_int_get (&playbin->shutdown))
+    return;
+
+  /* The group might have been flushed or deactivated in the meantime */
+  GST_SOURCE_GROUP_LOCK (group);
+  reached = group->window_reached && group->active;
+  GST_SOURCE_GROUP_UNLOCK (group);
+
+  if (reached)
+    group_about_to_finish (playbin, group);
+}
+
+/* Tracks when the first decoded buffer of a group arrives and checks if the
+ * playing group entered the pre-roll window */
+static GstPadProbeReturn
+_decodebin_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer udata)
+{
+  GstSourceGroup *group = (GstSourceGroup *) udata;
+  GstPlayBin3 *playbin = group->playbin;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClockTime window, duration, query_pos, position = GST_CLOCK_TIME_NONE;
+  GstMessage *gapless_msg = NULL;
+  gboolean check_window;
+  GstEvent *event;
+
+  GST_OBJECT_LOCK (playbin);
+  window = playbin->preroll_window;
+  GST_OBJECT_UNLOCK (playbin);
+
+  GST_SOURCE_GROUP_LOCK (group);
+  if (!GST_CLOCK_TIME_IS_VALID (group->ready_time)) {
+    group->ready_time = gst_util_get_timestamp ();
+    GST_DEBUG_OBJECT (pad, "first decoded buffer of group %p", group);
+    if (group->is_next && GST_CLOCK_TIME_IS_VALID (group->switch_time))
+      gapless_msg = gapless_message_new (playbin, group);
+  }
+  check_window = window > 0 && group->playing
+      && !group->about_to_finish_emitted && !group->window_reached;
+  duration = group->duration;
+  query_pos = group->duration_query_pos;
+  GST_SOURCE_GROUP_UNLOCK (group);
+
+  if (gapless_msg)
+    gst_element_post_message (GST_ELEMENT_CAST (playbin), gapless_msg);
+
+  if (!check_window || !GST_BUFFER_PTS_IS_VALID (buffer))
+    return GST_PAD_PROBE_OK;
+
+  event = gst_pad_get_sticky_event (pad, GST_EVENT_SEGMENT, 0);
+  if (event) {
+    const GstSegment *segment;
+
+    gst_event_parse_segment (event, &segment);
+    if (segment->format == GST_FORMAT_TIME)
+      position = gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+          GST_BUFFER_PTS (buffer));
+    gst_event_unref (event);
+  }
+  if (!GST_CLOCK_TIME_IS_VALID (position))
+    return GST_PAD_PROBE_OK;
+
+  /* The duration can change (or only become known) while playing, ask
+   * again every second of stream time */
+  if (!GST_CLOCK_TIME_IS_VALID (query_pos) || position < query_pos
+      || position - query_pos >= GST_SECOND) {
+    gint64 dur;
+
+    if (gst_pad_query_duration (pad, GST_FORMAT_TIME, &dur) && dur >= 0)
+      duration = dur;
+
+    GST_SOURCE_GROUP_LOCK (group);
+    group->duration = duration;
+    group->duration_query_pos = position;
+    GST_SOURCE_GROUP_UNLOCK (group);
+  }
+
+  /* Written so that large windows can't overflow */
+  if (GST_CLOCK_TIME_IS_VALID (duration)
+      && (position >= duration || duration - position <= window)) {
+    GST_SOURCE_GROUP_LOCK (group);
+    if (group->window_reached) {
+      GST_SOURCE_GROUP_UNLOCK (group);
+      return GST_PAD_PROBE_OK;
+    }
+    group->window_reached = TRUE;
+    GST_SOURCE_GROUP_UNLOCK (group);
+
+    GST_DEBUG_OBJECT (playbin, "group %p entered the pre-roll window at %"
+        GST_TIME_FORMAT " / %" GST_TIME_FORMAT, group,
+        GST_TIME_ARGS (position), GST_TIME_ARGS (duration));
+    gst_element_call_async (GST_ELEMENT_CAST (playbin),
+        preroll_window_reached, group, NULL);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
 static void
 control_source_pad (GstSourceGroup * group, GstPad * pad,
     GstStreamType stream_type)
@@ -2806,6 +3044,9 @@ control_source_pad (GstSourceGroup * group, GstPad * pad,
   sourcepad->event_probe_id =
       gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
       _decodebin_event_probe, group, NULL);
+  sourcepad->buffer_probe_id =
+      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      _decodebin_buffer_probe, group, NULL);
   sourcepad->stream_type = stream_type;
   group->source_pads = g_list_append (group->source_pads, sourcepad);
 }
@@ -3003,6 +3244,10 @@ release_source_pad (GstPlayBin3 * playbin, GstSourceGroup * group, GstPad * pad)
     gst_pad_remove_probe (pad, sourcepad->event_probe_id);
     sourcepad->event_probe_id = 0;
   }
+  if (sourcepad->buffer_probe_id) {
+    gst_pad_remove_probe (pad, sourcepad->buffer_probe_id);
+    sourcepad->buffer_probe_id = 0;
+  }
 
   /* Remove from list of controlled pads and check again for EOS status */
   group->source_pads = g_list_remove (group->source_pads, sourcepad);
@@ -3252,6 +3497,25 @@ about_to_finish_cb (GstElement * uridecodebin, GstSourceGroup * group)
   GstPlayBin3 *playbin = group->playbin;
   GST_DEBUG_OBJECT (playbin, "about to finish in group %p", group);
 
+  group_about_to_finish (playbin, group);
+}
+
+/* Emits 'about-to-finish' once per group, when its input got drained or when
+ * it entered the pre-roll window, whichever comes first. A flushing seek
+ * allows emitting it again */
+static void
+group_about_to_finish (GstPlayBin3 * playbin, GstSourceGroup * group)
+{
+  GST_SOURCE_GROUP_LOCK (group);
+  if (group->about_to_finish_emitted) {
+    GST_SOURCE_GROUP_UNLOCK (group);
+    GST_DEBUG_OBJECT (playbin, "about-to-finish already emitted for group %p",
+        group);
+    return;
+  }
+  group->about_to_finish_emitted = TRUE;
+  GST_SOURCE_GROUP_UNLOCK (group);
+
   GST_LOG_OBJECT (playbin, "selected_stream_types:%" STREAM_TYPES_FORMAT,
       STREAM_TYPES_ARGS (group->selected_stream_types));
   GST_LOG_OBJECT (playbin, "present_stream_types:%" STREAM_TYPES_FORMAT,
@@ -4437,6 +4701,14 @@ activate_group (GstPlayBin3 * playbin, GstSourceGroup * group)
 
   GST_SOURCE_GROUP_LOCK (group);
 
+  group->about_to_finish_emitted = FALSE;
+  group->window_reached = FALSE;
+  group->duration = GST_CLOCK_TIME_NONE;
+  group->duration_query_pos = GST_CLOCK_TIME_NONE;
+  group->is_next = playbin->curr_group != group && playbin->curr_group->active;
+  group->ready_time = GST_CLOCK_TIME_NONE;
+  group->switch_time = GST_CLOCK_TIME_NONE;
+
   /* First set up the custom sinks */
   if (playbin->audio_sink)
     group->audio_sink = gst_object_ref (playbin->audio_sink);
@@ -4508,7 +4780,9 @@ activate_group (GstPlayBin3 * playbin, GstSourceGroup * group)
       /* configure buffering parameters */
       "buffer-duration", playbin->buffer_duration,
       "buffer-size", playbin->buffer_size,
-      "ring-buffer-max-size", playbin->ring_buffer_max_size, NULL);
+      "ring-buffer-max-size", playbin->ring_buffer_max_size,
+      /* preload elements as soon as the container is known */
+      "fast-start", playbin->fast_start, NULL);
 
   group->pad_added_id = g_signal_connect (uridecodebin, "pad-added",
       G_CALLBACK (pad_added_cb), group);
@@ -116,6 +116,9 @@ struct _GstURIDecodeBin
   gboolean expose_allstreams;   /* Whether to expose unknow type streams or not */
 
   guint64 ring_buffer_max_size; /* 0 means disabled */
+
+  gboolean reuse_source;        /* keep the source around for the next URI */
+  GstElement *cached_source;    /* source removed in PAUSED->READY */
 };
 
 struct _GstURIDecodeBinClass
@@ -182,6 +185,7 @@ enum
 #define DEFAULT_USE_BUFFERING       FALSE
 #define DEFAULT_EXPOSE_ALL_STREAMS  TRUE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_REUSE_SOURCE        FALSE
 
 enum
 {
@@ -196,7 +200,8 @@ enum
   PROP_DOWNLOAD,
   PROP_USE_BUFFERING,
   PROP_EXPOSE_ALL_STREAMS,
-  PROP_RING_BUFFER_MAX_SIZE
+  PROP_RING_BUFFER_MAX_SIZE,
+  PROP_REUSE_SOURCE
 };
 
 static guint gst_uri_decode_bin_signals[LAST_SIGNAL] = { 0 };
@@ -490,6 +495,24 @@ gst_uri_decode_bin_class_init (GstURIDecodeBinClass * klass)
           0, G_MAXUINT, DEFAULT_RING_BUFFER_MAX_SIZE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstURIDecodeBin::reuse-source
+   *
+   * Keep the source element when going back to READY and reuse it for the
+   * next URI if it can handle that URI, instead of creating a new source
+   * element. This saves some setup time when the same uridecodebin is used
+   * for many URIs of the same protocol, e.g. when scanning local files.
+   *
+   * The source is still announced with #GstURIDecodeBin::source-setup
+   * every time, but properties set on it for a previous URI are kept.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_REUSE_SOURCE,
+      g_param_spec_boolean ("reuse-source", "Reuse source",
+          "Reuse the source element for the next URI when possible",
+          DEFAULT_REUSE_SOURCE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstURIDecodeBin::unknown-type:
    * @bin: The uridecodebin.
@@ -721,6 +744,7 @@ gst_uri_decode_bin_init (GstURIDecodeBin * dec)
   dec->use_buffering = DEFAULT_USE_BUFFERING;
   dec->expose_allstreams = DEFAULT_EXPOSE_ALL_STREAMS;
   dec->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  dec->reuse_source = DEFAULT_REUSE_SOURCE;
 
   GST_OBJECT_FLAG_SET (dec, GST_ELEMENT_FLAG_SOURCE);
   gst_bin_set_suppressed_flags (GST_BIN (dec),
@@ -733,6 +757,7 @@ gst_uri_decode_bin_finalize (GObject * obj)
   GstURIDecodeBin *dec = GST_URI_DECODE_BIN (obj);
 
   remove_decoders (dec, TRUE);
+  gst_object_replace ((GstObject **) & dec->cached_source, NULL);
   g_mutex_clear (&dec->lock);
   g_mutex_clear (&dec->factories_lock);
   g_free (dec->uri);
@@ -813,6 +838,9 @@ gst_uri_decode_bin_set_property (GObject * object, guint prop_id,
     case PROP_RING_BUFFER_MAX_SIZE:
       dec->ring_buffer_max_size = g_value_get_uint64 (value);
       break;
+    case PROP_REUSE_SOURCE:
+      dec->reuse_source = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -873,6 +901,9 @@ gst_uri_decode_bin_get_property (GObject * object, guint prop_id,
     case PROP_RING_BUFFER_MAX_SIZE:
       g_value_set_uint64 (value, dec->ring_buffer_max_size);
       break;
+    case PROP_REUSE_SOURCE:
+      g_value_set_boolean (value, dec->reuse_source);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1279,6 +1310,46 @@ static const gchar *adaptive_media[] = {
 #define IS_BLACKLISTED_URI(uri)     (array_has_uri_value (blacklisted_uris, uri))
 #define IS_ADAPTIVE_MEDIA(media)    (array_has_value (adaptive_media, media))
 
+/* Returns the source kept from the previous URI if it can handle the current
+ * URI, floating like a newly created element. */
+static GstElement *
+reuse_cached_source (GstURIDecodeBin * decoder)
+{
+  GstElement *source = decoder->cached_source;
+  const gchar *const *protocols;
+  gchar *protocol;
+  gboolean supported = FALSE;
+
+  if (source == NULL)
+    return NULL;
+
+  decoder->cached_source = NULL;
+
+  protocol = gst_uri_get_protocol (decoder->uri);
+  protocols = gst_uri_handler_get_protocols (GST_URI_HANDLER (source));
+  for (; protocol && protocols && *protocols; protocols++) {
+    if (!g_ascii_strcasecmp (*protocols, protocol)) {
+      supported = TRUE;
+      break;
+    }
+  }
+  g_free (protocol);
+
+  if (!supported || !gst_uri_handler_set_uri (GST_URI_HANDLER (source),
+          decoder->uri, NULL)) {
+    GST_DEBUG_OBJECT (decoder, "can't reuse source %" GST_PTR_FORMAT, source);
+    gst_object_unref (source);
+    return NULL;
+  }
+
+  GST_DEBUG_OBJECT (decoder, "reusing source %" GST_PTR_FORMAT, source);
+
+  /* gst_bin_add() takes over our reference like for a new element */
+  g_object_force_floating (G_OBJECT (source));
+
+  return source;
+}
+
 /*
  * Generate and configure a source element.
  */
@@ -1303,8 +1374,10 @@ gen_source_element (GstURIDecodeBin * decoder)
   if (IS_BLACKLISTED_URI (decoder->uri))
     goto uri_blacklisted;
 
-  source =
-      gst_element_make_from_uri (GST_URI_SRC, decoder->uri, "source", &err);
+  source = reuse_cached_source (decoder);
+  if (!source)
+    source =
+        gst_element_make_from_uri (GST_URI_SRC, decoder->uri, "source", &err);
   if (!source)
     goto no_source;
 
@@ -2076,6 +2149,9 @@ remove_source (GstURIDecodeBin * bin)
       g_signal_handler_disconnect (source, bin->src_nmp_sig_id);
       bin->src_nmp_sig_id = 0;
     }
+    if (bin->reuse_source && GST_IS_URI_HANDLER (source))
+      gst_object_replace ((GstObject **) & bin->cached_source,
+          (GstObject *) source);
     gst_bin_remove (GST_BIN_CAST (bin), source);
     bin->source = NULL;
   }
@@ -2846,6 +2922,7 @@ gst_uri_decode_bin_change_state (GstElement * element,
       GST_DEBUG ("ready to null");
       remove_decoders (decoder, TRUE);
       remove_source (decoder);
+      gst_object_replace ((GstObject **) & decoder->cached_source, NULL);
       break;
     default:
       break;
@@ -272,6 +272,7 @@ static GstStaticCaps raw_video_caps = GST_STATIC_CAPS ("video/x-raw(ANY)");
 #define DEFAULT_DOWNLOAD            FALSE
 #define DEFAULT_USE_BUFFERING       FALSE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_FAST_START          FALSE
 
 enum
 {
@@ -287,7 +288,8 @@ enum
   PROP_DOWNLOAD,
   PROP_USE_BUFFERING,
   PROP_RING_BUFFER_MAX_SIZE,
-  PROP_CAPS
+  PROP_CAPS,
+  PROP_FAST_START
 };
 
 static guint gst_uri_decode_bin3_signals[LAST_SIGNAL] = { 0 };
@@ -446,6 +448,20 @@ gst_uri_decode_bin3_class_init (GstURIDecodeBin3Class * klass)
           "The caps on which to stop decoding. (NULL = default)",
           GST_TYPE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstURIDecodeBin3:fast-start:
+   *
+   * Preload the elements likely needed for decoding as soon as the
+   * container caps are known. See #GstDecodebin3:fast-start.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Preload the elements likely needed as soon as the container "
+          "caps are known", DEFAULT_FAST_START,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstURIDecodebin3::select-stream
    * @decodebin: a #GstURIDecodebin3
@@ -833,6 +849,9 @@ gst_uri_decode_bin3_set_property (GObject * object, guint prop_id,
       dec->caps = g_value_dup_boxed (value);
       GST_OBJECT_UNLOCK (dec);
       break;
+    case PROP_FAST_START:
+      g_object_set_property (G_OBJECT (dec->decodebin), "fast-start", value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -904,6 +923,9 @@ gst_uri_decode_bin3_get_property (GObject * object, guint prop_id,
       g_value_set_boxed (value, dec->caps);
       GST_OBJECT_UNLOCK (dec);
       break;
+    case PROP_FAST_START:
+      g_object_get_property (G_OBJECT (dec->decodebin), "fast-start", value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -121,6 +121,38 @@ data_scan_ctx_memcmp (GstTypeFind * tf, DataScanCtx * c, guint offset,
   return (memcmp (c->data + offset, data, len) == 0);
 }
 
+/* Advances to the next MPEG start code (00 00 01) before @max_offset that has
+ * at least @min_len bytes of data available. Looks for the 0x01 with memchr()
+ * over the whole chunk instead of checking offset by offset, which most
+ * scanning typefinders spend their time on. */
+static inline gboolean
+data_scan_ctx_find_start_code (GstTypeFind * tf, DataScanCtx * c,
+    guint min_len, guint64 max_offset)
+{
+  g_assert (min_len >= 3);
+
+  while (c->offset < max_offset) {
+    const guint8 *p, *end;
+    guint64 n;
+
+    if (!data_scan_ctx_ensure_data (tf, c, min_len))
+      return FALSE;
+
+    /* number of offsets in this chunk with min_len bytes after them */
+    n = MIN (c->size - min_len + 1, max_offset - c->offset);
+    end = c->data + n + 2;
+    for (p = c->data + 2; (p = memchr (p, 0x01, end - p)) != NULL; p++) {
+      if (p[-1] == 0x00 && p[-2] == 0x00) {
+        data_scan_ctx_advance (tf, c, p - 2 - c->data);
+        return TRUE;
+      }
+    }
+    data_scan_ctx_advance (tf, c, n);
+  }
+
+  return FALSE;
+}
+
 /*** text/plain ***/
 static gboolean xml_check_first_element (GstTypeFind * tf,
     const gchar * element, guint elen, gboolean strict);
@@ -1100,9 +1132,14 @@ aac_type_find (GstTypeFind * tf, gpointer unused)
   GstTypeFindProbability best_probability = GST_TYPE_FIND_NONE;
   GstCaps *best_caps = NULL;
   gint best_count = 0;
+  /* first bytes of the ADTS, LOAS, LOAS EP and ADIF sync words, and the
+   * offset of the next occurrence of each of them */
+  static const guint8 lead_bytes[] = { 0xff, 0x56, 0x4d, 'A' };
+  guint64 next_lead[G_N_ELEMENTS (lead_bytes)] = { 0, };
 
   while (c.offset < AAC_AMOUNT) {
     guint snc, len, offset, i;
+    guint64 lead;
 
     /* detect adts header or adif header.
      * The ADIF header is 4 bytes, that should be OK. The ADTS header, on
@@ -1116,6 +1153,21 @@ aac_type_find (GstTypeFind * tf, gpointer unused)
     if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 6)))
       break;
 
+    /* skip to the next offset that can start a sync word */
+    lead = G_MAXUINT64;
+    for (i = 0; i < G_N_ELEMENTS (lead_bytes); i++) {
+      if (next_lead[i] <= c.offset) {
+        const guint8 *p = memchr (c.data, lead_bytes[i], c.size - 5);
+
+        next_lead[i] = c.offset + (p ? p - c.data : c.size - 5);
+      }
+      lead = MIN (lead, next_lead[i]);
+    }
+    if (lead > c.offset) {
+      data_scan_ctx_advance (tf, &c, lead - c.offset);
+      continue;
+    }
+
     snc = GST_READ_UINT16_BE (c.data);
     if (G_UNLIKELY ((snc & 0xfff6) == 0xfff0)) {
       /* ADTS header - find frame length */
@@ -1418,6 +1470,7 @@ mp3_type_find_at_offset (GstTypeFind * tf, guint64 start_off,
 {
   const guint8 *data = NULL;
   const guint8 *data_end = NULL;
+  const guint8 *sync;
   guint size;
   guint64 skipped;
   gint last_free_offset = -1;
@@ -1440,6 +1493,20 @@ mp3_type_find_at_offset (GstTypeFind * tf, guint64 start_off,
         break;
       data_end = data + size;
     }
+
+    /* skip to the next frame sync */
+    sync = memchr (data, 0xFF, size);
+    if (sync == NULL) {
+      skipped += size;
+      size = 0;
+      continue;
+    }
+    skipped += sync - data;
+    size -= sync - data;
+    data = sync;
+    if (skipped >= GST_MP3_TYPEFIND_TRY_SYNC)
+      break;
+
     if (*data == 0xFF) {
       const guint8 *head_data = NULL;
       guint layer = 0, bitrate, samplerate, channels;
@@ -2272,13 +2339,12 @@ mpeg_sys_is_valid_sys (GstTypeFind * tf, const guint8 * data, guint len,
 static void
 mpeg_sys_type_find (GstTypeFind * tf, gpointer unused)
 {
-  const guint8 *data, *data0, *first_sync, *end;
+  const guint8 *data, *data0, *first_sync, *end, *scan_start, *p;
   gint mpegversion = 0;
   guint pack_headers = 0;
   guint pes_headers = 0;
   guint pack_size;
   guint since_last_sync = 0;
-  guint32 sync_word = 0xffffffff;
   guint potential_headers = 0;
 
   G_STMT_START {
@@ -2302,57 +2368,70 @@ mpeg_sys_type_find (GstTypeFind * tf, gpointer unused)
 
   data0 = data;
   first_sync = NULL;
+  /* start codes must begin after the last packet that was skipped */
+  scan_start = data;
 
   while (data < end) {
-    sync_word <<= 8;
-    if (sync_word == 0x00000100) {
-      /* Found potential sync word */
-      if (first_sync == NULL)
-        first_sync = data - 3;
-
-      if (since_last_sync > 4) {
-        /* If more than 4 bytes since the last sync word, reset our counters,
-         * as we're only interested in counting contiguous packets */
-        pes_headers = pack_headers = 0;
-      }
-      pack_size = 0;
+    /* skip to the byte following the next 00 00 01 start code, looking for
+     * its 0x01 with memchr() */
+    p = MAX (data, scan_start + 3) - 1;
+    while (p < end - 1 && (p = memchr (p, 0x01, end - 1 - p)) != NULL) {
+      if (p[-1] == 0x00 && p[-2] == 0x00)
+        break;
+      p++;
+    }
+    if (p == NULL || p >= end - 1) {
+      since_last_sync += end - data;
+      break;
+    }
+    since_last_sync += p + 1 - data;
+    data = p + 1;
+
+    /* Found potential sync word */
+    if (first_sync == NULL)
+      first_sync = data - 3;
+
+    if (since_last_sync > 4) {
+      /* If more than 4 bytes since the last sync word, reset our counters,
+       * as we're only interested in counting contiguous packets */
+      pes_headers = pack_headers = 0;
+    }
+    pack_size = 0;
 
-      potential_headers++;
-      if (IS_MPEG_PACK_CODE (data[0])) {
-        if ((data[1] & 0xC0) == 0x40) {
-          /* MPEG-2 */
+    potential_headers++;
+    if (IS_MPEG_PACK_CODE (data[0])) {
+      if ((data[1] & 0xC0) == 0x40) {
+        /* MPEG-2 */
+        mpegversion = 2;
+      } else if ((data[1] & 0xF0) == 0x20) {
+        mpegversion = 1;
+      }
+      if (mpegversion != 0 &&
+          mpeg_sys_is_valid_pack (tf, data - 3, end - data + 3, &pack_size)) {
+        pack_headers++;
+      }
+    } else if (IS_MPEG_PES_CODE (data[0])) {
+      /* PES stream */
+      if (mpeg_sys_is_valid_pes (tf, data - 3, end - data + 3, &pack_size)) {
+        pes_headers++;
+        if (mpegversion == 0)
           mpegversion = 2;
-        } else if ((data[1] & 0xF0) == 0x20) {
-          mpegversion = 1;
-        }
-        if (mpegversion != 0 &&
-            mpeg_sys_is_valid_pack (tf, data - 3, end - data + 3, &pack_size)) {
-          pack_headers++;
-        }
-      } else if (IS_MPEG_PES_CODE (data[0])) {
-        /* PES stream */
-        if (mpeg_sys_is_valid_pes (tf, data - 3, end - data + 3, &pack_size)) {
-          pes_headers++;
-          if (mpegversion == 0)
-            mpegversion = 2;
-        }
-      } else if (IS_MPEG_SYS_CODE (data[0])) {
-        if (mpeg_sys_is_valid_sys (tf, data - 3, end - data + 3, &pack_size)) {
-          pack_headers++;
-        }
       }
-
-      /* If we found a packet with a known size, skip the bytes in it and loop
-       * around to check the next packet. */
-      if (pack_size != 0) {
-        data += pack_size - 3;
-        sync_word = 0xffffffff;
-        since_last_sync = 0;
-        continue;
+    } else if (IS_MPEG_SYS_CODE (data[0])) {
+      if (mpeg_sys_is_valid_sys (tf, data - 3, end - data + 3, &pack_size)) {
+        pack_headers++;
       }
     }
 
-    sync_word |= data[0];
+    /* If we found a packet with a known size, skip the bytes in it and loop
+     * around to check the next packet. */
+    if (pack_size != 0) {
+      data += pack_size - 3;
+      scan_start = data;
+      since_last_sync = 0;
+      continue;
+    }
+
     since_last_sync++;
     data++;
 
@@ -2459,7 +2538,7 @@ mpeg_ts_type_find (GstTypeFind * tf, gpointer unused)
   /* TS packet sizes to test: normal, DVHS packet size and
    * FEC with 16 or 20 byte codes packet size. */
   const gint pack_sizes[] = { 188, 192, 204, 208 };
-  const guint8 *data = NULL;
+  const guint8 *data = NULL, *sync;
   guint size = 0;
   guint64 skipped = 0;
 
@@ -2471,6 +2550,19 @@ mpeg_ts_type_find (GstTypeFind * tf, gpointer unused)
       size = GST_MPEGTS_TYPEFIND_SYNC_SIZE;
     }
 
+    /* skip to the next sync byte that has a full header after it */
+    sync = memchr (data, 0x47, size - MPEGTS_HDR_SIZE + 1);
+    if (sync == NULL) {
+      skipped += size - MPEGTS_HDR_SIZE + 1;
+      size = 0;
+      continue;
+    }
+    skipped += sync - data;
+    size -= sync - data;
+    data = sync;
+    if (skipped >= GST_MPEGTS_TYPEFIND_SCAN_LENGTH)
+      break;
+
     /* Have at least MPEGTS_HDR_SIZE bytes at this point */
     if (IS_MPEGTS_HEADER (data)) {
       gsize p;
@@ -2514,18 +2606,12 @@ static gboolean
 mpeg_find_next_header (GstTypeFind * tf, DataScanCtx * c,
     guint64 max_extra_offset)
 {
-  guint64 extra_offset;
+  if (!data_scan_ctx_find_start_code (tf, c, 4,
+          c->offset + max_extra_offset + 1))
+    return FALSE;
 
-  for (extra_offset = 0; extra_offset <= max_extra_offset; ++extra_offset) {
-    if (!data_scan_ctx_ensure_data (tf, c, 4))
-      return FALSE;
-    if (IS_MPEG_HEADER (c->data)) {
-      data_scan_ctx_advance (tf, c, 3);
-      return TRUE;
-    }
-    data_scan_ctx_advance (tf, c, 1);
-  }
-  return FALSE;
+  data_scan_ctx_advance (tf, c, 3);
+  return TRUE;
 }
 
 /*** video/mpeg MPEG-4 elementary video stream ***/
@@ -2739,67 +2825,65 @@ h264_video_type_find (GstTypeFind * tf, gpointer unused)
   int bad = 0;
 
   while (c.offset < H264_MAX_PROBE_LENGTH) {
-    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 4)))
+    if (G_UNLIKELY (!data_scan_ctx_find_start_code (tf, &c, 4,
+                H264_MAX_PROBE_LENGTH)))
       break;
 
-    if (IS_MPEG_HEADER (c.data)) {
-      nut = c.data[3] & 0x9f;   /* forbiden_zero_bit | nal_unit_type */
-      ref = c.data[3] & 0x60;   /* nal_ref_idc */
+    nut = c.data[3] & 0x9f;     /* forbiden_zero_bit | nal_unit_type */
+    ref = c.data[3] & 0x60;     /* nal_ref_idc */
 
-      /* if forbidden bit is different to 0 won't be h264 */
-      if (nut > 0x1f) {
-        bad++;
-        break;
-      }
+    /* if forbidden bit is different to 0 won't be h264 */
+    if (nut > 0x1f) {
+      bad++;
+      break;
+    }
 
-      /* collect statistics about the NAL types */
-      if ((nut >= 1 && nut <= 13) || nut == 19) {
-        if ((nut == 5 && ref == 0) ||
-            ((nut == 6 || (nut >= 9 && nut <= 12)) && ref != 0)) {
-          bad++;
-        } else {
-          if (nut == 7)
-            seen_sps = TRUE;
-          else if (nut == 8)
-            seen_pps = TRUE;
-          else if (nut == 5)
-            seen_idr = TRUE;
+    /* collect statistics about the NAL types */
+    if ((nut >= 1 && nut <= 13) || nut == 19) {
+      if ((nut == 5 && ref == 0) ||
+          ((nut == 6 || (nut >= 9 && nut <= 12)) && ref != 0)) {
+        bad++;
+      } else {
+        if (nut == 7)
+          seen_sps = TRUE;
+        else if (nut == 8)
+          seen_pps = TRUE;
+        else if (nut == 5)
+          seen_idr = TRUE;
 
+        good++;
+      }
+    } else if (nut >= 14 && nut <= 33) {
+      if (nut == 15) {
+        seen_ssps = TRUE;
+        good++;
+      } else if (nut == 14 || nut == 20) {
+        /* Sometimes we see NAL 14 or 20 without SSPS
+         * if dropped into the middle of a stream -
+         * just ignore those (don't add to bad count) */
+        if (seen_ssps)
           good++;
-        }
-      } else if (nut >= 14 && nut <= 33) {
-        if (nut == 15) {
-          seen_ssps = TRUE;
-          good++;
-        } else if (nut == 14 || nut == 20) {
-          /* Sometimes we see NAL 14 or 20 without SSPS
-           * if dropped into the middle of a stream -
-           * just ignore those (don't add to bad count) */
-          if (seen_ssps)
-            good++;
-        } else {
-          /* reserved */
-          /* Theoretically these are good, since if they exist in the
-             stream it merely means that a newer backwards-compatible
-             h.264 stream.  But we should be identifying that separately. */
-          bad++;
-        }
       } else {
-        /* unspecified, application specific */
-        /* don't consider these bad */
+        /* reserved */
+        /* Theoretically these are good, since if they exist in the
+           stream it merely means that a newer backwards-compatible
+           h.264 stream.  But we should be identifying that separately. */
+        bad++;
       }
+    } else {
+      /* unspecified, application specific */
+      /* don't consider these bad */
+    }
 
-      GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps:%d", good, bad,
-          seen_pps, seen_sps, seen_idr, seen_ssps);
-
-      if (seen_sps && seen_pps && seen_idr && good >= 10 && bad < 4) {
-        gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H264_VIDEO_CAPS);
-        return;
-      }
+    GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps:%d", good, bad,
+        seen_pps, seen_sps, seen_idr, seen_ssps);
 
-      data_scan_ctx_advance (tf, &c, 4);
+    if (seen_sps && seen_pps && seen_idr && good >= 10 && bad < 4) {
+      gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H264_VIDEO_CAPS);
+      return;
     }
-    data_scan_ctx_advance (tf, &c, 1);
+
+    data_scan_ctx_advance (tf, &c, 4 + 1);
   }
 
   GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps=%d", good, bad,
@@ -2836,63 +2920,61 @@ h265_video_type_find (GstTypeFind * tf, gpointer unused)
   int bad = 0;
 
   while (c.offset < H265_MAX_PROBE_LENGTH) {
-    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 5)))
+    if (G_UNLIKELY (!data_scan_ctx_find_start_code (tf, &c, 5,
+                H265_MAX_PROBE_LENGTH)))
       break;
 
-    if (IS_MPEG_HEADER (c.data)) {
-      /* forbiden_zero_bit | nal_unit_type */
-      nut = c.data[3] & 0xfe;
-
-      /* if forbidden bit is different to 0 won't be h265 */
-      if (nut > 0x7e) {
-        bad++;
-        break;
-      }
-      nut = nut >> 1;
+    /* forbiden_zero_bit | nal_unit_type */
+    nut = c.data[3] & 0xfe;
 
-      /* if nuh_layer_id is not zero or nuh_temporal_id_plus1 is zero then
-       * it won't be h265 */
-      if ((c.data[3] & 0x01) || (c.data[4] & 0xf8) || !(c.data[4] & 0x07)) {
-        bad++;
-        break;
-      }
+    /* if forbidden bit is different to 0 won't be h265 */
+    if (nut > 0x7e) {
+      bad++;
+      break;
+    }
+    nut = nut >> 1;
 
-      /* collect statistics about the NAL types */
-      if ((nut >= 0 && nut <= 9) || (nut >= 16 && nut <= 21) || (nut >= 32
-              && nut <= 40)) {
-        if (nut == 32)
-          seen_vps = TRUE;
-        else if (nut == 33)
-          seen_sps = TRUE;
-        else if (nut == 34)
-          seen_pps = TRUE;
-        else if (nut >= 16 && nut <= 21) {
-          /* BLA, IDR and CRA pictures are belongs to be IRAP picture */
-          /* we are not counting the reserved IRAP pictures (22 and 23) to good */
-          seen_irap = TRUE;
-        }
+    /* if nuh_layer_id is not zero or nuh_temporal_id_plus1 is zero then
+     * it won't be h265 */
+    if ((c.data[3] & 0x01) || (c.data[4] & 0xf8) || !(c.data[4] & 0x07)) {
+      bad++;
+      break;
+    }
 
-        good++;
-      } else if ((nut >= 10 && nut <= 15) || (nut >= 22 && nut <= 31)
-          || (nut >= 41 && nut <= 47)) {
-        /* reserved values are counting as bad */
-        bad++;
-      } else {
-        /* unspecified (48..63), application specific */
-        /* don't consider these as bad */
+    /* collect statistics about the NAL types */
+    if ((nut >= 0 && nut <= 9) || (nut >= 16 && nut <= 21) || (nut >= 32
+            && nut <= 40)) {
+      if (nut == 32)
+        seen_vps = TRUE;
+      else if (nut == 33)
+        seen_sps = TRUE;
+      else if (nut == 34)
+        seen_pps = TRUE;
+      else if (nut >= 16 && nut <= 21) {
+        /* BLA, IDR and CRA pictures are belongs to be IRAP picture */
+        /* we are not counting the reserved IRAP pictures (22 and 23) to good */
+        seen_irap = TRUE;
       }
 
-      GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
-          seen_pps, seen_sps, seen_vps, seen_irap);
+      good++;
+    } else if ((nut >= 10 && nut <= 15) || (nut >= 22 && nut <= 31)
+        || (nut >= 41 && nut <= 47)) {
+      /* reserved values are counting as bad */
+      bad++;
+    } else {
+      /* unspecified (48..63), application specific */
+      /* don't consider these as bad */
+    }
 
-      if (seen_sps && seen_pps && seen_irap && good >= 10 && bad < 4) {
-        gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H265_VIDEO_CAPS);
-        return;
-      }
+    GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
+        seen_pps, seen_sps, seen_vps, seen_irap);
 
-      data_scan_ctx_advance (tf, &c, 5);
+    if (seen_sps && seen_pps && seen_irap && good >= 10 && bad < 4) {
+      gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H265_VIDEO_CAPS);
+      return;
     }
-    data_scan_ctx_advance (tf, &c, 1);
+
+    data_scan_ctx_advance (tf, &c, 5 + 1);
   }
 
   GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
@@ -2933,12 +3015,10 @@ mpeg_video_stream_type_find (GstTypeFind * tf, gpointer unused)
     if (found >= GST_MPEGVID_TYPEFIND_TRY_PICTURES)
       break;
 
-    if (!data_scan_ctx_ensure_data (tf, &c, 5))
+    if (!data_scan_ctx_find_start_code (tf, &c, 5,
+            GST_MPEGVID_TYPEFIND_TRY_SYNC))
       break;
 
-    if (!IS_MPEG_HEADER (c.data))
-      goto next;
-
     /* a pack header indicates that this isn't an elementary stream */
     if (c.data[3] == 0xBA && mpeg_sys_is_valid_pack (tf, c.data, c.size, NULL))
       return;
@@ -2976,8 +3056,6 @@ mpeg_video_stream_type_find (GstTypeFind * tf, gpointer unused)
       continue;
     }
 
-  next:
-
     data_scan_ctx_advance (tf, &c, 1);
   }
 
@@ -5700,10 +5778,14 @@ typedef struct
   const guint8 *data;
   guint size;
   guint probability;
+  guint rank;
   GstCaps *caps;
 }
 GstTypeFindData;
 
+static void magic_add_start_with (GstTypeFindData * sw_data);
+static void magic_add_riff (GstTypeFindData * riff_data);
+
 static void
 start_with_type_find (GstTypeFind * tf, gpointer private)
 {
@@ -5733,10 +5815,13 @@ G_BEGIN_DECLS{                                                          \
   sw_data->data = (const guint8 *)_data;                                \
   sw_data->size = _size;                                                \
   sw_data->probability = _probability;                                  \
+  sw_data->rank = rank;                                                 \
   sw_data->caps = gst_caps_new_empty_simple (name);                     \
-  if (!gst_type_find_register (plugin, name, rank, start_with_type_find,\
+  if (gst_type_find_register (plugin, name, rank, start_with_type_find, \
                      ext, sw_data->caps, sw_data,                       \
                      (GDestroyNotify) (sw_data_destroy))) {             \
+    magic_add_start_with (sw_data);                                     \
+  } else {                                                              \
     sw_data_destroy (sw_data);                                          \
   }                                                                     \
 }G_END_DECLS
@@ -5762,14 +5847,148 @@ G_BEGIN_DECLS{                                                          \
   sw_data->data = (gpointer)_data;                                      \
   sw_data->size = 4;                                                    \
   sw_data->probability = GST_TYPE_FIND_MAXIMUM;                         \
+  sw_data->rank = rank;                                                 \
   sw_data->caps = gst_caps_new_empty_simple (name);                     \
-  if (!gst_type_find_register (plugin, name, rank, riff_type_find,      \
+  if (gst_type_find_register (plugin, name, rank, riff_type_find,       \
                       ext, sw_data->caps, sw_data,                      \
                       (GDestroyNotify) (sw_data_destroy))) {            \
+    magic_add_riff (sw_data);                                           \
+  } else {                                                              \
     sw_data_destroy (sw_data);                                          \
   }                                                                     \
 }G_END_DECLS
 
+/*** combined lookup of all magic byte types ***/
+
+/* The primary start-with and RIFF types that are certain about a match are
+ * also put into a jump table indexed by the first byte (RIFF types by their
+ * form type), so that a single typefinder ranked right above the primary ones
+ * can resolve them with one peek. On a match the core stops right away
+ * instead of running all the primary scanning typefinders.
+ *
+ * Types of a lower rank are not in the table. Suggesting them with maximum
+ * probability before the primary typefinders ran would let them win over a
+ * primary type that is just as certain. The individual typefinders stay
+ * registered for their caps, extensions and ranks and handle the types that
+ * are not in the table. */
+
+#define MAGIC_RANK (GST_RANK_PRIMARY + 1)
+#define MAGIC_MIN_RANK GST_RANK_PRIMARY
+#define MAGIC_MAX_SIZE 32
+
+/* sorted like the core sorts typefinders, so the same type wins */
+static GSList *magic_start_with[256];
+static GSList *magic_riff;
+static guint magic_peek_size;
+
+static gint
+magic_entry_compare (gconstpointer a, gconstpointer b)
+{
+  const GstTypeFindData *da = a, *db = b;
+
+  if (da->rank != db->rank)
+    return (gint) db->rank - (gint) da->rank;
+
+  return strcmp (gst_structure_get_name (gst_caps_get_structure (da->caps, 0)),
+      gst_structure_get_name (gst_caps_get_structure (db->caps, 0)));
+}
+
+/* types ranked above the table already ran before it */
+#define MAGIC_RANK_IN_TABLE(rank) \
+    ((rank) >= MAGIC_MIN_RANK && (rank) < MAGIC_RANK)
+
+static void
+magic_add_start_with (GstTypeFindData * sw_data)
+{
+  if (sw_data->probability < GST_TYPE_FIND_MAXIMUM || sw_data->size == 0
+      || sw_data->size > MAGIC_MAX_SIZE
+      || !MAGIC_RANK_IN_TABLE (sw_data->rank))
+    return;
+
+  magic_start_with[sw_data->data[0]] =
+      g_slist_insert_sorted (magic_start_with[sw_data->data[0]], sw_data,
+      magic_entry_compare);
+  magic_peek_size = MAX (magic_peek_size, sw_data->size);
+}
+
+static void
+magic_add_riff (GstTypeFindData * riff_data)
+{
+  if (!MAGIC_RANK_IN_TABLE (riff_data->rank))
+    return;
+
+  magic_riff = g_slist_insert_sorted (magic_riff, riff_data,
+      magic_entry_compare);
+  magic_peek_size = MAX (magic_peek_size, 12);
+}
+
+/* the union of the caps of all types in the table */
+static GstCaps *
+magic_get_caps (void)
+{
+  GstCaps *caps = gst_caps_new_empty ();
+  GSList *l;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (magic_start_with); i++) {
+    for (l = magic_start_with[i]; l != NULL; l = l->next)
+      caps = gst_caps_merge (caps,
+          gst_caps_ref (((GstTypeFindData *) l->data)->caps));
+  }
+  for (l = magic_riff; l != NULL; l = l->next)
+    caps = gst_caps_merge (caps,
+        gst_caps_ref (((GstTypeFindData *) l->data)->caps));
+
+  return caps;
+}
+
+static void
+magic_type_find (GstTypeFind * tf, gpointer unused)
+{
+  const guint8 *data;
+  guint size = magic_peek_size;
+  guint64 len;
+  GSList *l;
+
+  data = gst_type_find_peek (tf, 0, size);
+  if (data == NULL) {
+    /* less data than the longest magic, the individual typefinders will
+     * retry with their own sizes if the length is not known */
+    len = gst_type_find_get_length (tf);
+    if (len == 0 || len >= size)
+      return;
+    size = len;
+    data = gst_type_find_peek (tf, 0, size);
+    if (data == NULL)
+      return;
+  }
+
+  for (l = magic_start_with[data[0]]; l != NULL; l = l->next) {
+    GstTypeFindData *sw_data = l->data;
+
+    if (sw_data->size <= size
+        && memcmp (data, sw_data->data, sw_data->size) == 0) {
+      GST_LOG ("magic matches %" GST_PTR_FORMAT, sw_data->caps);
+      gst_type_find_suggest (tf, sw_data->probability, sw_data->caps);
+      return;
+    }
+  }
+
+  if (size < 12
+      || (memcmp (data, "RIFF", 4) != 0 && memcmp (data, "AVF0", 4) != 0))
+    return;
+
+  for (l = magic_riff; l != NULL; l = l->next) {
+    GstTypeFindData *riff_data = l->data;
+
+    if (memcmp (data + 8, riff_data->data, 4) == 0) {
+      GST_LOG ("RIFF form type matches %" GST_PTR_FORMAT, riff_data->caps);
+      gst_type_find_suggest (tf, riff_data->probability, riff_data->caps);
+      return;
+    }
+  }
+}
+
 
 /*** plugin initialization ***/
 
@@ -5783,6 +6002,9 @@ G_BEGIN_DECLS{\
 static gboolean
 plugin_init (GstPlugin * plugin)
 {
+  GstCaps *magic_caps;
+  gboolean magic_registered;
+
   /* can't initialize this via a struct as caps can't be statically initialized */
 
   GST_DEBUG_CATEGORY_INIT (type_find_debug, "typefindfunctions",
@@ -6108,6 +6330,14 @@ plugin_init (GstPlugin * plugin)
   TYPE_FIND_REGISTER_START_WITH (plugin, "audio/x-tap-dmp",
       GST_RANK_SECONDARY, "dmp", "DC2N-TAP-RAW", 12, GST_TYPE_FIND_LIKELY);
 
+  /* must come last, after all magic bytes are known */
+  magic_caps = magic_get_caps ();
+  magic_registered = gst_type_find_register (plugin, "magic-bytes",
+      MAGIC_RANK, magic_type_find, NULL, magic_caps, NULL, NULL);
+  gst_caps_unref (magic_caps);
+  if (!magic_registered)
+    return FALSE;
+
   return TRUE;
 }
 
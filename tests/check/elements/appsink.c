@@ -714,6 +714,63 @@ GST_START_TEST (test_pull_sample_refcounts)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_samples)
+{
+  GstElement *sink;
+  GstBuffer *buffer;
+  GstSample *samples[4];
+  guint i, n;
+
+  sink = setup_appsink ();
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  /* Nothing queued yet, no waiting */
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4, 0);
+  fail_unless_equals_int (n, 0);
+
+  for (i = 0; i < 6; i++) {
+    buffer = gst_buffer_new_and_alloc (i + 1);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* Batch is limited by the array size */
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4,
+      GST_SECOND);
+  fail_unless_equals_int (n, 4);
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer
+            (samples[i])), i + 1);
+    fail_unless (gst_sample_get_caps (samples[i]) != NULL);
+    gst_sample_unref (samples[i]);
+  }
+
+  /* and only returns what is queued */
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4,
+      GST_SECOND);
+  fail_unless_equals_int (n, 2);
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (gst_buffer_get_size (gst_sample_get_buffer
+            (samples[i])), i + 5);
+    gst_sample_unref (samples[i]);
+  }
+
+  /* Check that it actually waits for a bit */
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4,
+      GST_SECOND / 20);
+  fail_unless_equals_int (n, 0);
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+
+  /* Stopped */
+  n = gst_app_sink_try_pull_samples (GST_APP_SINK (sink), samples, 4, 0);
+  fail_unless_equals_int (n, 0);
+
+  cleanup_appsink (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsink_suite (void)
 {
@@ -735,6 +792,7 @@ appsink_suite (void)
   tcase_add_test (tc_chain, test_pull_preroll);
   tcase_add_test (tc_chain, test_do_not_care_preroll);
   tcase_add_test (tc_chain, test_pull_sample_refcounts);
+  tcase_add_test (tc_chain, test_pull_samples);
 
   return s;
 }
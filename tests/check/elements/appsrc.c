@@ -606,6 +606,185 @@ GST_START_TEST (test_appsrc_push_buffer_list)
 
 GST_END_TEST;
 
+static void
+wrapped_data_released (gpointer user_data)
+{
+  g_atomic_int_inc ((gint *) user_data);
+}
+
+GST_START_TEST (test_appsrc_push_buffers)
+{
+  GstElement *src;
+  GstBuffer *bufs[8];
+  static const guint8 data[64] = { 0, };
+  gint released = 0;
+  guint i;
+
+  src = setup_appsrc ();
+
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++) {
+    GstMemory *mem;
+
+    mem = gst_app_src_wrap_memory (GST_APP_SRC (src), (gpointer) data,
+        sizeof (data), &released, wrapped_data_released);
+    fail_unless (mem != NULL);
+    fail_unless (GST_MEMORY_IS_READONLY (mem));
+
+    bufs[i] = gst_buffer_new ();
+    gst_buffer_append_memory (bufs[i], mem);
+    GST_BUFFER_OFFSET (bufs[i]) = i;
+  }
+
+  fail_unless_equals_int (gst_app_src_push_buffers (GST_APP_SRC (src), bufs,
+          G_N_ELEMENTS (bufs)), GST_FLOW_OK);
+  fail_unless (gst_app_src_end_of_stream (GST_APP_SRC (src)) == GST_FLOW_OK);
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < G_N_ELEMENTS (bufs))
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  /* pushed out one by one and in order, without copying */
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++) {
+    GstBuffer *buf = g_list_nth_data (buffers, i);
+    GstMapInfo map;
+
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    fail_unless (map.data == data);
+    gst_buffer_unmap (buf, &map);
+  }
+  fail_unless_equals_int (g_atomic_int_get (&released), 0);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+
+  /* refused batches are released as well */
+  bufs[0] = gst_buffer_new ();
+  gst_buffer_append_memory (bufs[0], gst_app_src_wrap_memory (GST_APP_SRC
+          (src), (gpointer) data, sizeof (data), &released,
+          wrapped_data_released));
+  fail_unless_equals_int (gst_app_src_push_buffers (GST_APP_SRC (src), bufs,
+          1), GST_FLOW_FLUSHING);
+
+  cleanup_appsrc (src);
+
+  fail_unless_equals_int (g_atomic_int_get (&released),
+      G_N_ELEMENTS (bufs) + 1);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gint enough_data;
+  gint need_data;
+  guint64 need_data_level;
+} WatermarkData;
+
+static void
+count_enough_data (GstAppSrc * src, gpointer user_data)
+{
+  WatermarkData *data = user_data;
+
+  g_mutex_lock (&data->lock);
+  data->enough_data++;
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+record_need_data (GstAppSrc * src, guint length, gpointer user_data)
+{
+  WatermarkData *data = user_data;
+
+  g_mutex_lock (&data->lock);
+  /* remember the level at which need-data was emitted the first time */
+  if (data->need_data++ == 0)
+    data->need_data_level = gst_app_src_get_current_level_buffers (src);
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+GST_START_TEST (test_appsrc_watermarks)
+{
+  GstAppSrcCallbacks callbacks = { NULL };
+  WatermarkData data = { {0}, };
+  GstElement *src;
+  gdouble low;
+  guint64 level;
+  guint i;
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  src = setup_appsrc ();
+
+  callbacks.need_data = record_need_data;
+  callbacks.enough_data = count_enough_data;
+  gst_app_src_set_callbacks (GST_APP_SRC (src), &callbacks, &data, NULL);
+  g_object_set (src, "max-bytes", (guint64) 0, "max-buffers", (guint64) 8,
+      "max-time", (guint64) GST_SECOND, "high-watermark", 0.5,
+      "low-watermark", 0.25, NULL);
+
+  /* the streaming thread is not running yet, so everything stays queued */
+  for (i = 0; i < 6; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (10);
+
+    GST_BUFFER_PTS (buffer) = i * 100 * GST_MSECOND;
+    fail_unless_equals_int (gst_app_src_push_buffer (GST_APP_SRC (src),
+            buffer), GST_FLOW_OK);
+  }
+
+  /* full at 4 buffers (half of max-buffers), but only signalled once */
+  g_mutex_lock (&data.lock);
+  fail_unless_equals_int (data.enough_data, 1);
+  g_mutex_unlock (&data.lock);
+
+  g_object_get (src, "current-level-buffers", &level, NULL);
+  fail_unless_equals_uint64 (level, 6);
+  g_object_get (src, "current-level-bytes", &level, NULL);
+  fail_unless_equals_uint64 (level, 60);
+  g_object_get (src, "current-level-time", &level, NULL);
+  fail_unless_equals_uint64 (level, 500 * GST_MSECOND);
+
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  /* need-data is emitted again as soon as the queue drained to the low
+   * watermark (a quarter of max-buffers), not only once it is empty. The
+   * streaming thread waits in the callback, so the level can't change */
+  g_mutex_lock (&data.lock);
+  while (data.need_data == 0)
+    g_cond_wait (&data.cond, &data.lock);
+  fail_unless_equals_uint64 (data.need_data_level, 2);
+  g_mutex_unlock (&data.lock);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+
+  /* stopping flushes all levels */
+  fail_unless_equals_uint64 (gst_app_src_get_current_level_buffers
+      (GST_APP_SRC (src)), 0);
+  fail_unless_equals_uint64 (gst_app_src_get_current_level_time (GST_APP_SRC
+          (src)), 0);
+
+  /* the low watermark can't be above the high watermark */
+  g_object_set (src, "low-watermark", 0.8, NULL);
+  g_object_get (src, "low-watermark", &low, NULL);
+  fail_unless_equals_float (low, 0.5);
+  g_object_set (src, "high-watermark", 0.1, NULL);
+  g_object_get (src, "low-watermark", &low, NULL);
+  fail_unless_equals_float (low, 0.1);
+
+  cleanup_appsrc (src);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsrc_suite (void)
 {
@@ -617,6 +796,8 @@ appsrc_suite (void)
   tcase_add_test (tc_chain, test_appsrc_caps_in_push_modes);
   tcase_add_test (tc_chain, test_appsrc_blocked_on_caps);
   tcase_add_test (tc_chain, test_appsrc_push_buffer_list);
+  tcase_add_test (tc_chain, test_appsrc_push_buffers);
+  tcase_add_test (tc_chain, test_appsrc_watermarks);
 
   if (RUNNING_ON_VALGRIND)
     tcase_add_loop_test (tc_chain, test_appsrc_block_deadlock, 0, 5);
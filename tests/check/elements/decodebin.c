@@ -709,6 +709,156 @@ GST_START_TEST (test_buffering_aggregation)
 
 GST_END_TEST;
 
+/* Fake decoder for the factory filter cache test, registered under several
+ * names */
+static GType gst_fake_cache_decoder_get_type (void);
+
+#undef parent_class
+#define parent_class fake_cache_decoder_parent_class
+typedef struct _GstFakeCacheDecoder GstFakeCacheDecoder;
+typedef GstElementClass GstFakeCacheDecoderClass;
+
+struct _GstFakeCacheDecoder
+{
+  GstElement parent;
+};
+
+G_DEFINE_TYPE (GstFakeCacheDecoder, gst_fake_cache_decoder, GST_TYPE_ELEMENT);
+
+static void
+gst_fake_cache_decoder_class_init (GstFakeCacheDecoderClass * klass)
+{
+  static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("application/x-fake-cache-test"));
+  static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("audio/x-raw"));
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class, &sink_templ);
+  gst_element_class_add_static_pad_template (element_class, &src_templ);
+  gst_element_class_set_metadata (element_class,
+      "FakeCacheDecoder", "Codec/Decoder/Audio", "yep", "me");
+}
+
+static void
+gst_fake_cache_decoder_init (GstFakeCacheDecoder * self)
+{
+}
+
+/* GST_AUTOPLUG_SELECT_SKIP */
+#define AUTOPLUG_SELECT_SKIP 2
+
+static gint
+filter_cache_autoplug_select_cb (GstElement * decodebin, GstPad * pad,
+    GstCaps * caps, GstElementFactory * factory, gchar ** first)
+{
+  if (*first == NULL)
+    *first = g_strdup (GST_OBJECT_NAME (factory));
+
+  /* Only record the order, don't plug anything */
+  return AUTOPLUG_SELECT_SKIP;
+}
+
+/* Returns the name of the first factory a new decodebin offers for the test
+ * caps */
+static gchar *
+filter_cache_get_first_factory (void)
+{
+  GstElement *pipe, *src, *filter, *dec;
+  gchar *first = NULL;
+  GstMessage *msg;
+  GstCaps *caps;
+
+  pipe = gst_pipeline_new (NULL);
+
+  src = gst_element_factory_make ("fakesrc", NULL);
+  fail_unless (src != NULL);
+  g_object_set (G_OBJECT (src), "num-buffers", 1, "can-activate-pull", FALSE,
+      NULL);
+
+  filter = gst_element_factory_make ("capsfilter", NULL);
+  fail_unless (filter != NULL);
+  caps = gst_caps_from_string ("application/x-fake-cache-test");
+  g_object_set (G_OBJECT (filter), "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  dec = gst_element_factory_make ("decodebin", NULL);
+  fail_unless (dec != NULL);
+  g_signal_connect (dec, "autoplug-select",
+      G_CALLBACK (filter_cache_autoplug_select_cb), &first);
+
+  gst_bin_add_many (GST_BIN (pipe), src, filter, dec, NULL);
+  gst_element_link_many (src, filter, dec, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+
+  /* Everything was skipped, so decodebin errors out */
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_ERROR);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+
+  fail_unless (first != NULL, "no factory offered");
+  return first;
+}
+
+static void
+filter_cache_set_rank (const gchar * name, guint rank)
+{
+  GstPluginFeature *feature;
+
+  feature = gst_registry_find_feature (gst_registry_get (), name,
+      GST_TYPE_ELEMENT_FACTORY);
+  fail_unless (feature != NULL);
+  gst_plugin_feature_set_rank (feature, rank);
+  gst_object_unref (feature);
+}
+
+/* The factory lists filtered for fixed caps are cached across instances,
+ * check that new instances still follow rank and registry changes */
+GST_START_TEST (test_factory_filter_cache)
+{
+  gchar *first;
+
+  gst_element_register (NULL, "fakecachedeca", GST_RANK_PRIMARY + 200,
+      gst_fake_cache_decoder_get_type ());
+  gst_element_register (NULL, "fakecachedecb", GST_RANK_PRIMARY + 199,
+      gst_fake_cache_decoder_get_type ());
+
+  first = filter_cache_get_first_factory ();
+  fail_unless_equals_string (first, "fakecachedeca");
+  g_free (first);
+
+  /* Same registry and ranks: served from the cache */
+  first = filter_cache_get_first_factory ();
+  fail_unless_equals_string (first, "fakecachedeca");
+  g_free (first);
+
+  /* Rank changes don't change the registry cookie */
+  filter_cache_set_rank ("fakecachedeca", GST_RANK_NONE);
+  first = filter_cache_get_first_factory ();
+  fail_unless_equals_string (first, "fakecachedecb");
+  g_free (first);
+
+  /* A new factory changes the registry cookie and flushes the cache */
+  gst_element_register (NULL, "fakecachedecc", GST_RANK_PRIMARY + 201,
+      gst_fake_cache_decoder_get_type ());
+  first = filter_cache_get_first_factory ();
+  fail_unless_equals_string (first, "fakecachedecc");
+  g_free (first);
+
+  /* don't interfere with the other tests */
+  filter_cache_set_rank ("fakecachedecb", GST_RANK_NONE);
+  filter_cache_set_rank ("fakecachedecc", GST_RANK_NONE);
+}
+
+GST_END_TEST;
+
 static Suite *
 decodebin_suite (void)
 {
@@ -721,6 +871,7 @@ decodebin_suite (void)
   tcase_add_test (tc_chain, test_mp3_parser_loop);
   tcase_add_test (tc_chain, test_parser_negotiation);
   tcase_add_test (tc_chain, test_buffering_aggregation);
+  tcase_add_test (tc_chain, test_factory_filter_cache);
 
   return s;
 }
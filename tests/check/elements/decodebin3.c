@@ -0,0 +1,165 @@
+/* GStreamer unit tests for decodebin3
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+
+GST_START_TEST (test_fast_start_property)
+{
+  GstElement *decodebin;
+  gboolean fast_start;
+
+  decodebin = gst_element_factory_make ("decodebin3", NULL);
+  fail_unless (decodebin != NULL, "Failed to create decodebin3 element");
+
+  g_object_get (decodebin, "fast-start", &fast_start, NULL);
+  fail_unless (fast_start == FALSE);
+
+  g_object_set (decodebin, "fast-start", TRUE, NULL);
+  g_object_get (decodebin, "fast-start", &fast_start, NULL);
+  fail_unless (fast_start == TRUE);
+
+  gst_object_unref (decodebin);
+}
+
+GST_END_TEST;
+
+static void
+decodebin_pad_added_cb (GstElement * decodebin, GstPad * pad,
+    GstElement * sink)
+{
+  GstPad *sinkpad;
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  if (!gst_pad_is_linked (sinkpad))
+    fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+}
+
+/* Prerolls audiotestsrc ! decodebin3 ! fakesink and returns the
+ * "decodebin3-startup" message posted on the way, if any */
+static GstMessage *
+run_startup (gboolean fast_start)
+{
+  GstElement *pipe, *src, *decodebin, *sink;
+  GstMessage *msg, *startup = NULL;
+  GstBus *bus;
+  gboolean done = FALSE;
+
+  pipe = gst_pipeline_new (NULL);
+  fail_unless (pipe != NULL, "failed to create pipeline");
+
+  src = gst_element_factory_make ("audiotestsrc", "src");
+  fail_unless (src != NULL, "Failed to create audiotestsrc element");
+
+  decodebin = gst_element_factory_make ("decodebin3", "decodebin");
+  fail_unless (decodebin != NULL, "Failed to create decodebin3 element");
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (sink != NULL, "Failed to create fakesink element");
+
+  g_object_set (decodebin, "fast-start", fast_start, NULL);
+  g_signal_connect (decodebin, "pad-added",
+      G_CALLBACK (decodebin_pad_added_cb), sink);
+
+  gst_bin_add_many (GST_BIN (pipe), src, decodebin, sink, NULL);
+  fail_unless (gst_element_link (src, decodebin));
+
+  bus = gst_element_get_bus (pipe);
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+
+  /* decodebin3 posts the message as soon as its pad is exposed, which is
+   * before the sink can preroll */
+  while (!done) {
+    msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+        GST_MESSAGE_ELEMENT | GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+    fail_unless (msg != NULL, "timed out waiting for preroll");
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_ERROR:
+        fail ("unexpected error message");
+        break;
+      case GST_MESSAGE_ASYNC_DONE:
+        done = TRUE;
+        break;
+      case GST_MESSAGE_ELEMENT:
+        if (gst_message_has_name (msg, "decodebin3-startup")) {
+          fail_unless (startup == NULL, "startup message posted twice");
+          fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT_CAST (decodebin));
+          startup = gst_message_ref (msg);
+        }
+        break;
+      default:
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipe);
+
+  return startup;
+}
+
+GST_START_TEST (test_startup_message)
+{
+  const GstStructure *s;
+  GstMessage *msg;
+  GstClockTime total = GST_CLOCK_TIME_NONE;
+
+  /* Nothing is posted by default */
+  msg = run_startup (FALSE);
+  fail_unless (msg == NULL, "startup message posted without fast-start");
+
+  msg = run_startup (TRUE);
+  fail_unless (msg != NULL, "no startup message in fast-start mode");
+
+  s = gst_message_get_structure (msg);
+  fail_unless (gst_structure_has_field_typed (s, "typefind", G_TYPE_UINT64));
+  fail_unless (gst_structure_has_field_typed (s, "demux", G_TYPE_UINT64));
+  fail_unless (gst_structure_has_field_typed (s, "decoder-setup",
+          G_TYPE_UINT64));
+  fail_unless (gst_structure_has_field_typed (s, "output", G_TYPE_UINT64));
+  fail_unless (gst_structure_get_uint64 (s, "total", &total));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (total));
+
+  gst_message_unref (msg);
+}
+
+GST_END_TEST;
+
+static Suite *
+decodebin3_suite (void)
+{
+  Suite *s = suite_create ("decodebin3");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_fast_start_property);
+  tcase_add_test (tc_chain, test_startup_message);
+
+  return s;
+}
+
+GST_CHECK_MAIN (decodebin3);
@@ -0,0 +1,270 @@
+/* GStreamer unit tests for playbin3
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+
+#include <glib/gstdio.h>
+
+#define PLAY_FLAG_AUDIO (1 << 1)
+
+/* Shorter than theora-vorbis.ogg (about 2.3 seconds) */
+#define PREROLL_WINDOW (GST_SECOND)
+
+/* How late the sink position may be compared to the decoded buffers */
+#define POSITION_SLACK (500 * GST_MSECOND)
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gchar *next_uri;
+  gint about_to_finish;         /* emissions of playbin3 */
+  gint drained;                 /* emissions of uridecodebin3 */
+  gint n_demuxers;
+  gboolean before_drain;
+  gboolean in_window;
+  gboolean timed_out;
+} GaplessData;
+
+typedef struct
+{
+  GaplessData *data;
+  gint index;
+} DemuxerData;
+
+/* A local file is read, and its input drained, long before it is played.
+ * Hold the EOS of the demuxer until playbin3 emitted about-to-finish for its
+ * stream, so that only the pre-roll window can trigger it in time */
+static GstPadProbeReturn
+demuxer_eos_probe (GstPad * pad, GstPadProbeInfo * info, DemuxerData * ddata)
+{
+  GaplessData *data = ddata->data;
+  gint64 end_time;
+
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) != GST_EVENT_EOS)
+    return GST_PAD_PROBE_OK;
+
+  end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+  g_mutex_lock (&data->lock);
+  while (data->about_to_finish <= ddata->index) {
+    if (!g_cond_wait_until (&data->cond, &data->lock, end_time)) {
+      data->timed_out = TRUE;
+      break;
+    }
+  }
+  g_mutex_unlock (&data->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+demuxer_pad_added_cb (GstElement * demuxer, GstPad * pad, DemuxerData * ddata)
+{
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) demuxer_eos_probe, ddata, NULL);
+}
+
+static void
+uridecodebin_about_to_finish_cb (GstElement * uridecodebin,
+    GaplessData * data)
+{
+  g_mutex_lock (&data->lock);
+  data->drained++;
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+element_setup_cb (GstElement * playbin, GstElement * element,
+    GaplessData * data)
+{
+  GstElementFactory *factory = gst_element_get_factory (element);
+  const gchar *name;
+
+  if (factory == NULL)
+    return;
+
+  name = GST_OBJECT_NAME (factory);
+  if (g_str_equal (name, "uridecodebin3")) {
+    g_signal_connect (element, "about-to-finish",
+        G_CALLBACK (uridecodebin_about_to_finish_cb), data);
+  } else if (g_str_equal (name, "oggdemux")) {
+    DemuxerData *ddata = g_new0 (DemuxerData, 1);
+
+    ddata->data = data;
+    g_mutex_lock (&data->lock);
+    ddata->index = data->n_demuxers++;
+    g_mutex_unlock (&data->lock);
+    g_signal_connect_data (element, "pad-added",
+        G_CALLBACK (demuxer_pad_added_cb), ddata, (GClosureNotify) g_free, 0);
+  }
+}
+
+static void
+about_to_finish_cb (GstElement * playbin, GaplessData * data)
+{
+  gint64 position = -1, duration = -1;
+  gboolean first;
+
+  g_mutex_lock (&data->lock);
+  first = data->about_to_finish == 0;
+  if (first)
+    data->before_drain = data->drained == 0;
+  g_mutex_unlock (&data->lock);
+
+  /* Emitted for the first stream: check the position and set up the second
+   * one */
+  if (first) {
+    if (gst_element_query_position (playbin, GST_FORMAT_TIME, &position)
+        && gst_element_query_duration (playbin, GST_FORMAT_TIME, &duration)
+        && position >= 0 && duration > 0)
+      data->in_window = position < duration
+          && position + PREROLL_WINDOW + POSITION_SLACK >= duration;
+
+    g_object_set (playbin, "uri", data->next_uri, NULL);
+  }
+
+  g_mutex_lock (&data->lock);
+  data->about_to_finish++;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+GST_START_TEST (test_preroll_window)
+{
+  GstElement *playbin, *audio_sink, *video_sink;
+  GaplessData data = { {0}, };
+  gchar *path, *contents, *dir, *next_path, *uri;
+  GstClockTimeDiff ahead = 0;
+  gboolean have_gapless = FALSE, done = FALSE;
+  GstMessage *msg;
+  GstBus *bus;
+  gsize size;
+
+  /* Play the test file followed by a copy of it */
+  path = g_build_filename (GST_TEST_FILES_PATH, "theora-vorbis.ogg", NULL);
+  fail_unless (g_file_get_contents (path, &contents, &size, NULL));
+  dir = g_dir_make_tmp ("playbin3-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  next_path = g_build_filename (dir, "next.ogg", NULL);
+  fail_unless (g_file_set_contents (next_path, contents, size, NULL));
+  g_free (contents);
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  uri = gst_filename_to_uri (path, NULL);
+  data.next_uri = gst_filename_to_uri (next_path, NULL);
+
+  playbin = gst_element_factory_make ("playbin3", NULL);
+  fail_unless (playbin != NULL, "Failed to create playbin3 element");
+
+  audio_sink = gst_element_factory_make ("fakesink", "audio-sink");
+  video_sink = gst_element_factory_make ("fakesink", "video-sink");
+  g_object_set (audio_sink, "sync", TRUE, NULL);
+
+  g_object_set (playbin, "uri", uri, "flags", PLAY_FLAG_AUDIO,
+      "audio-sink", audio_sink, "video-sink", video_sink,
+      "preroll-window", (guint64) PREROLL_WINDOW, NULL);
+  g_signal_connect (playbin, "about-to-finish",
+      G_CALLBACK (about_to_finish_cb), &data);
+  g_signal_connect (playbin, "element-setup",
+      G_CALLBACK (element_setup_cb), &data);
+
+  bus = gst_element_get_bus (playbin);
+
+  fail_unless (gst_element_set_state (playbin, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  while (!done) {
+    msg = gst_bus_timed_pop_filtered (bus, 20 * GST_SECOND,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR | GST_MESSAGE_ELEMENT);
+    fail_unless (msg != NULL, "timed out waiting for EOS");
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_ERROR:
+        fail ("unexpected error message");
+        break;
+      case GST_MESSAGE_EOS:
+        done = TRUE;
+        break;
+      case GST_MESSAGE_ELEMENT:
+        if (gst_message_has_name (msg, "playbin3-gapless")) {
+          const GstStructure *s = gst_message_get_structure (msg);
+
+          fail_unless (!have_gapless, "gapless message posted twice");
+          fail_unless_equals_string (gst_structure_get_string (s, "uri"),
+              data.next_uri);
+          fail_unless (gst_structure_get (s, "ready-ahead", G_TYPE_INT64,
+                  &ahead, NULL));
+          have_gapless = TRUE;
+        }
+        break;
+      default:
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  gst_element_set_state (playbin, GST_STATE_NULL);
+
+  /* Once per stream, not again when the streams got drained */
+  fail_unless_equals_int (data.about_to_finish, 2);
+  fail_unless (!data.timed_out, "about-to-finish not emitted before the EOS");
+  fail_unless (data.before_drain, "about-to-finish emitted after the drain");
+  fail_unless (data.in_window, "about-to-finish emitted outside the window");
+  fail_unless (have_gapless, "no gapless message posted");
+  /* The second stream was prepared while the first one was playing */
+  fail_unless (ahead > 0);
+
+  gst_object_unref (bus);
+  gst_object_unref (playbin);
+
+  g_unlink (next_path);
+  g_rmdir (dir);
+  g_free (next_path);
+  g_free (dir);
+  g_free (data.next_uri);
+  g_free (uri);
+  g_free (path);
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+}
+
+GST_END_TEST;
+
+static Suite *
+playbin3_suite (void)
+{
+  Suite *s = suite_create ("playbin3");
+  TCase *tc_chain = tcase_create ("general");
+  GstRegistry *reg = gst_registry_get ();
+
+  suite_add_tcase (s, tc_chain);
+
+  if (gst_registry_check_feature_version (reg, "oggdemux", 1, 0, 0) &&
+      gst_registry_check_feature_version (reg, "vorbisdec", 1, 0, 0)) {
+    tcase_add_test (tc_chain, test_preroll_window);
+  }
+
+  return s;
+}
+
+GST_CHECK_MAIN (playbin3);
@@ -477,6 +477,193 @@ GST_START_TEST (test_manifest_typefinding)
 
 GST_END_TEST;
 
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+} MagicTypeFind;
+
+static const guint8 *
+magic_peek (gpointer data, gint64 offset, guint size)
+{
+  MagicTypeFind *mtf = data;
+
+  if (offset < 0 || (guint64) offset + size > mtf->size)
+    return NULL;
+
+  return mtf->data + offset;
+}
+
+static void
+magic_suggest (gpointer data, guint probability, GstCaps * caps)
+{
+  MagicTypeFind *mtf = data;
+
+  if (probability > mtf->prob) {
+    gst_caps_replace (&mtf->caps, caps);
+    mtf->prob = probability;
+  }
+}
+
+static guint64
+magic_get_length (gpointer data)
+{
+  MagicTypeFind *mtf = data;
+
+  return mtf->size;
+}
+
+/* runs only the combined "magic-bytes" typefinder on the data and checks
+ * what it suggests, nothing if expected is NULL */
+static void
+check_magic (const guint8 * data, gsize size, const gchar * expected,
+    GstTypeFindProbability expected_prob)
+{
+  MagicTypeFind mtf = { data, size, GST_TYPE_FIND_NONE, NULL };
+  GstTypeFind find = { magic_peek, magic_suggest, &mtf, magic_get_length };
+  GstTypeFindFactory *factory;
+
+  factory = (GstTypeFindFactory *) gst_registry_find_feature (gst_registry_get
+      (), "magic-bytes", GST_TYPE_TYPE_FIND_FACTORY);
+  fail_unless (factory != NULL);
+
+  GST_MEMDUMP ("magic data", data, size);
+  gst_type_find_factory_call_function (factory, &find);
+  GST_INFO ("caps: %" GST_PTR_FORMAT ", probability=%u", mtf.caps, mtf.prob);
+
+  if (expected == NULL) {
+    fail_unless (mtf.caps == NULL);
+  } else {
+    fail_unless (mtf.caps != NULL);
+    fail_unless_equals_string (gst_structure_get_name (gst_caps_get_structure
+            (mtf.caps, 0)), expected);
+    fail_unless_equals_int (mtf.prob, expected_prob);
+    gst_caps_unref (mtf.caps);
+  }
+
+  gst_object_unref (factory);
+}
+
+/* primary types identified by their first bytes are resolved all at once */
+GST_START_TEST (test_magic_bytes)
+{
+  const guint8 png[] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a,
+    0x00, 0x00, 0x00, 0x0d, 'I', 'H', 'D', 'R'
+  };
+  const guint8 wav[] = { 'R', 'I', 'F', 'F', 0x24, 0x00, 0x00, 0x00,
+    'W', 'A', 'V', 'E', 'f', 'm', 't', ' '
+  };
+  const guint8 amr_wb[] = "#!AMR-WB\n";
+  const guint8 amr_nb[] = "#!AMR\n";
+  const guint8 flv[] = "FLV";
+  guint8 *data;
+
+  check_magic (wav, sizeof (wav), "audio/x-wav", GST_TYPE_FIND_MAXIMUM);
+
+  /* less data than the longest magic */
+  check_magic (amr_wb, sizeof (amr_wb) - 1, "audio/x-amr-wb-sh",
+      GST_TYPE_FIND_MAXIMUM);
+
+  /* more data than peeked for the magic */
+  data = g_malloc0 (4096);
+  memcpy (data, wav, sizeof (wav));
+  check_magic (data, 4096, "audio/x-wav", GST_TYPE_FIND_MAXIMUM);
+  g_free (data);
+
+  /* left to the individual typefinders: an uncertain magic, and types
+   * ranked above or below the primary ones */
+  check_magic (amr_nb, sizeof (amr_nb) - 1, NULL, GST_TYPE_FIND_NONE);
+  check_magic (png, sizeof (png), NULL, GST_TYPE_FIND_NONE);
+  check_magic (flv, sizeof (flv) - 1, NULL, GST_TYPE_FIND_NONE);
+}
+
+GST_END_TEST;
+
+/* only primary types are resolved ahead of the other primary typefinders,
+ * and the combined typefinder lists them in its caps */
+GST_START_TEST (test_magic_bytes_caps)
+{
+  GstTypeFindFactory *factory;
+  GstCaps *caps, *wav, *sid;
+  GList *factories, *l;
+  guint rank;
+
+  factory = (GstTypeFindFactory *) gst_registry_find_feature (gst_registry_get
+      (), "magic-bytes", GST_TYPE_TYPE_FIND_FACTORY);
+  fail_unless (factory != NULL);
+  rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory));
+  fail_unless (rank > GST_RANK_PRIMARY);
+
+  caps = gst_type_find_factory_get_caps (factory);
+  fail_unless (caps != NULL);
+  wav = gst_caps_new_empty_simple ("audio/x-wav");
+  sid = gst_caps_new_empty_simple ("audio/x-sid");
+  fail_unless (gst_caps_can_intersect (caps, wav));
+  fail_if (gst_caps_can_intersect (caps, sid));
+  gst_caps_unref (wav);
+  gst_caps_unref (sid);
+
+  /* the types of the typefinders ranked at or above it already ran, so they
+   * must not be in its table */
+  factories = gst_type_find_factory_get_list ();
+  for (l = factories; l != NULL; l = l->next) {
+    GstPluginFeature *feature = l->data;
+    GstCaps *other_caps;
+
+    if (feature == GST_PLUGIN_FEATURE (factory)
+        || gst_plugin_feature_get_rank (feature) < rank
+        || g_strcmp0 (gst_plugin_feature_get_plugin_name (feature),
+            "typefindfunctions") != 0)
+      continue;
+
+    other_caps = gst_type_find_factory_get_caps (GST_TYPE_FIND_FACTORY
+        (feature));
+    if (other_caps != NULL)
+      fail_if (gst_caps_can_intersect (caps, other_caps),
+          "%s is ranked above the magic bytes", GST_OBJECT_NAME (feature));
+  }
+  gst_plugin_feature_list_free (factories);
+
+  gst_object_unref (factory);
+}
+
+GST_END_TEST;
+
+/* NALs spread over more than one scan chunk, with filler between them */
+GST_START_TEST (test_h264_start_codes)
+{
+  const guint8 nal_headers[] = { 0x67, 0x68, 0x65, 0x41, 0x41, 0x41, 0x41,
+    0x41, 0x41, 0x41, 0x41, 0x41
+  };
+  const gsize nal_size = 4 + 1 + 517;
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+  guint8 *data;
+  gsize i;
+
+  data = g_malloc (G_N_ELEMENTS (nal_headers) * nal_size);
+  memset (data, 0xaa, G_N_ELEMENTS (nal_headers) * nal_size);
+  for (i = 0; i < G_N_ELEMENTS (nal_headers); i++) {
+    guint8 *nal = data + i * nal_size;
+
+    nal[0] = nal[1] = nal[2] = 0x00;
+    nal[3] = 0x01;
+    nal[4] = nal_headers[i];
+  }
+
+  caps = typefind_data (data, G_N_ELEMENTS (nal_headers) * nal_size, &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_string (gst_structure_get_name (gst_caps_get_structure
+          (caps, 0)), "video/x-h264");
+  fail_unless (prob >= GST_TYPE_FIND_LIKELY);
+  gst_caps_unref (caps);
+  g_free (data);
+}
+
+GST_END_TEST;
+
 static Suite *
 typefindfunctions_suite (void)
 {
@@ -489,11 +676,14 @@ typefindfunctions_suite (void)
   tcase_add_test (tc_chain, test_broken_flac_in_ogg);
   tcase_add_test (tc_chain, test_jpeg_not_ac3);
   tcase_add_test (tc_chain, test_mpegts);
+  tcase_add_test (tc_chain, test_h264_start_codes);
   tcase_add_test (tc_chain, test_ac3);
   tcase_add_test (tc_chain, test_eac3);
   tcase_add_test (tc_chain, test_random_data);
   tcase_add_test (tc_chain, test_hls_m3u8);
   tcase_add_test (tc_chain, test_manifest_typefinding);
+  tcase_add_test (tc_chain, test_magic_bytes);
+  tcase_add_test (tc_chain, test_magic_bytes_caps);
 
   return s;
 }
@@ -140,13 +140,25 @@ GST_START_TEST (test_disco_sync)
 }
 
 GST_END_TEST;
+/* marks the sources seen in source-setup, to tell reused ones apart from
+ * new ones even when a new one gets the address of a freed one */
 static void
-test_disco_sync_reuse (const gchar * test_fn, guint num, GstClockTime timeout)
+reuse_source_setup_cb (GstDiscoverer * dc, GstElement * source,
+    gboolean * reused)
+{
+  *reused = g_object_get_data (G_OBJECT (source), "seen-source") != NULL;
+  g_object_set_data (G_OBJECT (source), "seen-source", GINT_TO_POINTER (1));
+}
+
+static void
+test_disco_sync_reuse_full (const gchar * test_fn, guint num,
+    GstClockTime timeout, gboolean reuse_source)
 {
   GError *err = NULL;
   GstDiscoverer *dc;
   GstDiscovererInfo *info;
-  GstDiscovererResult result;
+  GstDiscovererResult result, prev_result = GST_DISCOVERER_OK;
+  gboolean reused;
   gchar *uri, *path;
   int i;
 
@@ -154,6 +166,10 @@ test_disco_sync_reuse (const gchar * test_fn, guint num, GstClockTime timeout)
   fail_unless (dc != NULL);
   fail_unless (err == NULL);
 
+  g_object_set (dc, "reuse-source", reuse_source, NULL);
+  g_signal_connect (dc, "source-setup", G_CALLBACK (reuse_source_setup_cb),
+      &reused);
+
   /* GST_TEST_FILE comes from makefile CFLAGS */
   path = g_build_filename (GST_TEST_FILES_PATH, test_fn, NULL);
   uri = gst_filename_to_uri (path, &err);
@@ -162,11 +178,20 @@ test_disco_sync_reuse (const gchar * test_fn, guint num, GstClockTime timeout)
 
   for (i = 0; i < num; ++i) {
     GST_INFO ("[%02d] discovering uri '%s'", i, uri);
+    reused = FALSE;
     info = gst_discoverer_discover_uri (dc, uri, &err);
     if (info) {
       result = gst_discoverer_info_get_result (info);
-      GST_INFO ("result: %d", result);
+      GST_INFO ("result: %d, source reused: %d", result, reused);
       gst_discoverer_info_unref (info);
+
+      /* the source of a successful discovery is kept when asked to, an
+       * error resets the pipeline and creates a new source */
+      if (i > 0 && prev_result == GST_DISCOVERER_OK)
+        fail_unless_equals_int (reused, reuse_source);
+      else if (prev_result == GST_DISCOVERER_ERROR)
+        fail_if (reused);
+      prev_result = result;
     }
     /* in case we don't have some of the elements needed */
     if (err) {
@@ -179,6 +204,12 @@ test_disco_sync_reuse (const gchar * test_fn, guint num, GstClockTime timeout)
   g_object_unref (dc);
 }
 
+static void
+test_disco_sync_reuse (const gchar * test_fn, guint num, GstClockTime timeout)
+{
+  test_disco_sync_reuse_full (test_fn, num, timeout, FALSE);
+}
+
 GST_START_TEST (test_disco_sync_reuse_ogg)
 {
   test_disco_sync_reuse ("theora-vorbis.ogg", 2, 10 * GST_SECOND);
@@ -194,6 +225,15 @@ GST_START_TEST (test_disco_sync_reuse_mp3)
 
 GST_END_TEST;
 
+GST_START_TEST (test_disco_sync_reuse_source)
+{
+  test_disco_sync_reuse_full ("theora-vorbis.ogg", 3, 10 * GST_SECOND, TRUE);
+  /* errors reset the pipeline completely, the source must not be kept */
+  test_disco_sync_reuse_full ("test.mp3", 3, 10 * GST_SECOND, TRUE);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_disco_sync_reuse_timeout)
 {
   /* set minimum timeout to test that, esp. leakage under valgrind */
@@ -203,6 +243,271 @@ GST_START_TEST (test_disco_sync_reuse_timeout)
 
 GST_END_TEST;
 
+GST_START_TEST (test_disco_parse_only)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GstDiscovererInfo *info;
+  GList *streams, *l;
+  gboolean parse_only;
+  gchar *uri, *path;
+
+  dc = gst_discoverer_new (10 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+
+  g_object_set (dc, "parse-only", TRUE, NULL);
+  g_object_get (dc, "parse-only", &parse_only, NULL);
+  fail_unless (parse_only);
+
+  path = g_build_filename (GST_TEST_FILES_PATH, "theora-vorbis.ogg", NULL);
+  uri = gst_filename_to_uri (path, &err);
+  g_free (path);
+  fail_unless (err == NULL);
+
+  info = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (info != NULL);
+
+  if (have_ogg) {
+    fail_unless (err == NULL);
+    fail_unless_equals_int (gst_discoverer_info_get_result (info),
+        GST_DISCOVERER_OK);
+
+    /* no decoders were plugged, so all streams are still encoded, even
+     * if the decoders are available */
+    streams = gst_discoverer_info_get_stream_list (info);
+    fail_unless (streams != NULL);
+    for (l = streams; l; l = l->next) {
+      GstCaps *caps = gst_discoverer_stream_info_get_caps (l->data);
+      const gchar *name;
+
+      fail_unless (caps != NULL);
+      name = gst_structure_get_name (gst_caps_get_structure (caps, 0));
+      GST_INFO ("stream caps %" GST_PTR_FORMAT, caps);
+      fail_if (g_str_has_suffix (name, "/x-raw"));
+      gst_caps_unref (caps);
+    }
+    gst_discoverer_stream_info_list_free (streams);
+  }
+
+  g_clear_error (&err);
+  gst_discoverer_info_unref (info);
+  g_free (uri);
+  g_object_unref (dc);
+}
+
+GST_END_TEST;
+
+static void
+check_cache_stats (GstDiscoverer * dc, guint expected_hits,
+    guint expected_misses)
+{
+  guint hits, misses;
+
+  g_object_get (dc, "cache-hits", &hits, "cache-misses", &misses, NULL);
+  fail_unless_equals_int (hits, expected_hits);
+  fail_unless_equals_int (misses, expected_misses);
+}
+
+GST_START_TEST (test_disco_cache)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GstDiscovererInfo *info, *cached;
+  gchar *uri, *path, *cache_file, *tmp;
+  gint fd;
+
+  fd = g_file_open_tmp ("gst-discoverer-cache-XXXXXX", &cache_file, &err);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  /* start without a cache file */
+  g_unlink (cache_file);
+
+  path = g_build_filename (GST_TEST_FILES_PATH, "theora-vorbis.ogg", NULL);
+  uri = gst_filename_to_uri (path, &err);
+  g_free (path);
+  fail_unless (err == NULL);
+
+  dc = gst_discoverer_new (10 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  g_object_set (dc, "cache-file", cache_file, NULL);
+  g_object_get (dc, "cache-file", &tmp, NULL);
+  fail_unless_equals_string (tmp, cache_file);
+  g_free (tmp);
+
+  info = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (info != NULL);
+  check_cache_stats (dc, 0, 1);
+
+  if (gst_discoverer_info_get_result (info) != GST_DISCOVERER_OK) {
+    /* nothing is cached for failed discoveries */
+    g_clear_error (&err);
+    gst_discoverer_info_unref (info);
+    info = gst_discoverer_discover_uri (dc, uri, &err);
+    fail_unless (info != NULL);
+    check_cache_stats (dc, 0, 2);
+    g_clear_error (&err);
+    gst_discoverer_info_unref (info);
+    g_object_unref (dc);
+    goto done;
+  }
+
+  /* second time from the in-memory cache */
+  cached = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (cached != NULL);
+  fail_unless (err == NULL);
+  check_cache_stats (dc, 1, 1);
+  fail_unless_equals_uint64 (gst_discoverer_info_get_duration (cached),
+      gst_discoverer_info_get_duration (info));
+  fail_unless_equals_string (gst_discoverer_info_get_uri (cached), uri);
+  gst_discoverer_info_unref (cached);
+
+  /* writes the cache file */
+  g_object_unref (dc);
+  fail_unless (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+
+  /* and from the file with a new discoverer */
+  dc = gst_discoverer_new (10 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  g_object_set (dc, "cache-file", cache_file, NULL);
+  cached = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (cached != NULL);
+  fail_unless (err == NULL);
+  check_cache_stats (dc, 1, 0);
+  fail_unless_equals_int (gst_discoverer_info_get_result (cached),
+      GST_DISCOVERER_OK);
+  fail_unless_equals_uint64 (gst_discoverer_info_get_duration (cached),
+      gst_discoverer_info_get_duration (info));
+  gst_discoverer_info_unref (cached);
+
+  /* results of full discoveries are not used in parse-only mode */
+  g_object_set (dc, "parse-only", TRUE, NULL);
+  cached = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (cached != NULL);
+  g_clear_error (&err);
+  check_cache_stats (dc, 1, 1);
+  gst_discoverer_info_unref (cached);
+  g_object_unref (dc);
+
+  gst_discoverer_info_unref (info);
+
+done:
+  g_unlink (cache_file);
+  g_free (cache_file);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMainLoop *loop;
+  guint starting;
+  guint source_setup;
+  guint discovered;
+  guint in_flight;
+  guint max_in_flight;
+} AsyncData;
+
+static void
+async_starting_cb (GstDiscoverer * dc, AsyncData * data)
+{
+  data->starting++;
+  data->in_flight++;
+  data->max_in_flight = MAX (data->max_in_flight, data->in_flight);
+}
+
+static void
+async_source_setup_cb (GstDiscoverer * dc, GstElement * source,
+    AsyncData * data)
+{
+  fail_unless (GST_IS_ELEMENT (source));
+  data->source_setup++;
+}
+
+static void
+async_discovered_cb (GstDiscoverer * dc, GstDiscovererInfo * info,
+    GError * err, AsyncData * data)
+{
+  fail_unless (info != NULL);
+  fail_unless (gst_discoverer_info_get_uri (info) != NULL);
+  fail_unless (data->in_flight > 0);
+  data->in_flight--;
+  data->discovered++;
+}
+
+static void
+async_finished_cb (GstDiscoverer * dc, AsyncData * data)
+{
+  g_main_loop_quit (data->loop);
+}
+
+static void
+test_disco_async (guint max_workers, guint num)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  AsyncData data = { NULL, 0, 0, 0, 0, 0 };
+  gchar *uri, *path;
+  guint i, workers;
+
+  dc = gst_discoverer_new (10 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+
+  g_object_set (dc, "max-workers", max_workers, NULL);
+  g_object_get (dc, "max-workers", &workers, NULL);
+  fail_unless_equals_int (workers, max_workers);
+
+  path = g_build_filename (GST_TEST_FILES_PATH, "theora-vorbis.ogg", NULL);
+  uri = gst_filename_to_uri (path, &err);
+  g_free (path);
+  fail_unless (err == NULL);
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (dc, "starting", G_CALLBACK (async_starting_cb), &data);
+  g_signal_connect (dc, "source-setup", G_CALLBACK (async_source_setup_cb),
+      &data);
+  g_signal_connect (dc, "discovered", G_CALLBACK (async_discovered_cb), &data);
+  g_signal_connect (dc, "finished", G_CALLBACK (async_finished_cb), &data);
+
+  for (i = 0; i < num; ++i)
+    fail_unless (gst_discoverer_discover_uri_async (dc, uri));
+  gst_discoverer_start (dc);
+
+  g_main_loop_run (data.loop);
+
+  /* every uri is reported exactly once, and only then 'finished' */
+  fail_unless_equals_int (data.discovered, num);
+
+  /* the signals of the workers are forwarded too */
+  fail_unless_equals_int (data.starting, num);
+  fail_unless_equals_int (data.source_setup, num);
+
+  /* the first uris are all started before any of them is reported */
+  fail_unless_equals_int (data.max_in_flight, MIN (max_workers, num));
+  fail_unless_equals_int (data.in_flight, 0);
+
+  gst_discoverer_stop (dc);
+  g_main_loop_unref (data.loop);
+  g_free (uri);
+  g_object_unref (dc);
+}
+
+GST_START_TEST (test_disco_async_single)
+{
+  test_disco_async (1, 3);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_disco_async_workers)
+{
+  test_disco_async (3, 7);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_disco_missing_plugins)
 {
   const gchar *files[] = { "test.mkv", "test.mp3", "partialframe.mjpeg" };
@@ -262,6 +567,11 @@ discoverer_suite (void)
   tcase_add_test (tc_chain, test_disco_sync_reuse_ogg);
   tcase_add_test (tc_chain, test_disco_sync_reuse_mp3);
   tcase_add_test (tc_chain, test_disco_sync_reuse_timeout);
+  tcase_add_test (tc_chain, test_disco_sync_reuse_source);
+  tcase_add_test (tc_chain, test_disco_parse_only);
+  tcase_add_test (tc_chain, test_disco_cache);
+  tcase_add_test (tc_chain, test_disco_async_single);
+  tcase_add_test (tc_chain, test_disco_async_workers);
   tcase_add_test (tc_chain, test_disco_missing_plugins);
   tcase_add_test (tc_chain, test_disco_serializing);
   return s;
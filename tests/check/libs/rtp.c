@@ -793,6 +793,103 @@ GST_START_TEST (test_rtcp_buffer)
 
 GST_END_TEST;
 
+static GstBuffer *
+create_compound_rtcp (gboolean append)
+{
+  gboolean (*add_packet) (GstRTCPBuffer *, GstRTCPType, GstRTCPPacket *);
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  GstBuffer *buf;
+  guint i, j;
+
+  add_packet = append ? gst_rtcp_buffer_append_packet :
+      gst_rtcp_buffer_add_packet;
+
+  buf = gst_rtcp_buffer_new (16384);
+  fail_unless (gst_rtcp_buffer_map (buf, GST_MAP_READWRITE, &rtcp));
+
+  fail_unless (add_packet (&rtcp, GST_RTCP_TYPE_SR, &packet));
+  gst_rtcp_packet_sr_set_sender_info (&packet, 0x44556677,
+      G_GUINT64_CONSTANT (1), 0x11111111, 101, 123456);
+
+  for (i = 0; i < 10; i++) {
+    fail_unless (add_packet (&rtcp, GST_RTCP_TYPE_RR, &packet));
+    gst_rtcp_packet_rr_set_ssrc (&packet, 0x44556677);
+    for (j = 0; j < GST_RTCP_MAX_RB_COUNT; j++)
+      fail_unless (gst_rtcp_packet_add_rb (&packet, i * 100 + j, 0, 0, 0, 0,
+              0, 0));
+  }
+
+  fail_unless (add_packet (&rtcp, GST_RTCP_TYPE_SDES, &packet));
+  fail_unless (gst_rtcp_packet_sdes_add_item (&packet, 0x44556677));
+  fail_unless (gst_rtcp_packet_sdes_add_entry (&packet, GST_RTCP_SDES_CNAME,
+          sizeof ("test@foo.bar"), (guint8 *) "test@foo.bar"));
+
+  fail_unless (add_packet (&rtcp, GST_RTCP_TYPE_PSFB, &packet));
+  gst_rtcp_packet_fb_set_type (&packet, GST_RTCP_PSFB_TYPE_PLI);
+  gst_rtcp_packet_fb_set_sender_ssrc (&packet, 0x44556677);
+  gst_rtcp_packet_fb_set_media_ssrc (&packet, 0x12345678);
+
+  gst_rtcp_buffer_unmap (&rtcp);
+
+  return buf;
+}
+
+GST_START_TEST (test_rtcp_buffer_append_packet)
+{
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  GstBuffer *buf, *ref;
+  GstMapInfo map, refmap;
+  guint32 ssrc;
+  guint count;
+
+  ref = create_compound_rtcp (FALSE);
+  buf = create_compound_rtcp (TRUE);
+
+  fail_unless (gst_rtcp_buffer_validate (buf));
+
+  /* appending must produce the same packets as adding */
+  fail_unless (gst_buffer_map (ref, &refmap, GST_MAP_READ));
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, refmap.size);
+  fail_unless (memcmp (map.data, refmap.data, map.size) == 0);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unmap (ref, &refmap);
+
+  /* walk all packets with a single map */
+  fail_unless (gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp));
+  fail_unless_equals_int (gst_rtcp_buffer_get_packet_count (&rtcp), 13);
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &packet));
+  fail_unless_equals_int (gst_rtcp_packet_get_type (&packet),
+      GST_RTCP_TYPE_SR);
+  count = 0;
+  while (gst_rtcp_packet_move_to_next (&packet) &&
+      gst_rtcp_packet_get_type (&packet) == GST_RTCP_TYPE_RR) {
+    fail_unless_equals_int (gst_rtcp_packet_get_rb_count (&packet),
+        GST_RTCP_MAX_RB_COUNT);
+    gst_rtcp_packet_get_rb (&packet, 1, &ssrc, NULL, NULL, NULL, NULL, NULL,
+        NULL);
+    fail_unless_equals_int (ssrc, count * 100 + 1);
+    count++;
+  }
+  fail_unless_equals_int (count, 10);
+  fail_unless_equals_int (gst_rtcp_packet_get_type (&packet),
+      GST_RTCP_TYPE_SDES);
+  fail_unless (gst_rtcp_packet_move_to_next (&packet));
+  fail_unless_equals_int (gst_rtcp_packet_get_type (&packet),
+      GST_RTCP_TYPE_PSFB);
+  fail_unless_equals_int (gst_rtcp_packet_fb_get_media_ssrc (&packet),
+      0x12345678);
+  fail_if (gst_rtcp_packet_move_to_next (&packet));
+  gst_rtcp_buffer_unmap (&rtcp);
+
+  gst_buffer_unref (buf);
+  gst_buffer_unref (ref);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtcp_reduced_buffer)
 {
   GstBuffer *buf;
@@ -1353,6 +1450,85 @@ GST_START_TEST (test_rtp_buffer_empty_payload)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtp_buffer_peek_header)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPHeaderInfo info;
+  GstBuffer *buf, *hdr, *payload;
+  gpointer data;
+  gsize size;
+  guint8 corrupt[] = { 0x10, 0x60, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00
+  };
+  guint8 ext[] = { 0x01, 0x02, 0x03, 0x04 };
+
+  buf = gst_rtp_buffer_new_allocate (16, 0, 2);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_marker (&rtp, TRUE);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, 0x1234);
+  gst_rtp_buffer_set_timestamp (&rtp, 0x12345678);
+  gst_rtp_buffer_set_ssrc (&rtp, 0xdeadbeef);
+  gst_rtp_buffer_set_csrc (&rtp, 0, 0x11111111);
+  gst_rtp_buffer_set_csrc (&rtp, 1, 0x22222222);
+  fail_unless (gst_rtp_buffer_set_extension_data (&rtp, 0xBEDE, 1));
+  gst_rtp_buffer_unmap (&rtp);
+
+  fail_unless (gst_rtp_buffer_peek_header (buf, &info));
+  fail_unless_equals_int (info.version, GST_RTP_VERSION);
+  fail_unless (info.marker);
+  fail_unless (info.extension);
+  fail_if (info.padding);
+  fail_unless_equals_int (info.payload_type, 96);
+  fail_unless_equals_int (info.seq, 0x1234);
+  fail_unless_equals_int (info.timestamp, 0x12345678);
+  fail_unless_equals_int (info.ssrc, 0xdeadbeef);
+  fail_unless_equals_int (info.csrc_count, 2);
+  fail_unless_equals_int (info.csrc[0], 0x11111111);
+  fail_unless_equals_int (info.csrc[1], 0x22222222);
+  fail_unless_equals_int (info.extension_bits, 0xBEDE);
+  fail_unless_equals_int (info.extension_len, 4);
+  fail_unless_equals_int (info.header_len, 12 + 8 + 4 + 4);
+
+  /* the extension was added in its own memory above, now check the same
+   * packet in a single memory */
+  fail_unless (gst_buffer_n_memory (buf) > 1);
+  gst_buffer_extract_dup (buf, 0, -1, &data, &size);
+  hdr = gst_buffer_new_wrapped (data, size);
+  memset (&info, 0, sizeof (info));
+  fail_unless (gst_rtp_buffer_peek_header (hdr, &info));
+  fail_unless_equals_int (info.ssrc, 0xdeadbeef);
+  fail_unless_equals_int (info.extension_bits, 0xBEDE);
+  fail_unless_equals_int (info.header_len, 12 + 8 + 4 + 4);
+  gst_buffer_unref (hdr);
+
+  /* CSRCs must be in the first memory */
+  hdr = gst_buffer_copy_region (buf, GST_BUFFER_COPY_ALL, 0, 16);
+  payload = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, 16,
+      gst_buffer_get_size (buf) - 16);
+  hdr = gst_buffer_append (hdr, payload);
+  fail_if (gst_rtp_buffer_peek_header (hdr, NULL));
+  gst_buffer_unref (hdr);
+  gst_buffer_unref (buf);
+
+  /* wrong version */
+  buf = gst_buffer_new_and_alloc (sizeof (corrupt));
+  gst_buffer_fill (buf, 0, corrupt, sizeof (corrupt));
+  fail_if (gst_rtp_buffer_peek_header (buf, NULL));
+  gst_buffer_unref (buf);
+
+  /* extension length pointing past the end of the packet */
+  corrupt[0] = 0x90;
+  buf = gst_buffer_new_and_alloc (sizeof (corrupt));
+  gst_buffer_fill (buf, 0, corrupt, sizeof (corrupt));
+  buf = gst_buffer_append (buf, gst_buffer_new_wrapped (g_memdup (ext,
+              sizeof (ext)), sizeof (ext)));
+  fail_if (gst_rtp_buffer_peek_header (buf, NULL));
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 
 GST_START_TEST (test_ext_timestamp_basic)
 {
@@ -1453,6 +1629,7 @@ rtp_suite (void)
 
   tcase_add_test (tc_chain, test_rtcp_buffer);
   tcase_add_test (tc_chain, test_rtcp_reduced_buffer);
+  tcase_add_test (tc_chain, test_rtcp_buffer_append_packet);
   tcase_add_test (tc_chain, test_rtcp_validate_with_padding);
   tcase_add_test (tc_chain, test_rtcp_validate_with_padding_wrong_padlength);
   tcase_add_test (tc_chain,
@@ -1470,6 +1647,7 @@ rtp_suite (void)
   tcase_add_test (tc_chain, test_rtp_buffer_get_payload_bytes);
   tcase_add_test (tc_chain, test_rtp_buffer_get_extension_bytes);
   tcase_add_test (tc_chain, test_rtp_buffer_empty_payload);
+  tcase_add_test (tc_chain, test_rtp_buffer_peek_header);
 
   //tcase_add_test (tc_chain, test_rtp_buffer_list);
 
@@ -160,6 +160,61 @@ gst_rtp_dummy_depay_set_caps (GstRTPBaseDepayload * filter, GstCaps * caps)
   return TRUE;
 }
 
+/* GstRtpDummyListDepay */
+
+#define GST_TYPE_RTP_DUMMY_LIST_DEPAY \
+  (gst_rtp_dummy_list_depay_get_type())
+
+typedef struct _GstRtpDummyDepay GstRtpDummyListDepay;
+typedef struct _GstRtpDummyDepayClass GstRtpDummyListDepayClass;
+
+GType gst_rtp_dummy_list_depay_get_type (void);
+
+G_DEFINE_TYPE (GstRtpDummyListDepay, gst_rtp_dummy_list_depay,
+    GST_TYPE_RTP_DUMMY_DEPAY);
+
+static guint list_process_calls;
+static guint list_process_packets;
+
+static GstBufferList *
+gst_rtp_dummy_list_depay_process_list (GstRTPBaseDepayload * depayload,
+    GstRTPBuffer * rtp_buffers, guint n_rtp_buffers)
+{
+  GstBufferList *list;
+  guint i;
+
+  list_process_calls++;
+  list_process_packets += n_rtp_buffers;
+
+  list = gst_buffer_list_new_sized (n_rtp_buffers);
+  for (i = 0; i < n_rtp_buffers; i++) {
+    GstBuffer *outbuf = gst_rtp_buffer_get_payload_buffer (&rtp_buffers[i]);
+
+    GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (rtp_buffers[i].buffer);
+    if (i > 0 && GST_BUFFER_IS_DISCONT (rtp_buffers[i].buffer))
+      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    gst_buffer_list_add (list, outbuf);
+  }
+
+  return list;
+}
+
+static void
+gst_rtp_dummy_list_depay_class_init (GstRtpDummyListDepayClass * klass)
+{
+  GstRTPBaseDepayloadClass *gstrtpbasedepayload_class;
+
+  gstrtpbasedepayload_class = GST_RTP_BASE_DEPAYLOAD_CLASS (klass);
+
+  gstrtpbasedepayload_class->process_rtp_packet_list =
+      gst_rtp_dummy_list_depay_process_list;
+}
+
+static void
+gst_rtp_dummy_list_depay_init (GstRtpDummyListDepay * depay)
+{
+}
+
 /* Helper functions and global state */
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
@@ -489,20 +544,18 @@ validate_buffer (guint index, const gchar * field, ...)
 }
 
 static State *
-create_depayloader (const gchar * caps_str, const gchar * property, ...)
+create_depayloader_valist (GType type, const gchar * caps_str,
+    const gchar * property, va_list var_args)
 {
-  va_list var_args;
   GstCaps *caps;
   State *state;
 
   state = g_new0 (State, 1);
 
-  state->element = GST_ELEMENT (rtp_dummy_depay_new ());
+  state->element = GST_ELEMENT (g_object_new (type, NULL));
   fail_unless (GST_IS_RTP_DUMMY_DEPAY (state->element));
 
-  va_start (var_args, property);
   g_object_set_valist (G_OBJECT (state->element), property, var_args);
-  va_end (var_args);
 
   state->srcpad = gst_check_setup_src_pad (state->element, &srctemplate);
   state->sinkpad = gst_check_setup_sink_pad (state->element, &sinktemplate);
@@ -526,6 +579,34 @@ create_depayloader (const gchar * caps_str, const gchar * property, ...)
   return state;
 }
 
+static State *
+create_depayloader (const gchar * caps_str, const gchar * property, ...)
+{
+  va_list var_args;
+  State *state;
+
+  va_start (var_args, property);
+  state = create_depayloader_valist (GST_TYPE_RTP_DUMMY_DEPAY, caps_str,
+      property, var_args);
+  va_end (var_args);
+
+  return state;
+}
+
+static State *
+create_list_depayloader (const gchar * caps_str, const gchar * property, ...)
+{
+  va_list var_args;
+  State *state;
+
+  va_start (var_args, property);
+  state = create_depayloader_valist (GST_TYPE_RTP_DUMMY_LIST_DEPAY, caps_str,
+      property, var_args);
+  va_end (var_args);
+
+  return state;
+}
+
 static void
 set_state (State * state, GstState new_state)
 {
@@ -1318,6 +1399,65 @@ GST_START_TEST (rtp_base_depayload_source_info_test)
 
 GST_END_TEST;
 
+/* push a list of RTP packets to a depayloader implementing
+ * process_rtp_packet_list. the whole list should be handed to the subclass in
+ * a single call, with the duplicate packet already filtered out and the packet
+ * following the gap flagged as DISCONT.
+ */
+GST_START_TEST (rtp_base_depayload_process_list_test)
+{
+  GstBufferList *list;
+  GstBuffer *buf;
+  State *state;
+  guint i;
+  static const guint seqnums[] = { 0x4242, 0x4243, 0x4243, 0x4245 };
+
+  list_process_calls = 0;
+  list_process_packets = 0;
+
+  state = create_list_depayloader ("application/x-rtp", NULL);
+
+  set_state (state, GST_STATE_PLAYING);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (seqnums); i++) {
+    buf = gst_rtp_buffer_new_allocate (0, 0, 0);
+    rtp_buffer_set (buf, "pts", i * GST_SECOND,
+        "rtptime", G_GUINT64_CONSTANT (0x1234) + i * DEFAULT_CLOCK_RATE,
+        "seq", seqnums[i], NULL);
+    gst_buffer_list_add (list, buf);
+  }
+
+  fail_unless_equals_int (gst_pad_push_list (state->srcpad, list),
+      GST_FLOW_OK);
+
+  set_state (state, GST_STATE_NULL);
+
+  fail_unless_equals_int (list_process_calls, 1);
+  fail_unless_equals_int (list_process_packets, 3);
+
+  validate_buffers_received (3);
+
+  validate_buffer (0, "pts", 0 * GST_SECOND, "discont", FALSE, NULL);
+
+  validate_buffer (1, "pts", 1 * GST_SECOND, "discont", FALSE, NULL);
+
+  validate_buffer (2, "pts", 3 * GST_SECOND, "discont", TRUE, NULL);
+
+  validate_events_received (3);
+
+  validate_event (0, "stream-start", NULL);
+
+  validate_event (1, "caps", "media-type", "application/x-rtp", NULL);
+
+  validate_event (2, "segment",
+      "time", G_GUINT64_CONSTANT (0),
+      "start", G_GUINT64_CONSTANT (0), "stop", G_MAXUINT64, NULL);
+
+  destroy_depayloader (state);
+}
+
+GST_END_TEST
 
 static Suite *
 rtp_basepayloading_suite (void)
@@ -1349,6 +1489,8 @@ rtp_basepayloading_suite (void)
 
   tcase_add_test (tc_chain, rtp_base_depayload_source_info_test);
 
+  tcase_add_test (tc_chain, rtp_base_depayload_process_list_test);
+
   return s;
 }
 
@@ -1855,6 +1855,106 @@ GST_START_TEST (rtp_base_payload_property_source_info_test)
 
 GST_END_TEST;
 
+static void
+validate_fragments (GstBufferList * list, const guint8 * data, guint n_packets,
+    guint max_payload_len, guint size)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint i;
+
+  fail_unless_equals_int (gst_buffer_list_length (list), n_packets);
+
+  for (i = 0; i < n_packets; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    guint len = MIN (size - i * max_payload_len, max_payload_len);
+
+    /* header from the pool, followed by the payload memory */
+    fail_unless (buffer->pool != NULL);
+    fail_unless_equals_int (gst_buffer_n_memory (buffer), 2);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), GST_SECOND);
+
+    fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_csrc_count (&rtp), 0);
+    fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), len);
+    fail_unless_equals_int (gst_rtp_buffer_get_marker (&rtp),
+        i == n_packets - 1);
+    fail_unless (memcmp (gst_rtp_buffer_get_payload (&rtp),
+            data + i * max_payload_len, len) == 0);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+}
+
+/* split a buffer into RTP packets with pooled headers, the payload memory
+ * must be shared with the input buffer */
+GST_START_TEST (rtp_base_payload_fragment_buffer_test)
+{
+  GstRtpDummyPay *pay;
+  GstBuffer *buffer;
+  GstBufferList *list;
+  GstMemory *mem;
+  guint8 data[200];
+  guint i;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i;
+
+  pay = rtp_dummy_pay_new ();
+  g_object_set (pay, "mtu", 100, NULL);
+
+  buffer = gst_buffer_new_wrapped (g_memdup (data, sizeof (data)),
+      sizeof (data));
+  GST_BUFFER_PTS (buffer) = GST_SECOND;
+
+  /* the MTU leaves room for 88 bytes of payload */
+  list = gst_rtp_base_payload_fragment_buffer (GST_RTP_BASE_PAYLOAD (pay),
+      buffer, 0, 0);
+  validate_fragments (list, data, 3, 88, sizeof (data));
+  mem = gst_buffer_peek_memory (gst_buffer_list_get (list, 1), 1);
+  fail_unless (mem->parent == gst_buffer_peek_memory (buffer, 0));
+  gst_buffer_list_unref (list);
+
+  /* the headers are reused and must not keep the marker */
+  list = gst_rtp_base_payload_fragment_buffer (GST_RTP_BASE_PAYLOAD (pay),
+      buffer, 150, 0);
+  validate_fragments (list, data, 2, 150, sizeof (data));
+  gst_buffer_list_unref (list);
+
+  /* the whole input memory is referenced when it fits in one packet */
+  list = gst_rtp_base_payload_fragment_buffer (GST_RTP_BASE_PAYLOAD (pay),
+      buffer, 1000, 0);
+  validate_fragments (list, data, 1, 1000, sizeof (data));
+  mem = gst_buffer_peek_memory (gst_buffer_list_get (list, 0), 1);
+  fail_unless (mem == gst_buffer_peek_memory (buffer, 0));
+  gst_buffer_list_unref (list);
+
+  /* a header memory that was replaced is not recycled by the pool */
+  list = gst_rtp_base_payload_fragment_buffer (GST_RTP_BASE_PAYLOAD (pay),
+      buffer, 0, 0);
+  mem = gst_allocator_alloc (NULL, 100, NULL);
+  gst_buffer_replace_memory (gst_buffer_list_get (list, 0), 0,
+      gst_memory_ref (mem));
+  gst_buffer_list_unref (list);
+
+  /* only the first packet is marked as a discontinuity */
+  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+  list = gst_rtp_base_payload_fragment_buffer (GST_RTP_BASE_PAYLOAD (pay),
+      buffer, 0, 0);
+  validate_fragments (list, data, 3, 88, sizeof (data));
+  for (i = 0; i < 3; i++) {
+    GstBuffer *outbuf = gst_buffer_list_get (list, i);
+
+    fail_unless (gst_buffer_peek_memory (outbuf, 0) != mem);
+    fail_unless_equals_int (GST_BUFFER_IS_DISCONT (outbuf), i == 0);
+  }
+  gst_buffer_list_unref (list);
+  gst_memory_unref (mem);
+
+  gst_buffer_unref (buffer);
+  g_object_unref (pay);
+}
+
+GST_END_TEST;
+
 /* push a single buffer to the payloader which should successfully payload it
  * into an RTP packet. besides the payloaded RTP packet there should be the
  * three events initial events: stream-start, caps and segment. because of that
@@ -1959,6 +2059,7 @@ rtp_basepayloading_suite (void)
   tcase_add_test (tc_chain, rtp_base_payload_property_ptime_multiple_test);
   tcase_add_test (tc_chain, rtp_base_payload_property_stats_test);
   tcase_add_test (tc_chain, rtp_base_payload_property_source_info_test);
+  tcase_add_test (tc_chain, rtp_base_payload_fragment_buffer_test);
 
   tcase_add_test (tc_chain, rtp_base_payload_framerate_attribute);
   tcase_add_test (tc_chain, rtp_base_payload_max_framerate_attribute);
@@ -652,6 +652,148 @@ GST_START_TEST (test_rtsp_message)
 
 GST_END_TEST;
 
+/* Memory that is mapped into a temporary copy, like some hardware memories */
+typedef struct
+{
+  GstMemory mem;
+  guint8 *data;
+  guint8 *copy;
+} TestCopyMemory;
+
+typedef GstAllocator TestCopyAllocator;
+typedef GstAllocatorClass TestCopyAllocatorClass;
+
+static GType test_copy_allocator_get_type (void);
+G_DEFINE_TYPE (TestCopyAllocator, test_copy_allocator, GST_TYPE_ALLOCATOR);
+
+static gint test_copy_mapped = 0;
+
+static void
+test_copy_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  TestCopyMemory *cmem = (TestCopyMemory *) mem;
+
+  g_free (cmem->data);
+  g_slice_free (TestCopyMemory, cmem);
+}
+
+static gpointer
+test_copy_mem_map (GstMemory * mem, gsize maxsize, GstMapFlags flags)
+{
+  TestCopyMemory *cmem = (TestCopyMemory *) mem;
+
+  cmem->copy = g_memdup (cmem->data, mem->maxsize);
+  g_atomic_int_inc (&test_copy_mapped);
+
+  return cmem->copy;
+}
+
+static void
+test_copy_mem_unmap (GstMemory * mem)
+{
+  TestCopyMemory *cmem = (TestCopyMemory *) mem;
+
+  /* poison the copy to catch users of the unmapped data */
+  memset (cmem->copy, 0xaa, mem->maxsize);
+  g_free (cmem->copy);
+  cmem->copy = NULL;
+  g_atomic_int_add (&test_copy_mapped, -1);
+}
+
+static void
+test_copy_allocator_class_init (TestCopyAllocatorClass * klass)
+{
+  klass->free = test_copy_allocator_free;
+}
+
+static void
+test_copy_allocator_init (TestCopyAllocator * allocator)
+{
+  allocator->mem_type = "TestCopyMemory";
+  allocator->mem_map = test_copy_mem_map;
+  allocator->mem_unmap = test_copy_mem_unmap;
+
+  GST_OBJECT_FLAG_SET (allocator, GST_ALLOCATOR_FLAG_CUSTOM_ALLOC);
+}
+
+static GstBuffer *
+test_copy_buffer_new (const gchar * data, gsize size)
+{
+  GstAllocator *allocator;
+  TestCopyMemory *cmem;
+  GstBuffer *buffer;
+
+  allocator = g_object_new (test_copy_allocator_get_type (), NULL);
+  cmem = g_slice_new0 (TestCopyMemory);
+  gst_memory_init (GST_MEMORY_CAST (cmem), 0, allocator, NULL, size, 0, 0,
+      size);
+  cmem->data = g_memdup (data, size);
+  gst_object_unref (allocator);
+
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer, GST_MEMORY_CAST (cmem));
+
+  return buffer;
+}
+
+GST_START_TEST (test_rtsp_message_body)
+{
+  GstRTSPMessage *msg;
+  GstRTSPResult res;
+  GstBuffer *buffer;
+  guint8 *data;
+  guint size;
+
+  res = gst_rtsp_message_new_data (&msg, 0);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+
+  /* a single memory buffer body stays mapped while the message holds it */
+  buffer = test_copy_buffer_new ("payload", 8);
+  res = gst_rtsp_message_take_body_buffer (msg, buffer);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless_equals_int (g_atomic_int_get (&test_copy_mapped), 1);
+
+  res = gst_rtsp_message_get_body (msg, &data, &size);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless_equals_int (size, 8);
+  fail_unless_equals_string ((gchar *) data, "payload");
+
+  res = gst_rtsp_message_steal_body_buffer (msg, &buffer);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless_equals_int (g_atomic_int_get (&test_copy_mapped), 0);
+  fail_unless (gst_buffer_memcmp (buffer, 0, "payload", 8) == 0);
+  gst_buffer_unref (buffer);
+
+  buffer = test_copy_buffer_new ("payload", 8);
+  res = gst_rtsp_message_take_body_buffer (msg, buffer);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  res = gst_rtsp_message_unset (msg);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless_equals_int (g_atomic_int_get (&test_copy_mapped), 0);
+
+  /* a body assigned to the public fields is owned by the message */
+  res = gst_rtsp_message_init_data (msg, 0);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  msg->body = (guint8 *) g_strdup ("direct");
+  msg->body_size = 7;
+  res = gst_rtsp_message_get_body (msg, &data, &size);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless (data == msg->body);
+  res = gst_rtsp_message_steal_body (msg, &data, &size);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+  fail_unless_equals_int (size, 7);
+  fail_unless_equals_string ((gchar *) data, "direct");
+  g_free (data);
+
+  /* and freed with it */
+  msg->body = (guint8 *) g_strdup ("direct");
+  msg->body_size = 7;
+  res = gst_rtsp_message_free (msg);
+  fail_unless_equals_int (res, GST_RTSP_OK);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtsp_message_auth_credentials)
 {
   GstRTSPMessage *msg;
@@ -983,6 +1125,7 @@ rtsp_suite (void)
   tcase_add_test (tc_chain, test_rtsp_range_clock);
   tcase_add_test (tc_chain, test_rtsp_range_convert);
   tcase_add_test (tc_chain, test_rtsp_message);
+  tcase_add_test (tc_chain, test_rtsp_message_body);
   tcase_add_test (tc_chain, test_rtsp_message_auth_credentials);
   tcase_add_test (tc_chain, test_rtsp_message_auth_credentials_boxed);
 
@@ -44,6 +44,8 @@ static guint tunnel_post_count;
 static guint tunnel_lost_count;
 static guint closed_count;
 static guint message_sent_count;
+static guint backlog_high_count;
+static guint backlog_low_count;
 
 typedef struct
 {
@@ -181,6 +183,20 @@ message_sent (GstRTSPWatch * watch, guint id, gpointer user_data)
   return GST_RTSP_OK;
 }
 
+static GstRTSPResult
+backlog_high (GstRTSPWatch * watch, gpointer user_data)
+{
+  backlog_high_count++;
+  return GST_RTSP_OK;
+}
+
+static GstRTSPResult
+backlog_low (GstRTSPWatch * watch, gpointer user_data)
+{
+  backlog_low_count++;
+  return GST_RTSP_OK;
+}
+
 static GstRTSPWatchFuncs watch_funcs = {
   NULL,
   message_sent,
@@ -189,7 +205,10 @@ static GstRTSPWatchFuncs watch_funcs = {
   tunnel_get,
   tunnel_post,
   NULL,
-  tunnel_lost
+  tunnel_lost,
+  NULL,
+  backlog_high,
+  backlog_low
 };
 
 /* setts up a new tunnel, then disconnects the read connection and creates it
@@ -664,6 +683,304 @@ GST_START_TEST (test_rtspconnection_send_receive_check_headers)
 
 GST_END_TEST;
 
+static gpointer
+read_lazy_header (const GstRTSPMessage * msg)
+{
+  gchar *header_val = NULL;
+  gint i;
+
+  for (i = 0; i < 100; i++) {
+    if (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT, &header_val,
+            2) != GST_RTSP_OK || g_strcmp0 (header_val, "application/rtsl"))
+      return GINT_TO_POINTER (FALSE);
+  }
+  return GINT_TO_POINTER (TRUE);
+}
+
+GST_START_TEST (test_rtspconnection_lazy_headers)
+{
+  GSocketConnection *input_conn = NULL;
+  GSocketConnection *output_conn = NULL;
+  GSocket *input_sock;
+  GOutputStream *ostream;
+  GstRTSPConnection *rtsp_input_conn;
+  GstRTSPMessage *msg;
+  GstRTSPMessage *copy;
+  GstRTSPMessage *shared;
+  GThread *threads[4];
+  gchar *header_val;
+  gsize size;
+  gint i;
+  static const gchar data[] =
+      "OPTIONS rtsp://example.com/ RTSP/1.0\r\n"
+      "CSeq: 1\r\n"
+      "Accept: application/sdp, text/plain ,application/rtsl\r\n"
+      "Accept: text/html\r\n"
+      "Custom-Header: a, b\r\n\r\n";
+
+  create_connection (&input_conn, &output_conn);
+  input_sock = g_socket_connection_get_socket (input_conn);
+  fail_unless (input_sock != NULL);
+  ostream = g_io_stream_get_output_stream (G_IO_STREAM (output_conn));
+  fail_unless (ostream != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (input_sock, "127.0.0.1",
+          4444, NULL, &rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_input_conn != NULL);
+
+  fail_if (gst_rtsp_connection_get_lazy_headers (rtsp_input_conn));
+  gst_rtsp_connection_set_lazy_headers (rtsp_input_conn, TRUE);
+  fail_unless (gst_rtsp_connection_get_lazy_headers (rtsp_input_conn));
+
+  fail_unless (g_output_stream_write_all (ostream, data, sizeof (data) - 1,
+          &size, NULL, NULL));
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+
+  /* a copy keeps the values that were not split yet */
+  fail_unless (gst_rtsp_message_copy (msg, &copy) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_copy (msg, &shared) == GST_RTSP_OK);
+
+  /* the values are split as if they were parsed right away */
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT,
+          &header_val, 1) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "text/plain");
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT,
+          &header_val, 2) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "application/rtsl");
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT,
+          &header_val, 3) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "text/html");
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT,
+          &header_val, 4) == GST_RTSP_ENOTIMPL);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_CSEQ,
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "1");
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_SESSION,
+          &header_val, 0) == GST_RTSP_ENOTIMPL);
+
+  /* custom headers are never split */
+  fail_unless (gst_rtsp_message_get_header_by_name (msg, "custom-header",
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "a, b");
+  fail_unless (gst_rtsp_message_get_header_by_name (msg, "Other-Header",
+          &header_val, 0) == GST_RTSP_ENOTIMPL);
+
+  fail_unless (gst_rtsp_message_remove_header (msg, GST_RTSP_HDR_ACCEPT,
+          0) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_ACCEPT,
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "text/plain");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_message_remove_header (copy, GST_RTSP_HDR_ACCEPT,
+          0) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_header_by_name (copy, "Accept",
+          &header_val, 2) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "text/html");
+  fail_unless (gst_rtsp_message_remove_header_by_name (copy, "Custom-Header",
+          -1) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_header_by_name (copy, "Custom-Header",
+          &header_val, 0) == GST_RTSP_ENOTIMPL);
+  fail_unless (gst_rtsp_message_free (copy) == GST_RTSP_OK);
+
+  /* the values can be split by several readers at once */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("reader", (GThreadFunc) read_lazy_header,
+        shared);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    fail_unless (GPOINTER_TO_INT (g_thread_join (threads[i])));
+  fail_unless (gst_rtsp_message_free (shared) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_connection_close (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_input_conn) == GST_RTSP_OK);
+
+  g_object_unref (input_conn);
+  g_object_unref (output_conn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtspconnection_send_receive_body_buffer)
+{
+  GSocketConnection *input_conn = NULL;
+  GSocketConnection *output_conn = NULL;
+  GSocket *input_sock;
+  GSocket *output_sock;
+  GstRTSPConnection *rtsp_output_conn;
+  GstRTSPConnection *rtsp_input_conn;
+  GstRTSPWatch *watch;
+  GstRTSPMessage *msg;
+  GstBuffer *buffer;
+  guint8 *recv_body;
+  guint recv_body_len;
+
+  create_connection (&input_conn, &output_conn);
+  input_sock = g_socket_connection_get_socket (input_conn);
+  fail_unless (input_sock != NULL);
+  output_sock = g_socket_connection_get_socket (output_conn);
+  fail_unless (output_sock != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (input_sock, "127.0.0.1",
+          4444, NULL, &rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_input_conn != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (output_sock, "127.0.0.1",
+          4444, NULL, &rtsp_output_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_output_conn != NULL);
+
+  /* a body made of two memories */
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) "mess", 4,
+          0, 4, NULL, NULL));
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) "age", 4, 0,
+          4, NULL, NULL));
+
+  /* send data message */
+  fail_unless (gst_rtsp_message_new_data (&msg, 1) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_set_body_buffer (msg, buffer) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_has_body_buffer (msg));
+  fail_unless (gst_rtsp_connection_send (rtsp_output_conn, msg,
+          NULL) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_DATA);
+  fail_unless (gst_rtsp_message_get_body (msg, &recv_body,
+          &recv_body_len) == GST_RTSP_OK);
+  fail_unless_equals_int (recv_body_len, 9);
+  fail_unless_equals_string ((gchar *) recv_body, "message");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  /* and a request with the same body through a watch */
+  watch = gst_rtsp_watch_new (rtsp_output_conn, &watch_funcs, NULL, NULL);
+  fail_unless (watch != NULL);
+  fail_unless (gst_rtsp_watch_attach (watch, NULL) > 0);
+  g_source_unref ((GSource *) watch);
+
+  fail_unless (gst_rtsp_message_new_request (&msg, GST_RTSP_SET_PARAMETER,
+          "rtsp://example.com/") == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_take_body_buffer (msg, buffer) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_watch_send_message (watch, msg, NULL) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+  fail_unless (gst_rtsp_message_get_body_buffer (msg, &buffer) == GST_RTSP_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 9);
+  fail_unless (gst_buffer_memcmp (buffer, 0, "message", 8) == 0);
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  g_source_destroy ((GSource *) watch);
+
+  fail_unless (gst_rtsp_connection_close (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_close (rtsp_output_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_output_conn) == GST_RTSP_OK);
+
+  g_object_unref (input_conn);
+  g_object_unref (output_conn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtspconnection_receive_buffered)
+{
+  GSocketConnection *input_conn = NULL;
+  GSocketConnection *output_conn = NULL;
+  GSocket *input_sock;
+  GOutputStream *ostream;
+  GstRTSPConnection *rtsp_input_conn;
+  GstRTSPMessage *msg;
+  GstRTSPEvent event;
+  gchar *header_val;
+  guint8 *recv_body;
+  guint recv_body_len;
+  gsize size;
+  GTimeVal tv;
+  /* two requests and a data message, delivered in one go */
+  static const gchar data[] =
+      "OPTIONS rtsp://example.com/ RTSP/1.0\r\n"
+      "CSeq: 1\r\n"
+      "Custom-Header: value\r\n\r\n"
+      "GET_PARAMETER rtsp://example.com/ RTSP/1.0\r\n"
+      "CSeq: 2\r\n"
+      "Content-Length: 4\r\n\r\n"
+      "body" "$\001\000\003abc";
+
+  create_connection (&input_conn, &output_conn);
+  input_sock = g_socket_connection_get_socket (input_conn);
+  fail_unless (input_sock != NULL);
+  ostream = g_io_stream_get_output_stream (G_IO_STREAM (output_conn));
+  fail_unless (ostream != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (input_sock, "127.0.0.1",
+          4444, NULL, &rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_input_conn != NULL);
+
+  fail_unless (g_output_stream_write_all (ostream, data, sizeof (data) - 1,
+          &size, NULL, NULL));
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_CSEQ,
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "1");
+  fail_unless (gst_rtsp_message_get_header_by_name (msg, "Custom-Header",
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "value");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  /* the rest was buffered and is readable without touching the socket */
+  tv.tv_sec = 0;
+  tv.tv_usec = 0;
+  fail_unless (gst_rtsp_connection_poll (rtsp_input_conn, GST_RTSP_EV_READ,
+          &event, &tv) == GST_RTSP_OK);
+  fail_unless (event & GST_RTSP_EV_READ);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_CSEQ,
+          &header_val, 0) == GST_RTSP_OK);
+  fail_unless_equals_string (header_val, "2");
+  fail_unless (gst_rtsp_message_get_body (msg, &recv_body,
+          &recv_body_len) == GST_RTSP_OK);
+  fail_unless_equals_int (recv_body_len, 5);
+  fail_unless_equals_string ((gchar *) recv_body, "body");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_DATA);
+  fail_unless (gst_rtsp_message_get_body (msg, &recv_body,
+          &recv_body_len) == GST_RTSP_OK);
+  fail_unless_equals_int (recv_body_len, 4);
+  fail_unless_equals_string ((gchar *) recv_body, "abc");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_connection_close (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_input_conn) == GST_RTSP_OK);
+
+  g_object_unref (input_conn);
+  g_object_unref (output_conn);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtspconnection_connect)
 {
   ServiceData *data;
@@ -840,6 +1157,174 @@ GST_START_TEST (test_rtspconnection_backlog)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtspconnection_send_messages)
+{
+  GSocketConnection *input_conn = NULL;
+  GSocketConnection *output_conn = NULL;
+  GSocket *input_sock;
+  GSocket *output_sock;
+  GstRTSPConnection *rtsp_output_conn;
+  GstRTSPConnection *rtsp_input_conn;
+  GstRTSPMessage messages[3] = { {0}, };
+  GstRTSPMessage *msg;
+  gchar body[] = "message body";
+  gchar *recv_body;
+  guint recv_body_len;
+  guint i;
+
+  create_connection (&input_conn, &output_conn);
+  input_sock = g_socket_connection_get_socket (input_conn);
+  fail_unless (input_sock != NULL);
+  output_sock = g_socket_connection_get_socket (output_conn);
+  fail_unless (output_sock != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (input_sock, "127.0.0.1",
+          4444, NULL, &rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_input_conn != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (output_sock, "127.0.0.1",
+          4444, NULL, &rtsp_output_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_output_conn != NULL);
+
+  /* send two data messages and a request in one go */
+  fail_unless (gst_rtsp_message_init_data (&messages[0], 0) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_init_data (&messages[1], 1) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_init_request (&messages[2], GST_RTSP_OPTIONS,
+          "example.org") == GST_RTSP_OK);
+  for (i = 0; i < 3; i++) {
+    fail_unless (gst_rtsp_message_set_body (&messages[i], (guint8 *) body,
+            sizeof (body)) == GST_RTSP_OK);
+  }
+  fail_unless (gst_rtsp_connection_send_messages (rtsp_output_conn, messages,
+          3, NULL) == GST_RTSP_OK);
+  for (i = 0; i < 3; i++)
+    fail_unless (gst_rtsp_message_unset (&messages[i]) == GST_RTSP_OK);
+
+  /* receive the messages in order and make sure they are correct */
+  for (i = 0; i < 3; i++) {
+    fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+    fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+        GST_RTSP_OK);
+    if (i < 2) {
+      fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_DATA);
+      fail_unless_equals_int (msg->type_data.data.channel, i);
+    } else {
+      fail_unless (gst_rtsp_message_get_type (msg) ==
+          GST_RTSP_MESSAGE_REQUEST);
+    }
+    fail_unless (gst_rtsp_message_get_body (msg, (guint8 **) & recv_body,
+            &recv_body_len) == GST_RTSP_OK);
+    /* RTSPConnection adds an extra byte for the trailing '\0' */
+    fail_unless_equals_int (recv_body_len, sizeof (body) + 1);
+    fail_unless_equals_string (recv_body, body);
+    fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+  }
+
+  fail_unless (gst_rtsp_connection_close (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_close (rtsp_output_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_output_conn) == GST_RTSP_OK);
+
+  g_object_unref (input_conn);
+  g_object_unref (output_conn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtspconnection_watch_watermarks)
+{
+  GSocketConnection *conn1 = NULL;
+  GSocketConnection *conn2 = NULL;
+  GSocket *sock;
+  GstRTSPConnection *rtsp_conn = NULL;
+  GstRTSPWatch *watch;
+  GInputStream *istream;
+  GstRTSPMessage messages[4] = { {0}, };
+  guint8 recv[1024];
+  gsize count;
+  guint64 bytes_sent, messages_sent, bytes_read = 0;
+  guint64 total_bytes = 0, total_messages = 0;
+  gsize bytes_queued;
+  guint messages_queued;
+  guint i;
+
+  create_connection (&conn1, &conn2);
+  sock = g_socket_connection_get_socket (conn1);
+  fail_unless (sock != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (sock, "127.0.0.1",
+          4444, NULL, &rtsp_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_conn != NULL);
+
+  watch = gst_rtsp_watch_new (rtsp_conn, &watch_funcs, NULL, NULL);
+  fail_unless (watch != NULL);
+  fail_unless (gst_rtsp_watch_attach (watch, NULL) > 0);
+  g_source_unref ((GSource *) watch);
+
+  gst_rtsp_watch_set_send_watermarks (watch, 16 * 1024, 4 * 1024);
+  backlog_high_count = 0;
+  backlog_low_count = 0;
+
+  /* send batches of data messages until the socket is full and the queue
+   * reaches the high watermark */
+  while (backlog_high_count == 0) {
+    for (i = 0; i < 4; i++) {
+      fail_unless (gst_rtsp_message_init_data (&messages[i], i) ==
+          GST_RTSP_OK);
+      fail_unless (gst_rtsp_message_take_body (&messages[i],
+              g_malloc0 (1024), 1024) == GST_RTSP_OK);
+    }
+    fail_unless (gst_rtsp_watch_send_messages (watch, messages, 4,
+            NULL) == GST_RTSP_OK);
+    for (i = 0; i < 4; i++)
+      gst_rtsp_message_unset (&messages[i]);
+
+    total_bytes += 4 * (4 + 1024);
+    total_messages += 4;
+  }
+  fail_unless_equals_int (backlog_low_count, 0);
+
+  gst_rtsp_watch_get_send_stats (watch, &bytes_sent, &messages_sent,
+      &bytes_queued, &messages_queued);
+  fail_unless (bytes_queued >= 16 * 1024);
+  fail_unless (messages_queued > 0);
+  fail_unless_equals_uint64 (bytes_sent + bytes_queued, total_bytes);
+  fail_unless_equals_uint64 (messages_sent + messages_queued, total_messages);
+
+  istream = g_io_stream_get_input_stream (G_IO_STREAM (conn2));
+  fail_unless (istream != NULL);
+
+  /* read what was sent and let the watch write the queue until the low
+   * watermark is reached */
+  while (backlog_low_count == 0) {
+    gst_rtsp_watch_get_send_stats (watch, &bytes_sent, NULL, NULL, NULL);
+    if (bytes_sent > bytes_read) {
+      gsize to_read = MIN (bytes_sent - bytes_read, sizeof (recv));
+
+      fail_unless (g_input_stream_read_all (istream, recv, to_read, &count,
+              NULL, NULL));
+      bytes_read += count;
+      g_main_context_iteration (NULL, FALSE);
+    } else {
+      g_main_context_iteration (NULL, TRUE);
+    }
+  }
+  fail_unless_equals_int (backlog_high_count, 1);
+
+  gst_rtsp_watch_get_send_stats (watch, &bytes_sent, &messages_sent,
+      &bytes_queued, &messages_queued);
+  fail_unless_equals_uint64 (bytes_sent + bytes_queued, total_bytes);
+  fail_unless_equals_uint64 (messages_sent + messages_queued, total_messages);
+
+  g_source_destroy ((GSource *) watch);
+  fail_unless (gst_rtsp_connection_close (rtsp_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_conn) == GST_RTSP_OK);
+  g_object_unref (conn1);
+  g_object_unref (conn2);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtspconnection_ip)
 {
   GstRTSPConnection *conn = NULL;
@@ -871,9 +1356,14 @@ rtspconnection_suite (void)
   tcase_add_test (tc_chain, test_rtspconnection_tunnel_setup_post_first);
   tcase_add_test (tc_chain, test_rtspconnection_send_receive);
   tcase_add_test (tc_chain, test_rtspconnection_send_receive_check_headers);
+  tcase_add_test (tc_chain, test_rtspconnection_receive_buffered);
+  tcase_add_test (tc_chain, test_rtspconnection_lazy_headers);
+  tcase_add_test (tc_chain, test_rtspconnection_send_receive_body_buffer);
   tcase_add_test (tc_chain, test_rtspconnection_connect);
   tcase_add_test (tc_chain, test_rtspconnection_poll);
   tcase_add_test (tc_chain, test_rtspconnection_backlog);
+  tcase_add_test (tc_chain, test_rtspconnection_send_messages);
+  tcase_add_test (tc_chain, test_rtspconnection_watch_watermarks);
   tcase_add_test (tc_chain, test_rtspconnection_ip);
 
   return s;
@@ -25,6 +25,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <gst/check/gstcheck.h>
 #include <gst/sdp/gstsdpmessage.h>
 
@@ -568,6 +570,74 @@ GST_START_TEST (caps_from_media_really_const)
   gst_sdp_message_free (message);
 }
 
+GST_END_TEST
+static void
+check_find_attributes (const gchar * text, gint media_idx,
+    const GArray * attributes)
+{
+  const gchar *value;
+  guint i, j, nth, len;
+
+  for (i = 0; i < attributes->len; i++) {
+    const GstSDPAttribute *attr =
+        &g_array_index (attributes, GstSDPAttribute, i);
+
+    /* find the index of this attribute among the ones with the same key */
+    nth = 0;
+    for (j = 0; j < i; j++) {
+      if (!strcmp (g_array_index (attributes, GstSDPAttribute, j).key,
+              attr->key))
+        nth++;
+    }
+
+    fail_unless (gst_sdp_buffer_find_attribute ((const guint8 *) text,
+            strlen (text), media_idx, attr->key, nth, &value, &len));
+    fail_unless_equals_int (len, strlen (attr->value));
+    fail_unless (strncmp (value, attr->value, len) == 0);
+  }
+}
+
+GST_START_TEST (find_attribute)
+{
+  GstSDPMessage *message;
+  const gchar *value;
+  guint i, len;
+
+  gst_sdp_message_new (&message);
+  gst_sdp_message_parse_buffer ((guint8 *) sdp_rtcp_fb, strlen (sdp_rtcp_fb),
+      message);
+
+  /* the lookup must find the same values as the full parser */
+  check_find_attributes (sdp_rtcp_fb, -1, message->attributes);
+  for (i = 0; i < gst_sdp_message_medias_len (message); i++)
+    check_find_attributes (sdp_rtcp_fb, i,
+        gst_sdp_message_get_media (message, i)->attributes);
+
+  fail_unless (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), 0, "rtcp-fb", 4, &value, &len));
+  fail_unless (strncmp (value, "102    ccm fir", len) == 0);
+  fail_if (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), 0, "rtcp-fb", 5, NULL, NULL));
+
+  /* property attributes have an empty value */
+  fail_unless (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), -1, "sendrecv", 0, &value, &len));
+  fail_unless_equals_int (len, 0);
+
+  /* session attributes are not found in the media and the other way around,
+   * and keys must match completely */
+  fail_if (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), 0, "maxptime", 0, NULL, NULL));
+  fail_if (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), -1, "rtpmap", 0, NULL, NULL));
+  fail_if (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), -1, "maxp", 0, NULL, NULL));
+  fail_if (gst_sdp_buffer_find_attribute ((const guint8 *) sdp_rtcp_fb,
+          strlen (sdp_rtcp_fb), 1, "rtpmap", 0, NULL, NULL));
+
+  gst_sdp_message_free (message);
+}
+
 GST_END_TEST
 /*
  * End of test cases
@@ -590,6 +660,7 @@ sdp_suite (void)
   tcase_add_test (tc_chain, caps_from_media_rtcp_fb_all);
   tcase_add_test (tc_chain, media_from_caps_rtcp_fb_pt_100);
   tcase_add_test (tc_chain, media_from_caps_rtcp_fb_pt_101);
+  tcase_add_test (tc_chain, find_attribute);
 
   return s;
 }
@@ -26,6 +26,10 @@
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstbufferstraw.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 static gboolean got_eos = FALSE;
 
@@ -153,6 +157,298 @@ GST_START_TEST (test_memory_stream)
 
 GST_END_TEST;
 
+typedef struct
+{
+  gsize file_size;
+  guint n_buffers;
+  guint n_slices;
+  const guint8 *base;
+} MmapData;
+
+/* Counts the buffers that are a single read-only slice of one memory block
+ * covering the whole file, as handed out from the mapping */
+static GstPadProbeReturn
+mmap_buffer_probe (GstPad * pad, GstPadProbeInfo * info, MmapData * data)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstMemory *mem;
+  GstMapInfo map;
+  const guint8 *base;
+
+  data->n_buffers++;
+
+  if (gst_buffer_n_memory (buf) != 1)
+    return GST_PAD_PROBE_OK;
+
+  mem = gst_buffer_peek_memory (buf, 0);
+  if (!GST_MEMORY_IS_READONLY (mem) || mem->maxsize != data->file_size
+      || mem->offset != GST_BUFFER_OFFSET (buf))
+    return GST_PAD_PROBE_OK;
+
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    return GST_PAD_PROBE_OK;
+  base = map.data - mem->offset;
+  gst_memory_unmap (mem, &map);
+
+  /* all of them share the same mapping */
+  if (data->base == NULL)
+    data->base = base;
+  if (base == data->base)
+    data->n_slices++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_mmap_file)
+{
+  GMainLoop *loop;
+  GstElement *bin;
+  GstElement *src, *sink;
+  GstBus *bus;
+  GMemoryOutputStream *output;
+  guint8 in_data[10000];
+  guint8 *out_data;
+  gchar *filename, *uri;
+  gboolean use_mmap;
+  gint fd, i;
+  guint bus_watch = 0;
+  MmapData mmap_data = { 0, };
+  GstPad *pad;
+
+  got_eos = FALSE;
+
+  for (i = 0; i < sizeof (in_data); i++)
+    in_data[i] = i % 251;
+
+  fd = g_file_open_tmp ("gst-gio-test-XXXXXX", &filename, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+  fail_unless (g_file_set_contents (filename, (gchar *) in_data,
+          sizeof (in_data), NULL));
+  uri = g_filename_to_uri (filename, NULL, NULL);
+
+  output = G_MEMORY_OUTPUT_STREAM (g_memory_output_stream_new (NULL, 0,
+          (GReallocFunc) g_realloc, (GDestroyNotify) g_free));
+
+  loop = g_main_loop_new (NULL, FALSE);
+
+  bin = gst_pipeline_new ("bin");
+
+  src = gst_element_factory_make ("giosrc", "src");
+  fail_unless (src != NULL);
+  g_object_set (G_OBJECT (src), "location", uri, "use-mmap", TRUE,
+      "blocksize", 4096, NULL);
+  g_object_get (G_OBJECT (src), "use-mmap", &use_mmap, NULL);
+  fail_unless (use_mmap);
+
+  mmap_data.file_size = sizeof (in_data);
+  pad = gst_element_get_static_pad (src, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) mmap_buffer_probe, &mmap_data, NULL);
+  gst_object_unref (pad);
+
+  sink = gst_element_factory_make ("giostreamsink", "sink");
+  fail_unless (sink != NULL);
+  g_object_set (G_OBJECT (sink), "stream", output, NULL);
+
+  gst_bin_add_many (GST_BIN (bin), src, sink, NULL);
+
+  fail_unless (gst_element_link_many (src, sink, NULL));
+
+  bus = gst_element_get_bus (bin);
+  bus_watch = gst_bus_add_watch (bus, message_handler, loop);
+  gst_object_unref (bus);
+
+  gst_element_set_state (bin, GST_STATE_PLAYING);
+
+  g_main_loop_run (loop);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+
+  fail_unless (got_eos);
+
+  /* 3 blocks, the last one partial, all without a copy */
+  fail_unless_equals_int (mmap_data.n_buffers, 3);
+  fail_unless_equals_int (mmap_data.n_slices, mmap_data.n_buffers);
+
+  fail_unless_equals_int (g_memory_output_stream_get_data_size (output),
+      sizeof (in_data));
+  out_data = g_memory_output_stream_get_data (output);
+  for (i = 0; i < sizeof (in_data); i++)
+    fail_unless_equals_int (in_data[i], out_data[i]);
+
+  g_object_unref (output);
+
+  g_unlink (filename);
+  g_free (filename);
+  g_free (uri);
+
+  g_main_loop_unref (loop);
+  g_source_remove (bus_watch);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_read_ahead)
+{
+  GMainLoop *loop;
+  GstElement *bin;
+  GstElement *src, *sink;
+  GstBus *bus;
+  GInputStream *input;
+  GMemoryOutputStream *output;
+  guint8 *in_data;
+  guint8 *out_data;
+  gint i;
+  guint bus_watch = 0;
+
+  got_eos = FALSE;
+
+  /* three blocks, the last one partial, and reads crossing block borders */
+  in_data = g_new (guint8, 10000);
+  for (i = 0; i < 10000; i++)
+    in_data[i] = i % 251;
+
+  input = g_memory_input_stream_new_from_data (in_data, 10000, NULL);
+
+  output = G_MEMORY_OUTPUT_STREAM (g_memory_output_stream_new (NULL, 0,
+          (GReallocFunc) g_realloc, (GDestroyNotify) g_free));
+
+  loop = g_main_loop_new (NULL, FALSE);
+
+  bin = gst_pipeline_new ("bin");
+
+  src = gst_element_factory_make ("giostreamsrc", "src");
+  fail_unless (src != NULL);
+  g_object_set (G_OBJECT (src), "stream", input, "blocksize", 1000,
+      "read-ahead-block-size", 4096, "read-ahead-blocks", 4, NULL);
+
+  sink = gst_element_factory_make ("giostreamsink", "sink");
+  fail_unless (sink != NULL);
+  g_object_set (G_OBJECT (sink), "stream", output, NULL);
+
+  gst_bin_add_many (GST_BIN (bin), src, sink, NULL);
+
+  fail_unless (gst_element_link_many (src, sink, NULL));
+
+  bus = gst_element_get_bus (bin);
+  bus_watch = gst_bus_add_watch (bus, message_handler, loop);
+  gst_object_unref (bus);
+
+  gst_element_set_state (bin, GST_STATE_PLAYING);
+
+  g_main_loop_run (loop);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+
+  fail_unless (got_eos);
+
+  fail_unless_equals_int (g_memory_output_stream_get_data_size (output),
+      10000);
+  out_data = g_memory_output_stream_get_data (output);
+  for (i = 0; i < 10000; i++)
+    fail_unless_equals_int (in_data[i], out_data[i]);
+
+  g_object_unref (input);
+  g_object_unref (output);
+  g_free (in_data);
+
+  g_main_loop_unref (loop);
+  g_source_remove (bus_watch);
+}
+
+GST_END_TEST;
+
+static void
+check_range (GstPad * pad, const guint8 * in_data, guint64 offset,
+    guint size, guint expected_size)
+{
+  GstBuffer *buf = NULL;
+  GstMapInfo map;
+  guint i;
+
+  fail_unless_equals_int (gst_pad_get_range (pad, offset, size, &buf),
+      GST_FLOW_OK);
+  fail_unless (buf != NULL);
+  fail_unless_equals_int (GST_BUFFER_OFFSET (buf), offset);
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, expected_size);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], in_data[offset + i]);
+  gst_buffer_unmap (buf, &map);
+
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (test_read_ahead_pull)
+{
+  GstElement *src;
+  GstPad *pad;
+  GInputStream *input;
+  GstBuffer *buf = NULL;
+  guint8 *in_data;
+  gint i;
+
+  /* five blocks, the last one partial */
+  in_data = g_new (guint8, 20000);
+  for (i = 0; i < 20000; i++)
+    in_data[i] = i % 251;
+
+  input = g_memory_input_stream_new_from_data (in_data, 20000, NULL);
+
+  src = gst_element_factory_make ("giostreamsrc", "src");
+  fail_unless (src != NULL);
+  /* a cache of two blocks, so that jumping around evicts them */
+  g_object_set (G_OBJECT (src), "stream", input,
+      "read-ahead-block-size", 4096, "read-ahead-blocks", 2, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* from the start, and again from the same blocks */
+  check_range (pad, in_data, 0, 1000, 1000);
+  check_range (pad, in_data, 500, 1000, 1000);
+
+  /* across a block border */
+  check_range (pad, in_data, 3000, 2000, 2000);
+
+  /* jump ahead, then back to the blocks that were evicted meanwhile */
+  check_range (pad, in_data, 16000, 1000, 1000);
+  check_range (pad, in_data, 12000, 1000, 1000);
+  check_range (pad, in_data, 100, 1000, 1000);
+
+  /* more blocks than the cache holds */
+  check_range (pad, in_data, 2000, 15000, 15000);
+
+  /* up to the end of the stream, and beyond it */
+  check_range (pad, in_data, 19500, 1000, 500);
+  fail_unless_equals_int (gst_pad_get_range (pad, 20000, 1000, &buf),
+      GST_FLOW_EOS);
+  fail_unless (buf == NULL);
+
+  /* and back to the start */
+  check_range (pad, in_data, 0, 4096, 4096);
+
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, FALSE));
+  gst_object_unref (pad);
+
+  gst_element_set_state (src, GST_STATE_NULL);
+  gst_object_unref (src);
+
+  g_object_unref (input);
+  g_free (in_data);
+}
+
+GST_END_TEST;
+
 static Suite *
 gio_suite (void)
 {
@@ -161,6 +457,9 @@ gio_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_memory_stream);
+  tcase_add_test (tc_chain, test_mmap_file);
+  tcase_add_test (tc_chain, test_read_ahead);
+  tcase_add_test (tc_chain, test_read_ahead_pull);
 
   return s;
 }
@@ -0,0 +1,240 @@
+/* GStreamer discoverer benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs GstDiscoverer over a set of files, e.g. a directory with thousands of
+ * small media files, and reports the discovery throughput.
+ *
+ * With a single worker the synchronous API is used and the latency of every
+ * single discovery is reported too. With more workers the files are
+ * discovered asynchronously and only the throughput is reported.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+
+static gint iterations = 1;
+static gint workers = 1;
+static gint timeout = 10;
+static gboolean reuse_source = FALSE;
+static gboolean parse_only = FALSE;
+static gchar *cache_file = NULL;
+static gchar **paths = NULL;
+
+static GOptionEntry options[] = {
+  {"iterations", 'i', 0, G_OPTION_ARG_INT, &iterations,
+      "Number of times all files are discovered", "N"},
+  {"workers", 'w', 0, G_OPTION_ARG_INT, &workers,
+      "Number of concurrent discoveries", "N"},
+  {"timeout", 't', 0, G_OPTION_ARG_INT, &timeout,
+      "Timeout per file in seconds", "S"},
+  {"reuse-source", 'r', 0, G_OPTION_ARG_NONE, &reuse_source,
+      "Reuse the source element between files", NULL},
+  {"parse-only", 'p', 0, G_OPTION_ARG_NONE, &parse_only,
+      "Only demux and parse, without plugging decoders", NULL},
+  {"cache-file", 'c', 0, G_OPTION_ARG_FILENAME, &cache_file,
+      "Cache the results in this file", "FILE"},
+  {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &paths,
+      NULL, "FILE|DIRECTORY..."},
+  {NULL}
+};
+
+static guint n_discovered;
+static guint n_errors;
+
+static void
+add_path (GPtrArray * uris, const gchar * path)
+{
+  if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+    const gchar *name;
+    GDir *dir;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (dir == NULL)
+      return;
+
+    while ((name = g_dir_read_name (dir))) {
+      gchar *child = g_build_filename (path, name, NULL);
+      add_path (uris, child);
+      g_free (child);
+    }
+    g_dir_close (dir);
+  } else if (g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+    gchar *uri = gst_filename_to_uri (path, NULL);
+
+    if (uri)
+      g_ptr_array_add (uris, uri);
+  }
+}
+
+static void
+count_result (GstDiscovererInfo * info)
+{
+  n_discovered++;
+  if (gst_discoverer_info_get_result (info) != GST_DISCOVERER_OK)
+    n_errors++;
+}
+
+static gint
+compare_latency (gconstpointer a, gconstpointer b)
+{
+  gint64 la = *(const gint64 *) a, lb = *(const gint64 *) b;
+
+  return la < lb ? -1 : (la > lb ? 1 : 0);
+}
+
+static void
+run_sync (GstDiscoverer * dc, GPtrArray * uris)
+{
+  gint64 *latencies, start;
+  guint i, n = 0;
+  gint j;
+
+  latencies = g_new (gint64, uris->len * iterations);
+
+  for (j = 0; j < iterations; j++) {
+    for (i = 0; i < uris->len; i++) {
+      GstDiscovererInfo *info;
+
+      start = g_get_monotonic_time ();
+      info = gst_discoverer_discover_uri (dc, g_ptr_array_index (uris, i),
+          NULL);
+      latencies[n++] = g_get_monotonic_time () - start;
+
+      if (info) {
+        count_result (info);
+        gst_discoverer_info_unref (info);
+      }
+    }
+  }
+
+  qsort (latencies, n, sizeof (gint64), compare_latency);
+  g_print ("  latency per file: median %.3f ms, 99%% %.3f ms, max %.3f ms\n",
+      latencies[n / 2] / 1000.0, latencies[(n * 99) / 100] / 1000.0,
+      latencies[n - 1] / 1000.0);
+  g_free (latencies);
+}
+
+static void
+discovered_cb (GstDiscoverer * dc, GstDiscovererInfo * info, GError * err,
+    gpointer user_data)
+{
+  count_result (info);
+}
+
+static void
+run_async (GstDiscoverer * dc, GPtrArray * uris)
+{
+  GMainLoop *loop;
+  guint i;
+  gint j;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (dc, "discovered", G_CALLBACK (discovered_cb), NULL);
+  g_signal_connect_swapped (dc, "finished", G_CALLBACK (g_main_loop_quit),
+      loop);
+
+  for (j = 0; j < iterations; j++)
+    for (i = 0; i < uris->len; i++)
+      gst_discoverer_discover_uri_async (dc, g_ptr_array_index (uris, i));
+
+  gst_discoverer_start (dc);
+  g_main_loop_run (loop);
+  gst_discoverer_stop (dc);
+
+  g_main_loop_unref (loop);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GPtrArray *uris;
+  gint64 start, elapsed;
+  gchar **path;
+
+  ctx = g_option_context_new ("- discoverer benchmark");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  iterations = MAX (iterations, 1);
+  workers = MAX (workers, 1);
+  timeout = CLAMP (timeout, 1, 3600);
+
+  uris = g_ptr_array_new_with_free_func (g_free);
+  for (path = paths; path && *path; path++)
+    add_path (uris, *path);
+  g_strfreev (paths);
+
+  if (uris->len == 0) {
+    g_print ("No files to discover\n");
+    g_ptr_array_unref (uris);
+    return 0;
+  }
+
+  dc = gst_discoverer_new (timeout * GST_SECOND, &err);
+  if (dc == NULL) {
+    g_printerr ("Error creating discoverer: %s\n", err->message);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_object_set (dc, "max-workers", workers, "reuse-source", reuse_source,
+      "parse-only", parse_only, "cache-file", cache_file, NULL);
+
+  g_print ("%u files, %d iterations, %d workers%s%s\n", uris->len,
+      iterations, workers, reuse_source ? ", reusing source" : "",
+      parse_only ? ", parse only" : "");
+
+  start = g_get_monotonic_time ();
+  if (workers > 1)
+    run_async (dc, uris);
+  else
+    run_sync (dc, uris);
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  g_print ("discovered %u files in %.3f s, %.1f files/s, %u not OK\n",
+      n_discovered, elapsed / (gdouble) G_USEC_PER_SEC,
+      (gdouble) n_discovered * G_USEC_PER_SEC / elapsed, n_errors);
+
+  if (cache_file) {
+    guint hits, misses;
+
+    g_object_get (dc, "cache-hits", &hits, "cache-misses", &misses, NULL);
+    g_print ("  cache: %u hits, %u misses\n", hits, misses);
+  }
+
+  g_object_unref (dc);
+  g_ptr_array_unref (uris);
+  g_free (cache_file);
+
+  return 0;
+}
@@ -0,0 +1,485 @@
+/* GStreamer RTSP connection benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Drives GstRTSPConnection and GstRTSPWatch over local TCP connections.
+ *
+ * Every session has a client connection, used from its own thread with the
+ * blocking API, and a server connection with a GstRTSPWatch. All watches are
+ * dispatched from one server thread, like a server would do.
+ *
+ * The benchmark runs in three phases:
+ *  - requests: every client sends OPTIONS requests and waits for the
+ *    response, measuring the round trip latency of each message
+ *  - data: every client sends interleaved data messages to the server
+ *  - fuzz: optionally, new connections send randomly corrupted requests to
+ *    the watch, which must survive and report errors
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/rtsp/gstrtspconnection.h>
+
+static gint n_sessions = 16;
+static gint n_requests = 10000;
+static gint n_data = 20000;
+static gint data_size = 1400;
+static gint n_fuzz = 0;
+
+static GOptionEntry options[] = {
+  {"sessions", 's', 0, G_OPTION_ARG_INT, &n_sessions,
+      "Number of concurrent sessions", "N"},
+  {"requests", 'r', 0, G_OPTION_ARG_INT, &n_requests,
+      "Number of requests per session", "N"},
+  {"data", 'd', 0, G_OPTION_ARG_INT, &n_data,
+      "Number of interleaved data messages per session", "N"},
+  {"data-size", 0, 0, G_OPTION_ARG_INT, &data_size,
+      "Size of the interleaved data messages", "BYTES"},
+  {"fuzz", 'f', 0, G_OPTION_ARG_INT, &n_fuzz,
+      "Number of connections sending corrupted requests", "N"},
+  {NULL}
+};
+
+static const gchar *request_template =
+    "OPTIONS rtsp://127.0.0.1/bench RTSP/1.0\r\n"
+    "CSeq: 1\r\n"
+    "User-Agent: benchmark-rtspconnection\r\n"
+    "Session: 1234567890;timeout=60\r\n"
+    "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n"
+    "Content-Length: 4\r\n\r\n" "body";
+
+typedef struct
+{
+  GSocketConnection *client_sconn;
+  GSocketConnection *server_sconn;
+  GstRTSPConnection *client;
+  GstRTSPConnection *server;
+  GstRTSPWatch *watch;
+
+  guint id;
+  gint64 *latencies;
+} Session;
+
+static GMainContext *server_context;
+static GMainLoop *server_loop;
+
+static GMutex lock;
+static GCond cond;
+static guint requests_received;
+static guint data_received;
+static guint64 data_bytes_received;
+static guint errors;
+static guint closed;
+
+static GstRTSPResult
+message_received (GstRTSPWatch * watch, GstRTSPMessage * message,
+    gpointer user_data)
+{
+  GstRTSPMessage response = { 0 };
+  guint8 *data;
+  guint size;
+
+  switch (gst_rtsp_message_get_type (message)) {
+    case GST_RTSP_MESSAGE_REQUEST:
+      gst_rtsp_message_init_response (&response, GST_RTSP_STS_OK, NULL,
+          message);
+      gst_rtsp_watch_send_message (watch, &response, NULL);
+      gst_rtsp_message_unset (&response);
+
+      g_mutex_lock (&lock);
+      requests_received++;
+      g_mutex_unlock (&lock);
+      break;
+    case GST_RTSP_MESSAGE_DATA:
+      gst_rtsp_message_get_body (message, &data, &size);
+
+      g_mutex_lock (&lock);
+      data_received++;
+      data_bytes_received += size;
+      g_cond_signal (&cond);
+      g_mutex_unlock (&lock);
+      break;
+    default:
+      break;
+  }
+
+  return GST_RTSP_OK;
+}
+
+static GstRTSPResult
+watch_closed (GstRTSPWatch * watch, gpointer user_data)
+{
+  g_mutex_lock (&lock);
+  closed++;
+  g_cond_signal (&cond);
+  g_mutex_unlock (&lock);
+
+  return GST_RTSP_OK;
+}
+
+static GstRTSPResult
+watch_error_full (GstRTSPWatch * watch, GstRTSPResult result,
+    GstRTSPMessage * message, guint id, gpointer user_data)
+{
+  g_mutex_lock (&lock);
+  errors++;
+  g_mutex_unlock (&lock);
+
+  return GST_RTSP_OK;
+}
+
+static GstRTSPWatchFuncs watch_funcs;
+
+static gpointer
+server_thread_func (gpointer user_data)
+{
+  g_main_context_push_thread_default (server_context);
+  g_main_loop_run (server_loop);
+  g_main_context_pop_thread_default (server_context);
+
+  return NULL;
+}
+
+static gboolean
+session_connect (Session * session, GSocketListener * listener, guint16 port)
+{
+  GSocketClient *client;
+  GError *err = NULL;
+
+  client = g_socket_client_new ();
+  session->client_sconn =
+      g_socket_client_connect_to_host (client, "127.0.0.1", port, NULL, &err);
+  g_object_unref (client);
+  if (session->client_sconn == NULL)
+    goto error;
+
+  session->server_sconn = g_socket_listener_accept (listener, NULL, NULL, &err);
+  if (session->server_sconn == NULL)
+    goto error;
+
+  gst_rtsp_connection_create_from_socket (g_socket_connection_get_socket
+      (session->client_sconn), "127.0.0.1", port, NULL, &session->client);
+  gst_rtsp_connection_create_from_socket (g_socket_connection_get_socket
+      (session->server_sconn), "127.0.0.1", port, NULL, &session->server);
+
+  session->watch =
+      gst_rtsp_watch_new (session->server, &watch_funcs, session, NULL);
+  gst_rtsp_watch_attach (session->watch, server_context);
+
+  return TRUE;
+
+error:
+  {
+    g_printerr ("failed to connect session %u: %s\n", session->id,
+        err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+}
+
+static void
+session_free (Session * session)
+{
+  if (session->watch)
+    gst_rtsp_watch_unref (session->watch);
+  if (session->client)
+    gst_rtsp_connection_free (session->client);
+  if (session->server)
+    gst_rtsp_connection_free (session->server);
+  if (session->client_sconn)
+    g_object_unref (session->client_sconn);
+  if (session->server_sconn)
+    g_object_unref (session->server_sconn);
+  g_free (session->latencies);
+  g_free (session);
+}
+
+static gpointer
+request_thread_func (gpointer user_data)
+{
+  Session *session = user_data;
+  GstRTSPMessage request = { 0 };
+  GstRTSPMessage response = { 0 };
+  gchar cseq[16];
+  gint64 start;
+  gint i;
+
+  gst_rtsp_message_init_request (&request, GST_RTSP_OPTIONS,
+      "rtsp://127.0.0.1/bench");
+  gst_rtsp_message_add_header (&request, GST_RTSP_HDR_USER_AGENT,
+      "benchmark-rtspconnection");
+
+  for (i = 0; i < n_requests; i++) {
+    g_snprintf (cseq, sizeof (cseq), "%d", i);
+    gst_rtsp_message_take_header (&request, GST_RTSP_HDR_CSEQ,
+        g_strdup (cseq));
+
+    start = g_get_monotonic_time ();
+    if (gst_rtsp_connection_send (session->client, &request,
+            NULL) != GST_RTSP_OK)
+      break;
+    gst_rtsp_message_remove_header (&request, GST_RTSP_HDR_CSEQ, -1);
+
+    if (gst_rtsp_connection_receive (session->client, &response,
+            NULL) != GST_RTSP_OK)
+      break;
+    session->latencies[i] = g_get_monotonic_time () - start;
+    gst_rtsp_message_unset (&response);
+  }
+  gst_rtsp_message_unset (&request);
+
+  if (i < n_requests)
+    g_printerr ("session %u: request %d failed\n", session->id, i);
+
+  return NULL;
+}
+
+static gpointer
+data_thread_func (gpointer user_data)
+{
+  Session *session = user_data;
+  GstRTSPMessage message = { 0 };
+  gint i;
+
+  gst_rtsp_message_init_data (&message, 0);
+  gst_rtsp_message_take_body (&message, g_malloc0 (data_size), data_size);
+
+  for (i = 0; i < n_data; i++) {
+    if (gst_rtsp_connection_send (session->client, &message,
+            NULL) != GST_RTSP_OK)
+      break;
+  }
+  gst_rtsp_message_unset (&message);
+
+  if (i < n_data)
+    g_printerr ("session %u: data message %d failed\n", session->id, i);
+
+  return NULL;
+}
+
+static void
+run_threads (GPtrArray * sessions, GThreadFunc func)
+{
+  GThread **threads;
+  guint i;
+
+  threads = g_new (GThread *, sessions->len);
+  for (i = 0; i < sessions->len; i++)
+    threads[i] = g_thread_new ("session", func, g_ptr_array_index (sessions,
+            i));
+  for (i = 0; i < sessions->len; i++)
+    g_thread_join (threads[i]);
+  g_free (threads);
+}
+
+static gint
+compare_latency (gconstpointer a, gconstpointer b)
+{
+  gint64 la = *(const gint64 *) a, lb = *(const gint64 *) b;
+
+  return la < lb ? -1 : (la > lb ? 1 : 0);
+}
+
+static void
+print_latencies (GPtrArray * sessions)
+{
+  gint64 *all;
+  guint i, n = sessions->len * n_requests;
+
+  if (n == 0)
+    return;
+
+  all = g_new (gint64, n);
+  for (i = 0; i < sessions->len; i++) {
+    Session *session = g_ptr_array_index (sessions, i);
+    memcpy (all + i * n_requests, session->latencies,
+        n_requests * sizeof (gint64));
+  }
+  qsort (all, n, sizeof (gint64), compare_latency);
+
+  g_print ("  round trip latency: median %" G_GINT64_FORMAT " us, "
+      "99%% %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us\n",
+      all[n / 2], all[(n * 99) / 100], all[n - 1]);
+  g_free (all);
+}
+
+/* send a copy of the request template with some random bytes changed and
+ * close the connection */
+static void
+fuzz_connection (GPtrArray * sessions, GSocketListener * listener,
+    guint16 port, GRand * rand)
+{
+  Session *session;
+  GOutputStream *out;
+  gchar *data;
+  gsize len;
+  guint i, n_changes;
+
+  session = g_new0 (Session, 1);
+  session->id = sessions->len;
+  /* the watch might still be dispatching, sessions are freed at the end */
+  g_ptr_array_add (sessions, session);
+  if (!session_connect (session, listener, port))
+    return;
+
+  len = strlen (request_template);
+  data = g_strdup (request_template);
+  n_changes = g_rand_int_range (rand, 1, 8);
+  for (i = 0; i < n_changes; i++)
+    data[g_rand_int_range (rand, 0, len)] = g_rand_int_range (rand, 0, 256);
+
+  out = g_io_stream_get_output_stream (G_IO_STREAM (session->client_sconn));
+  g_output_stream_write_all (out, data, len, NULL, NULL, NULL);
+  g_free (data);
+
+  gst_rtsp_connection_close (session->client);
+
+  /* wait until the watch saw the end of the connection */
+  g_mutex_lock (&lock);
+  while (closed == 0)
+    g_cond_wait (&cond, &lock);
+  closed = 0;
+  g_mutex_unlock (&lock);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GSocketListener *listener;
+  GPtrArray *sessions;
+  GThread *server_thread;
+  GRand *rand;
+  guint16 port;
+  gint64 start, elapsed;
+  guint i;
+
+  ctx = g_option_context_new ("- RTSP connection benchmark");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  n_sessions = MAX (n_sessions, 1);
+  n_requests = MAX (n_requests, 0);
+  n_data = MAX (n_data, 0);
+  data_size = CLAMP (data_size, 1, G_MAXUINT16);
+
+  watch_funcs.message_received = message_received;
+  watch_funcs.closed = watch_closed;
+  watch_funcs.error_full = watch_error_full;
+
+  server_context = g_main_context_new ();
+  server_loop = g_main_loop_new (server_context, FALSE);
+  server_thread = g_thread_new ("server", server_thread_func, NULL);
+
+  listener = g_socket_listener_new ();
+  g_socket_listener_set_backlog (listener, n_sessions);
+  port = g_socket_listener_add_any_inet_port (listener, NULL, &err);
+  if (port == 0) {
+    g_printerr ("failed to listen: %s\n", err->message);
+    g_clear_error (&err);
+    return 1;
+  }
+
+  sessions = g_ptr_array_new_with_free_func ((GDestroyNotify) session_free);
+  for (i = 0; i < n_sessions; i++) {
+    Session *session = g_new0 (Session, 1);
+
+    session->id = i;
+    session->latencies = g_new0 (gint64, n_requests);
+    g_ptr_array_add (sessions, session);
+    if (!session_connect (session, listener, port))
+      return 1;
+  }
+
+  g_print ("%d sessions, %d requests and %d data messages of %d bytes "
+      "per session\n", n_sessions, n_requests, n_data, data_size);
+
+  /* requests */
+  start = g_get_monotonic_time ();
+  run_threads (sessions, request_thread_func);
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  g_print ("requests: %u in %.3f s, %.0f messages/s\n", requests_received,
+      elapsed / (gdouble) G_USEC_PER_SEC,
+      2.0 * requests_received * G_USEC_PER_SEC / elapsed);
+  print_latencies (sessions);
+
+  /* interleaved data */
+  start = g_get_monotonic_time ();
+  run_threads (sessions, data_thread_func);
+  g_mutex_lock (&lock);
+  while (data_received < (guint) n_sessions * n_data && closed == 0)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  g_print ("data: %u messages in %.3f s, %.0f messages/s, %.1f MB/s\n",
+      data_received, elapsed / (gdouble) G_USEC_PER_SEC,
+      (gdouble) data_received * G_USEC_PER_SEC / elapsed,
+      (gdouble) data_bytes_received / elapsed);
+
+  /* close all sessions, this also makes the watches go away */
+  for (i = 0; i < sessions->len; i++) {
+    Session *session = g_ptr_array_index (sessions, i);
+    gst_rtsp_connection_close (session->client);
+  }
+  g_mutex_lock (&lock);
+  while (closed < (guint) n_sessions)
+    g_cond_wait (&cond, &lock);
+  closed = 0;
+  g_mutex_unlock (&lock);
+
+  /* corrupted requests */
+  if (n_fuzz > 0) {
+    guint received = requests_received;
+
+    rand = g_rand_new ();
+    errors = 0;
+    start = g_get_monotonic_time ();
+    for (i = 0; i < n_fuzz; i++)
+      fuzz_connection (sessions, listener, port, rand);
+    elapsed = MAX (g_get_monotonic_time () - start, 1);
+    g_rand_free (rand);
+
+    g_print ("fuzz: %d connections in %.3f s, %u errors, %u parsed\n",
+        n_fuzz, elapsed / (gdouble) G_USEC_PER_SEC, errors,
+        requests_received - received);
+  }
+
+  g_main_loop_quit (server_loop);
+  g_thread_join (server_thread);
+  g_ptr_array_unref (sessions);
+  g_main_loop_unref (server_loop);
+  g_main_context_unref (server_context);
+  g_object_unref (listener);
+
+  return 0;
+}
@@ -0,0 +1,516 @@
+/* GStreamer typefind benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Calls every typefind function on a set of generated samples, and on any
+ * files given on the command line, and reports the time spent and the number
+ * of bytes peeked per typefinder.
+ *
+ * The generated samples cover the common media formats and the worst cases of
+ * the scanning typefinders, not every registered type. Other types are
+ * benchmarked by passing sample files.
+ *
+ * For every sample it also reports what the core typefinding would have
+ * detected and how long it would have taken to get there, calling the
+ * typefinders in rank order until one of them is certain.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+
+#define SAMPLE_SIZE (64 * 1024)
+
+static gint iterations = 100;
+static gchar *plugin_name = NULL;
+static gchar **files = NULL;
+
+static GOptionEntry options[] = {
+  {"iterations", 'i', 0, G_OPTION_ARG_INT, &iterations,
+      "Number of times each typefinder is called per sample", "N"},
+  {"plugin", 'p', 0, G_OPTION_ARG_STRING, &plugin_name,
+      "Only run the typefinders of this plugin (default: typefindfunctions, "
+        "'all' for every plugin)", "NAME"},
+  {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &files,
+      NULL, "[FILE...]"},
+  {NULL}
+};
+
+typedef struct
+{
+  gchar *name;
+  GBytes *bytes;
+} Sample;
+
+typedef struct
+{
+  GstTypeFindFactory *factory;
+  gint64 time;
+  guint64 calls;
+  guint64 peeked;
+  guint64 extent;
+  guint matches;
+} TypeFinderStats;
+
+/* one call of a typefind function on a sample */
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+
+  guint64 peeked;
+  guint64 extent;
+
+  guint probability;
+  GstCaps *caps;
+} TypeFindRun;
+
+static const guint8 *
+run_peek (gpointer data, gint64 offset, guint size)
+{
+  TypeFindRun *run = data;
+
+  if (offset < 0)
+    offset += run->size;
+  if (offset < 0 || (guint64) offset + size > run->size)
+    return NULL;
+
+  run->peeked += size;
+  run->extent = MAX (run->extent, (guint64) offset + size);
+
+  return run->data + offset;
+}
+
+static void
+run_suggest (gpointer data, guint probability, GstCaps * caps)
+{
+  TypeFindRun *run = data;
+
+  if (probability > run->probability) {
+    run->probability = probability;
+    gst_caps_replace (&run->caps, caps);
+  }
+}
+
+static guint64
+run_get_length (gpointer data)
+{
+  TypeFindRun *run = data;
+
+  return run->size;
+}
+
+static void
+run_init (TypeFindRun * run, GstTypeFind * tf, GBytes * bytes)
+{
+  memset (run, 0, sizeof (TypeFindRun));
+  run->data = g_bytes_get_data (bytes, &run->size);
+
+  memset (tf, 0, sizeof (GstTypeFind));
+  tf->peek = run_peek;
+  tf->suggest = run_suggest;
+  tf->get_length = run_get_length;
+  tf->data = run;
+}
+
+static void
+run_clear (TypeFindRun * run)
+{
+  gst_caps_replace (&run->caps, NULL);
+}
+
+/*** generated samples ***/
+
+static void
+add_sample (GPtrArray * samples, const gchar * name, GByteArray * data)
+{
+  Sample *sample = g_new0 (Sample, 1);
+
+  sample->name = g_strdup (name);
+  sample->bytes = g_byte_array_free_to_bytes (data);
+  g_ptr_array_add (samples, sample);
+}
+
+/* a header, padded with zeros */
+static void
+add_header_sample (GPtrArray * samples, const gchar * name,
+    const guint8 * header, gsize size)
+{
+  GByteArray *data = g_byte_array_sized_new (4096);
+
+  g_byte_array_append (data, header, size);
+  g_byte_array_set_size (data, 4096);
+  memset (data->data + size, 0, 4096 - size);
+
+  add_sample (samples, name, data);
+}
+
+/* a frame header repeated every frame_size bytes, with filler in between */
+static void
+add_frames_sample (GPtrArray * samples, const gchar * name,
+    const guint8 * header, gsize size, gsize frame_size, guint8 filler)
+{
+  GByteArray *data = g_byte_array_sized_new (SAMPLE_SIZE);
+  gsize offset;
+
+  g_byte_array_set_size (data, SAMPLE_SIZE);
+  memset (data->data, filler, SAMPLE_SIZE);
+  for (offset = 0; offset + size <= SAMPLE_SIZE; offset += frame_size)
+    memcpy (data->data + offset, header, size);
+
+  add_sample (samples, name, data);
+}
+
+static void
+add_h264_sample (GPtrArray * samples)
+{
+  const guint8 nal_types[] = { 0x67, 0x68, 0x65, 0x41 };
+  GByteArray *data = g_byte_array_sized_new (SAMPLE_SIZE);
+  gsize offset;
+  guint i = 0;
+
+  g_byte_array_set_size (data, SAMPLE_SIZE);
+  memset (data->data, 0x55, SAMPLE_SIZE);
+  for (offset = 0; offset + 5 <= SAMPLE_SIZE; offset += 1031) {
+    memcpy (data->data + offset, "\000\000\000\001", 4);
+    data->data[offset + 4] = nal_types[MIN (i, G_N_ELEMENTS (nal_types) - 1)];
+    i++;
+  }
+
+  add_sample (samples, "h264", data);
+}
+
+static void
+add_filled_sample (GPtrArray * samples, const gchar * name, gboolean random)
+{
+  GByteArray *data = g_byte_array_sized_new (SAMPLE_SIZE);
+  GRand *rand = g_rand_new_with_seed (0);
+  gsize i;
+
+  g_byte_array_set_size (data, SAMPLE_SIZE);
+  for (i = 0; i < SAMPLE_SIZE; i++)
+    data->data[i] = random ? g_rand_int (rand) & 0xff : 0;
+  g_rand_free (rand);
+
+  add_sample (samples, name, data);
+}
+
+static void
+add_text_sample (GPtrArray * samples)
+{
+  GByteArray *data = g_byte_array_sized_new (SAMPLE_SIZE);
+  const gchar *line = "The quick brown fox jumps over the lazy dog.\n";
+
+  while (data->len + strlen (line) <= SAMPLE_SIZE)
+    g_byte_array_append (data, (const guint8 *) line, strlen (line));
+
+  add_sample (samples, "text", data);
+}
+
+static void
+add_generated_samples (GPtrArray * samples)
+{
+  const guint8 png[] = "\211PNG\r\n\032\n\000\000\000\rIHDR"
+      "\000\000\001\000\000\000\001\000\010\002\000\000\000";
+  const guint8 jpeg[] = "\377\330\377\340\000\020JFIF\000\001\001\000\000"
+      "\001\000\001\000\000\377\333\000\103\000";
+  const guint8 gif[] = "GIF89a\001\000\001\000\200\000\000";
+  const guint8 wav[] = "RIFF\044\000\001\000WAVEfmt \020\000\000\000"
+      "\001\000\002\000\104\254\000\000\020\261\002\000\004\000\020\000"
+      "data\000\000\001\000";
+  const guint8 avi[] = "RIFF\000\000\001\000AVI LIST\000\001\000\000hdrl";
+  const guint8 ogg[] = "OggS\000\002\000\000\000\000\000\000\000\000"
+      "\001\000\000\000\000\000\000\000\000\000\000\000\001\036"
+      "\001vorbis\000\000\000\000\002\104\254\000\000";
+  const guint8 matroska[] = "\032\105\337\243\243\102\206\201\001"
+      "\102\367\201\001\102\362\201\004\102\363\201\010\102\202\204webm"
+      "\102\207\201\002\102\205\201\002";
+  const guint8 mp4[] = "\000\000\000\030ftypisom\000\000\002\000isomiso2"
+      "\000\000\000\010free\000\000\000\010mdat";
+  const guint8 flac[] = "fLaC\200\000\000\042\020\000\020\000";
+  const guint8 mp3_frame[] = { 0xff, 0xfb, 0x90, 0x64 };
+  const guint8 adts_frame[] = { 0xff, 0xf1, 0x50, 0x80, 0x2e, 0x7f, 0xfc };
+  const guint8 ts_packet[] = { 0x47, 0x40, 0x00, 0x10 };
+  const guint8 xml[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<root><element attribute=\"value\"/></root>\n";
+  const guint8 asf[] = "\060\046\262\165\216\146\317\021\246\331\000\252"
+      "\000\142\316\154\000\001\000\000\000\000\000\000";
+  const guint8 flv[] = "FLV\001\005\000\000\000\011\000\000\000\000";
+  const guint8 quicktime[] = "\000\000\000\024ftypqt  \000\000\002\000"
+      "qt  \000\000\000\010wide";
+  const guint8 mpeg_ps[] = "\000\000\001\272\104\000\004\000\004\001"
+      "\001\211\303\370\000\000\001\273\000\014";
+  const guint8 aiff[] = "FORM\000\001\000\000AIFFCOMM\000\000\000\022"
+      "\000\002\000\000\000\000\000\020\100\016\254\104";
+  const guint8 au[] = ".snd\000\000\000\030\377\377\377\377\000\000"
+      "\000\003\000\000\254\104\000\000\000\002";
+  const guint8 midi[] = "MThd\000\000\000\006\000\001\000\002\001\340"
+      "MTrk\000\000\000\000";
+  const guint8 webp[] = "RIFF\000\001\000\000WEBPVP8 \000\001\000\000";
+  const guint8 bmp[] = "BM\066\000\001\000\000\000\000\000\066\000"
+      "\000\000\050\000\000\000\000\001\000\000\000\001\000\000"
+      "\001\000\030\000";
+
+  add_header_sample (samples, "png", png, sizeof (png) - 1);
+  add_header_sample (samples, "jpeg", jpeg, sizeof (jpeg) - 1);
+  add_header_sample (samples, "gif", gif, sizeof (gif) - 1);
+  add_header_sample (samples, "wav", wav, sizeof (wav) - 1);
+  add_header_sample (samples, "avi", avi, sizeof (avi) - 1);
+  add_header_sample (samples, "ogg", ogg, sizeof (ogg) - 1);
+  add_header_sample (samples, "matroska", matroska, sizeof (matroska) - 1);
+  add_header_sample (samples, "mp4", mp4, sizeof (mp4) - 1);
+  add_header_sample (samples, "flac", flac, sizeof (flac) - 1);
+  add_header_sample (samples, "xml", xml, sizeof (xml) - 1);
+  add_header_sample (samples, "asf", asf, sizeof (asf) - 1);
+  add_header_sample (samples, "flv", flv, sizeof (flv) - 1);
+  add_header_sample (samples, "quicktime", quicktime, sizeof (quicktime) - 1);
+  add_header_sample (samples, "mpeg-ps", mpeg_ps, sizeof (mpeg_ps) - 1);
+  add_header_sample (samples, "aiff", aiff, sizeof (aiff) - 1);
+  add_header_sample (samples, "au", au, sizeof (au) - 1);
+  add_header_sample (samples, "midi", midi, sizeof (midi) - 1);
+  add_header_sample (samples, "webp", webp, sizeof (webp) - 1);
+  add_header_sample (samples, "bmp", bmp, sizeof (bmp) - 1);
+
+  /* 128 kbit/s at 44.1 kHz, 417 bytes per frame */
+  add_frames_sample (samples, "mp3", mp3_frame, sizeof (mp3_frame), 417, 0x55);
+  /* 371 bytes per frame */
+  add_frames_sample (samples, "adts", adts_frame, sizeof (adts_frame), 371,
+      0x55);
+  add_frames_sample (samples, "mpegts", ts_packet, sizeof (ts_packet), 188,
+      0xff);
+  add_h264_sample (samples);
+  add_text_sample (samples);
+
+  /* negative samples, every typefinder runs to its end on those */
+  add_filled_sample (samples, "random", TRUE);
+  add_filled_sample (samples, "zeros", FALSE);
+}
+
+static void
+add_file_samples (GPtrArray * samples, gchar ** paths)
+{
+  gchar **path;
+
+  for (path = paths; path && *path; path++) {
+    GByteArray *data;
+    GError *err = NULL;
+    gchar *contents;
+    gsize size;
+
+    if (!g_file_get_contents (*path, &contents, &size, &err)) {
+      g_printerr ("Can't read %s: %s\n", *path, err->message);
+      g_clear_error (&err);
+      continue;
+    }
+
+    /* typefinding happens on the start of the data */
+    size = MIN (size, SAMPLE_SIZE);
+    data = g_byte_array_sized_new (size);
+    g_byte_array_append (data, (const guint8 *) contents, size);
+    g_free (contents);
+
+    add_sample (samples, *path, data);
+  }
+}
+
+static void
+sample_free (Sample * sample)
+{
+  g_free (sample->name);
+  g_bytes_unref (sample->bytes);
+  g_free (sample);
+}
+
+/*** benchmark ***/
+
+static GList *
+get_factories (void)
+{
+  GList *factories, *l, *ret = NULL;
+
+  factories = gst_type_find_factory_get_list ();
+  for (l = factories; l != NULL; l = l->next) {
+    GstPluginFeature *feature = l->data;
+    const gchar *name = gst_plugin_feature_get_plugin_name (feature);
+
+    if (strcmp (plugin_name, "all") != 0 && g_strcmp0 (name, plugin_name) != 0)
+      continue;
+    if (!gst_type_find_factory_has_function (GST_TYPE_FIND_FACTORY (feature)))
+      continue;
+
+    /* loads the plugin, so that isn't measured */
+    feature = gst_plugin_feature_load (feature);
+    if (feature)
+      ret = g_list_prepend (ret, feature);
+  }
+  gst_plugin_feature_list_free (factories);
+
+  /* the order the core calls them in */
+  return g_list_sort (ret, gst_plugin_feature_rank_compare_func);
+}
+
+static gint
+compare_time (gconstpointer a, gconstpointer b)
+{
+  const TypeFinderStats *sa = a, *sb = b;
+
+  return sa->time < sb->time ? 1 : (sa->time > sb->time ? -1 : 0);
+}
+
+static void
+run_sample (Sample * sample, GArray * stats)
+{
+  gint64 core_time = 0;
+  guint best_probability = 0;
+  GstCaps *best_caps = NULL;
+  gboolean certain = FALSE;
+  guint i;
+  gint j;
+
+  for (i = 0; i < stats->len; i++) {
+    TypeFinderStats *s = &g_array_index (stats, TypeFinderStats, i);
+    GstTypeFind tf;
+    TypeFindRun run;
+    gint64 start, elapsed;
+
+    /* the first call for what it peeks and finds */
+    run_init (&run, &tf, sample->bytes);
+    gst_type_find_factory_call_function (s->factory, &tf);
+
+    s->peeked += run.peeked;
+    s->extent = MAX (s->extent, run.extent);
+    if (run.probability > 0)
+      s->matches++;
+
+    if (!certain && run.probability > best_probability) {
+      best_probability = run.probability;
+      gst_caps_replace (&best_caps, run.caps);
+    }
+    run_clear (&run);
+
+    /* and all others for the time */
+    start = g_get_monotonic_time ();
+    for (j = 0; j < iterations; j++) {
+      run_init (&run, &tf, sample->bytes);
+      gst_type_find_factory_call_function (s->factory, &tf);
+      run_clear (&run);
+    }
+    elapsed = g_get_monotonic_time () - start;
+
+    s->time += elapsed;
+    s->calls += iterations;
+
+    if (!certain) {
+      core_time += elapsed;
+      certain = (best_probability >= GST_TYPE_FIND_MAXIMUM);
+    }
+  }
+
+  if (best_caps) {
+    gchar *caps_str = gst_caps_to_string (best_caps);
+
+    g_print ("%-24s %6" G_GSIZE_FORMAT " %9.1f  %3u %s\n", sample->name,
+        g_bytes_get_size (sample->bytes), core_time / (gdouble) iterations,
+        best_probability, caps_str);
+    g_free (caps_str);
+    gst_caps_unref (best_caps);
+  } else {
+    g_print ("%-24s %6" G_GSIZE_FORMAT " %9.1f    - (none)\n", sample->name,
+        g_bytes_get_size (sample->bytes), core_time / (gdouble) iterations);
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GPtrArray *samples;
+  GList *factories, *l;
+  GArray *stats;
+  guint i;
+
+  ctx = g_option_context_new ("- typefind benchmark");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_printerr ("Error initializing: %s\n", err->message);
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  iterations = MAX (iterations, 1);
+  if (plugin_name == NULL)
+    plugin_name = g_strdup ("typefindfunctions");
+
+  factories = get_factories ();
+  if (factories == NULL) {
+    g_print ("No typefinders found in plugin '%s'\n", plugin_name);
+    g_free (plugin_name);
+    return 0;
+  }
+
+  stats = g_array_new (FALSE, TRUE, sizeof (TypeFinderStats));
+  for (l = factories; l != NULL; l = l->next) {
+    TypeFinderStats s = { l->data, };
+
+    g_array_append_val (stats, s);
+  }
+
+  samples = g_ptr_array_new_with_free_func ((GDestroyNotify) sample_free);
+  add_generated_samples (samples);
+  add_file_samples (samples, files);
+  g_strfreev (files);
+
+  g_print ("%u typefinders, %u samples, %d iterations\n\n", stats->len,
+      samples->len, iterations);
+
+  /* time until the core would have stopped, in us per typefinding */
+  g_print ("%-24s %6s %9s %4s %s\n", "sample", "size", "time/us", "prob",
+      "detected");
+  for (i = 0; i < samples->len; i++)
+    run_sample (g_ptr_array_index (samples, i), stats);
+
+  /* slowest typefinders first */
+  g_array_sort (stats, compare_time);
+
+  g_print ("\n%-32s %5s %10s %12s %8s %7s\n", "typefinder", "rank",
+      "ns/call", "peeked/call", "extent", "matches");
+  for (i = 0; i < stats->len; i++) {
+    TypeFinderStats *s = &g_array_index (stats, TypeFinderStats, i);
+    GstPluginFeature *feature = GST_PLUGIN_FEATURE (s->factory);
+
+    g_print ("%-32s %5u %10.0f %12.0f %8" G_GUINT64_FORMAT " %7u\n",
+        gst_plugin_feature_get_name (feature),
+        gst_plugin_feature_get_rank (feature),
+        s->time * 1000.0 / s->calls,
+        s->peeked / (gdouble) samples->len, s->extent, s->matches);
+  }
+
+  g_array_free (stats, TRUE);
+  gst_plugin_feature_list_free (factories);
+  g_ptr_array_unref (samples);
+  g_free (plugin_name);
+
+  return 0;
+}